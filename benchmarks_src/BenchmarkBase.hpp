@@ -0,0 +1,221 @@
+#pragma once
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include <ecstasy/core/Engine.hpp>
+#include <ecstasy/core/EntitySystem.hpp>
+#include <ecstasy/core/Family.hpp>
+#include <ecstasy/core/Component.hpp>
+#include <ecstasy/utils/ComponentFields.hpp>
+#include <stdint.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * A minimal benchmark harness in the style of google-benchmark.
+ *
+ * @code
+ * static void createEntities(BenchmarkState& state) {
+ *     while (state.keepRunning()) {
+ *         ...
+ *     }
+ *     state.setItemsProcessed(state.getIterations() * state.range(0));
+ * }
+ * BENCHMARK(createEntities)->args({ 10000 })->args({ 100000 });
+ * @endcode
+ */
+namespace benchmarks {
+	typedef std::chrono::steady_clock Clock;
+
+	class BenchmarkState {
+	private:
+		std::vector<int64_t> arguments;
+		uint64_t iterations = 0;
+		uint64_t maxIterations;
+		Clock::time_point start;
+		Clock::duration elapsed = Clock::duration::zero();
+		bool paused = true;
+		int64_t itemsProcessed = 0;
+
+	public:
+		BenchmarkState(const std::vector<int64_t>& arguments, uint64_t maxIterations)
+			: arguments(arguments), maxIterations(maxIterations) {}
+
+		/// @return @a true while the measured loop should continue
+		bool keepRunning() {
+			if (iterations == 0)
+				resumeTiming();
+			if (iterations < maxIterations) {
+				iterations++;
+				return true;
+			}
+			pauseTiming();
+			return false;
+		}
+
+		/// Stop measuring, e.g. to set up data for the next iteration.
+		void pauseTiming() {
+			if (!paused) {
+				elapsed += Clock::now() - start;
+				paused = true;
+			}
+		}
+
+		/// Continue measuring after pauseTiming().
+		void resumeTiming() {
+			if (paused) {
+				start = Clock::now();
+				paused = false;
+			}
+		}
+
+		/// @return The argument at the specified index
+		int64_t range(size_t index) const {
+			return index < arguments.size() ? arguments[index] : 0;
+		}
+
+		/// @return The number of iterations run so far
+		uint64_t getIterations() const {
+			return iterations;
+		}
+
+		/// @param items The total number of items processed over all iterations
+		void setItemsProcessed(int64_t items) {
+			itemsProcessed = items;
+		}
+
+		int64_t getItemsProcessed() const {
+			return itemsProcessed;
+		}
+
+		/// @return The measured time in seconds
+		double getElapsed() const {
+			return std::chrono::duration<double>(elapsed).count();
+		}
+	};
+
+	typedef void (*BenchmarkFunction)(BenchmarkState& state);
+
+	class Benchmark {
+	public:
+		std::string name;
+		BenchmarkFunction function;
+		std::vector<std::vector<int64_t>> argumentSets;
+
+		Benchmark(const std::string& name, BenchmarkFunction function) : name(name), function(function) {}
+
+		/// Add a set of arguments to run the benchmark with. Each set is run as a separate benchmark.
+		Benchmark* args(const std::vector<int64_t>& arguments) {
+			argumentSets.push_back(arguments);
+			return this;
+		}
+	};
+
+	/**
+	 * Register a benchmark. Use the BENCHMARK macro instead.
+	 *
+	 * @param name The name of the benchmark
+	 * @param function The function to run
+	 * @return The benchmark to add arguments to
+	 */
+	Benchmark* registerBenchmark(const char* name, BenchmarkFunction function);
+
+	/// Prevents the compiler from optimizing away a value.
+	template<typename T>
+	inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		static volatile const void* sink;
+		sink = &value;
+#endif
+	}
+
+	/// Components used for the benchmarks.
+	template<int N>
+	struct BenchComponent : public ecstasy::Component<BenchComponent<N>> {
+		float value = 0;
+	};
+	ECS_COMPONENT_FIELDS(BenchComponent<0>, value)
+	ECS_COMPONENT_FIELDS(BenchComponent<1>, value)
+	ECS_COMPONENT_FIELDS(BenchComponent<2>, value)
+	ECS_COMPONENT_FIELDS(BenchComponent<3>, value)
+	ECS_COMPONENT_FIELDS(BenchComponent<4>, value)
+	ECS_COMPONENT_FIELDS(BenchComponent<5>, value)
+	ECS_COMPONENT_FIELDS(BenchComponent<6>, value)
+	ECS_COMPONENT_FIELDS(BenchComponent<7>, value)
+
+	/**
+	 * Add the first count BenchComponents to an entity.
+	 *
+	 * @param entity The entity
+	 * @param count The number of components (0-8)
+	 */
+	inline void emplaceComponents(ecstasy::Entity* entity, int64_t count) {
+		switch (count) {
+			default:
+			case 8: entity->emplace<BenchComponent<7>>();
+			case 7: entity->emplace<BenchComponent<6>>();
+			case 6: entity->emplace<BenchComponent<5>>();
+			case 5: entity->emplace<BenchComponent<4>>();
+			case 4: entity->emplace<BenchComponent<3>>();
+			case 3: entity->emplace<BenchComponent<2>>();
+			case 2: entity->emplace<BenchComponent<1>>();
+			case 1: entity->emplace<BenchComponent<0>>();
+			case 0: break;
+		}
+	}
+
+	inline ecstasy::FamilyBuilder& addToFamily(ecstasy::FamilyBuilder& builder, int component) {
+		switch (component) {
+			case 0: return builder.all<BenchComponent<0>>();
+			case 1: return builder.all<BenchComponent<1>>();
+			case 2: return builder.all<BenchComponent<2>>();
+			case 3: return builder.all<BenchComponent<3>>();
+			case 4: return builder.all<BenchComponent<4>>();
+			case 5: return builder.all<BenchComponent<5>>();
+			case 6: return builder.all<BenchComponent<6>>();
+			default: return builder.all<BenchComponent<7>>();
+		}
+	}
+
+	/**
+	 * Get one of 255 distinct families. The bits of index + 1 select the BenchComponents required by the family.
+	 *
+	 * @param index The index of the family (0-254)
+	 * @return The family
+	 */
+	inline const ecstasy::Family& getBenchFamily(int index) {
+		int mask = index % 255 + 1;
+		auto& builder = ecstasy::Family::all();
+		for (int i = 0; i < 8; i++) {
+			if (mask & (1 << i))
+				addToFamily(builder, i);
+		}
+		return builder.get();
+	}
+}
+
+#define BENCHMARK_CONCAT2(a, b) a##b
+#define BENCHMARK_CONCAT(a, b) BENCHMARK_CONCAT2(a, b)
+#define BENCHMARK(function) static benchmarks::Benchmark* BENCHMARK_CONCAT(benchmark_, __LINE__) = \
+	benchmarks::registerBenchmark(#function, function)
+
+using benchmarks::BenchmarkState;
+using benchmarks::BenchComponent;
+using benchmarks::emplaceComponents;
+using benchmarks::doNotOptimize;
+using benchmarks::getBenchFamily;
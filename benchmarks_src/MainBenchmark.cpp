@@ -0,0 +1,177 @@
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include "BenchmarkBase.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+namespace benchmarks {
+	static std::vector<std::unique_ptr<Benchmark>>& getBenchmarks() {
+		static std::vector<std::unique_ptr<Benchmark>> benchmarks;
+		return benchmarks;
+	}
+
+	Benchmark* registerBenchmark(const char* name, BenchmarkFunction function) {
+		getBenchmarks().emplace_back(new Benchmark(name, function));
+		return getBenchmarks().back().get();
+	}
+
+	struct Result {
+		std::string name;
+		uint64_t iterations;
+		double seconds;
+		int64_t items;
+	};
+
+	struct Options {
+		std::string filter;
+		double minTime = 0.5;
+		int64_t maxSize = 1000000;
+		bool json = false;
+		std::string out;
+	};
+
+	static std::string getName(const Benchmark& benchmark, const std::vector<int64_t>& arguments) {
+		auto name = benchmark.name;
+		for (auto argument : arguments)
+			name += "/" + std::to_string(argument);
+		return name;
+	}
+
+	static Result run(const Benchmark& benchmark, const std::vector<int64_t>& arguments, double minTime) {
+		Result result;
+		result.name = getName(benchmark, arguments);
+
+		// Increase the number of iterations until the measured time is long enough
+		uint64_t iterations = 1;
+		for (;;) {
+			BenchmarkState state(arguments, iterations);
+			benchmark.function(state);
+			double elapsed = state.getElapsed();
+			if (elapsed >= minTime || iterations >= 1000000000) {
+				result.iterations = state.getIterations();
+				result.seconds = elapsed;
+				result.items = state.getItemsProcessed();
+				return result;
+			}
+			double factor = elapsed > 0 ? std::min(10.0, minTime * 1.4 / elapsed) : 10.0;
+			iterations = std::max(iterations + 1, static_cast<uint64_t>(iterations * factor));
+		}
+	}
+
+	static void writeConsole(std::ostream& stream, const Result& result) {
+		double timePerIteration = result.seconds * 1e9 / result.iterations;
+		stream << std::left << std::setw(50) << result.name << std::right << std::setw(16) << std::fixed
+			<< std::setprecision(0) << timePerIteration << " ns" << std::setw(12) << result.iterations;
+		if (result.items > 0)
+			stream << std::setw(14) << std::setprecision(3) << (result.items / result.seconds / 1e6) << " M items/s";
+		stream << std::endl;
+	}
+
+	static void writeJson(std::ostream& stream, const std::vector<Result>& results) {
+		char date[64];
+		auto now = std::time(nullptr);
+		std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+		stream << "{\n\t\"context\": {\n\t\t\"date\": \"" << date << "\",\n";
+#ifdef NDEBUG
+		stream << "\t\t\"library_build_type\": \"release\",\n";
+#else
+		stream << "\t\t\"library_build_type\": \"debug\",\n";
+#endif
+		stream << "\t\t\"profiling\": " << (ecstasy::EngineStats::isEnabled() ? "true" : "false") << "\n\t},\n";
+		stream << "\t\"benchmarks\": [";
+		bool first = true;
+		for (auto& result : results) {
+			stream << (first ? "\n" : ",\n");
+			first = false;
+			double timePerIteration = result.seconds * 1e9 / result.iterations;
+			stream << std::setprecision(6) << std::fixed
+				<< "\t\t{ \"name\": \"" << result.name << "\", \"iterations\": " << result.iterations
+				<< ", \"real_time\": " << timePerIteration << ", \"time_unit\": \"ns\"";
+			if (result.items > 0)
+				stream << ", \"items_per_second\": " << (result.items / result.seconds);
+			stream << " }";
+		}
+		stream << "\n\t]\n}\n";
+	}
+
+	static bool parseOptions(int argc, char** argv, Options& options) {
+		for (int i = 1; i < argc; i++) {
+			std::string arg = argv[i];
+			auto value = arg.substr(arg.find('=') + 1);
+			if (arg.compare(0, 9, "--filter=") == 0)
+				options.filter = value;
+			else if (arg.compare(0, 11, "--min-time=") == 0)
+				options.minTime = std::atof(value.c_str());
+			else if (arg.compare(0, 11, "--max-size=") == 0)
+				options.maxSize = std::atoll(value.c_str());
+			else if (arg == "--format=json")
+				options.json = true;
+			else if (arg == "--format=console")
+				options.json = false;
+			else if (arg.compare(0, 6, "--out=") == 0)
+				options.out = value;
+			else {
+				std::cerr << "Usage: " << argv[0] << " [--filter=<substring>] [--min-time=<seconds>]"
+					<< " [--max-size=<count>] [--format=console|json] [--out=<file>]" << std::endl;
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+int main(int argc, char** argv) {
+	using namespace benchmarks;
+	Options options;
+	if (!parseOptions(argc, argv, options))
+		return 1;
+
+	std::vector<Result> results;
+	for (auto& benchmark : getBenchmarks()) {
+		auto argumentSets = benchmark->argumentSets;
+		if (argumentSets.empty())
+			argumentSets.emplace_back();
+		for (auto& arguments : argumentSets) {
+			if (!arguments.empty() && arguments[0] > options.maxSize)
+				continue;
+			if (getName(*benchmark, arguments).find(options.filter) == std::string::npos)
+				continue;
+			auto result = run(*benchmark, arguments, options.minTime);
+			if (!options.json)
+				writeConsole(std::cout, result);
+			results.push_back(result);
+		}
+	}
+
+	if (options.json && options.out.empty())
+		writeJson(std::cout, results);
+	if (!options.out.empty()) {
+		std::ofstream file(options.out);
+		if (!file.is_open()) {
+			std::cerr << "Could not open " << options.out << std::endl;
+			return 1;
+		}
+		writeJson(file, results);
+	}
+	return 0;
+}
@@ -0,0 +1,137 @@
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include "../BenchmarkBase.hpp"
+
+namespace EntityBenchmarks {
+	using ecstasy::Engine;
+	using ecstasy::Entity;
+
+	/// Create and add entities with a number of components (range 0 = entities, range 1 = components)
+	static void createEntities(BenchmarkState& state) {
+		auto count = state.range(0);
+		while (state.keepRunning()) {
+			Engine engine;
+			for (int64_t i = 0; i < count; i++) {
+				auto entity = engine.createEntity();
+				emplaceComponents(entity, state.range(1));
+				engine.addEntity(entity);
+			}
+			state.pauseTiming();
+			engine.removeAllEntities();
+			state.resumeTiming();
+		}
+		state.setItemsProcessed(state.getIterations() * count);
+	}
+	BENCHMARK(createEntities)->args({ 10000, 0 })->args({ 10000, 4 })->args({ 100000, 4 })->args({ 1000000, 4 });
+
+	/// Remove all entities (range 0 = entities, range 1 = components)
+	static void removeEntities(BenchmarkState& state) {
+		auto count = state.range(0);
+		while (state.keepRunning()) {
+			state.pauseTiming();
+			Engine engine;
+			for (int64_t i = 0; i < count; i++) {
+				auto entity = engine.createEntity();
+				emplaceComponents(entity, state.range(1));
+				engine.addEntity(entity);
+			}
+			state.resumeTiming();
+			engine.removeAllEntities();
+		}
+		state.setItemsProcessed(state.getIterations() * count);
+	}
+	BENCHMARK(removeEntities)->args({ 10000, 4 })->args({ 100000, 4 });
+
+	/// Create entities in bulk with 4 components, while a number of families are registered (range 0 = entities, range 1 = families)
+	static void createEntitiesBulk(BenchmarkState& state) {
+		auto count = static_cast<uint32_t>(state.range(0));
+		while (state.keepRunning()) {
+			Engine engine;
+			for (int64_t i = 0; i < state.range(1); i++)
+				engine.getEntitiesFor(getBenchFamily(static_cast<int>(i)));
+			auto entities = engine.createEntities<BenchComponent<0>, BenchComponent<1>, BenchComponent<2>,
+				BenchComponent<3>>(count);
+			engine.addEntities(entities);
+			state.pauseTiming();
+			engine.removeAllEntities();
+			state.resumeTiming();
+		}
+		state.setItemsProcessed(state.getIterations() * count);
+	}
+	BENCHMARK(createEntitiesBulk)->args({ 10000, 0 })->args({ 100000, 0 })->args({ 100000, 32 })
+		->args({ 1000000, 32 });
+
+	/// Clone a prototype with 4 components, while a number of families are registered (range 0 = entities, range 1 = families)
+	static void instantiatePrototype(BenchmarkState& state) {
+		auto count = static_cast<uint32_t>(state.range(0));
+		while (state.keepRunning()) {
+			Engine engine;
+			for (int64_t i = 0; i < state.range(1); i++)
+				engine.getEntitiesFor(getBenchFamily(static_cast<int>(i)));
+			auto prototype = engine.createEntity();
+			emplaceComponents(prototype, 4);
+			engine.instantiate(prototype, count);
+			state.pauseTiming();
+			engine.removeEntity(prototype);
+			engine.removeAllEntities();
+			state.resumeTiming();
+		}
+		state.setItemsProcessed(state.getIterations() * count);
+	}
+	BENCHMARK(instantiatePrototype)->args({ 10000, 0 })->args({ 100000, 0 })->args({ 100000, 32 });
+
+	/// Remove all entities in bulk, while a number of families are registered (range 0 = entities, range 1 = families)
+	static void removeEntitiesBulk(BenchmarkState& state) {
+		auto count = static_cast<uint32_t>(state.range(0));
+		while (state.keepRunning()) {
+			state.pauseTiming();
+			Engine engine;
+			for (int64_t i = 0; i < state.range(1); i++)
+				engine.getEntitiesFor(getBenchFamily(static_cast<int>(i)));
+			auto entities = engine.createEntities<BenchComponent<0>, BenchComponent<1>, BenchComponent<2>,
+				BenchComponent<3>>(count);
+			engine.addEntities(entities);
+			state.resumeTiming();
+			engine.removeEntities(entities);
+		}
+		state.setItemsProcessed(state.getIterations() * count);
+	}
+	BENCHMARK(removeEntitiesBulk)->args({ 10000, 0 })->args({ 100000, 0 })->args({ 100000, 32 });
+
+	/// Emplace components on entities, which are part of the engine (range 0 = entities, range 1 = components)
+	static void emplaceComponent(BenchmarkState& state) {
+		auto count = state.range(0);
+		while (state.keepRunning()) {
+			state.pauseTiming();
+			Engine engine;
+			std::vector<Entity*> entities;
+			entities.reserve(count);
+			for (int64_t i = 0; i < count; i++) {
+				auto entity = engine.createEntity();
+				engine.addEntity(entity);
+				entities.push_back(entity);
+			}
+			state.resumeTiming();
+			for (auto entity : entities)
+				emplaceComponents(entity, state.range(1));
+			state.pauseTiming();
+			engine.removeAllEntities();
+			state.resumeTiming();
+		}
+		state.setItemsProcessed(state.getIterations() * count * state.range(1));
+	}
+	BENCHMARK(emplaceComponent)->args({ 10000, 1 })->args({ 10000, 8 })->args({ 100000, 8 })->args({ 500000, 8 });
+}
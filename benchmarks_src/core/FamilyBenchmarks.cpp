@@ -0,0 +1,98 @@
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include "../BenchmarkBase.hpp"
+
+namespace FamilyBenchmarks {
+	using ecstasy::Engine;
+	using ecstasy::Entity;
+	using ecstasy::Family;
+
+	/// Check entities against families (range 0 = entities, range 1 = families)
+	static void familyMatches(BenchmarkState& state) {
+		auto count = state.range(0);
+		Engine engine;
+		std::vector<Entity*> entities;
+		for (int64_t i = 0; i < count; i++) {
+			auto entity = engine.createEntity();
+			emplaceComponents(entity, i % 9);
+			entities.push_back(entity);
+		}
+		std::vector<const Family*> families;
+		for (int i = 0; i < state.range(1); i++)
+			families.push_back(&getBenchFamily(i));
+
+		while (state.keepRunning()) {
+			int64_t matches = 0;
+			for (auto family : families) {
+				for (auto entity : entities)
+					matches += family->matches(entity) ? 1 : 0;
+			}
+			doNotOptimize(matches);
+		}
+		state.setItemsProcessed(state.getIterations() * count * state.range(1));
+		for (auto entity : entities)
+			engine.removeEntity(entity);
+	}
+	BENCHMARK(familyMatches)->args({ 10000, 1 })->args({ 10000, 16 })->args({ 100000, 16 });
+
+	/// Add entities to an engine with registered families (range 0 = entities, range 1 = families)
+	static void updateFamilyMembership(BenchmarkState& state) {
+		auto count = state.range(0);
+		while (state.keepRunning()) {
+			state.pauseTiming();
+			Engine engine;
+			for (int i = 0; i < state.range(1); i++)
+				engine.getEntitiesFor(getBenchFamily(i));
+			std::vector<Entity*> entities;
+			for (int64_t i = 0; i < count; i++) {
+				auto entity = engine.createEntity();
+				emplaceComponents(entity, i % 9);
+				entities.push_back(entity);
+			}
+			state.resumeTiming();
+			for (auto entity : entities)
+				engine.addEntity(entity);
+			state.pauseTiming();
+			engine.removeAllEntities();
+			state.resumeTiming();
+		}
+		state.setItemsProcessed(state.getIterations() * count);
+	}
+	BENCHMARK(updateFamilyMembership)->args({ 10000, 1 })->args({ 10000, 16 })->args({ 10000, 64 })
+		->args({ 100000, 16 })->args({ 1000000, 16 });
+
+	/// Register families in an engine with existing entities (range 0 = entities, range 1 = families)
+	static void registerFamily(BenchmarkState& state) {
+		auto count = state.range(0);
+		while (state.keepRunning()) {
+			state.pauseTiming();
+			Engine engine;
+			for (int64_t i = 0; i < count; i++) {
+				auto entity = engine.createEntity();
+				emplaceComponents(entity, i % 9);
+				engine.addEntity(entity);
+			}
+			state.resumeTiming();
+			for (int i = 0; i < state.range(1); i++)
+				doNotOptimize(engine.getEntitiesFor(getBenchFamily(i)));
+			state.pauseTiming();
+			engine.removeAllEntities();
+			state.resumeTiming();
+		}
+		state.setItemsProcessed(state.getIterations() * count * state.range(1));
+	}
+	BENCHMARK(registerFamily)->args({ 10000, 16 })->args({ 100000, 16 });
+}
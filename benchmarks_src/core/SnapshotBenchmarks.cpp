@@ -0,0 +1,106 @@
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include "../BenchmarkBase.hpp"
+#include <ecstasy/utils/ComponentRegistry.hpp>
+#include <ecstasy/utils/DeltaRecorder.hpp>
+#include <sstream>
+
+namespace SnapshotBenchmarks {
+	using ecstasy::Engine;
+	using ecstasy::ComponentRegistry;
+
+	void registerComponents(ComponentRegistry& registry) {
+		registry.add<BenchComponent<0>>("A");
+		registry.add<BenchComponent<1>>("B");
+		registry.add<BenchComponent<2>>("C");
+		registry.add<BenchComponent<3>>("D");
+	}
+
+	/// Fill an engine with entities having 1 to 4 components
+	void createWorld(Engine& engine, int64_t count) {
+		std::vector<ecstasy::Entity*> entities;
+		for (int64_t i = 0; i < count; i++) {
+			entities.push_back(engine.createEntity());
+			emplaceComponents(entities.back(), i % 4 + 1);
+		}
+		engine.addEntities(entities);
+	}
+
+	/// Save a snapshot of a world (range 0 = entities)
+	static void saveSnapshot(BenchmarkState& state) {
+		auto count = state.range(0);
+		ComponentRegistry registry;
+		registerComponents(registry);
+		Engine engine;
+		createWorld(engine, count);
+		while (state.keepRunning()) {
+			std::ostringstream stream;
+			engine.saveSnapshot(stream, registry);
+			doNotOptimize(stream);
+		}
+		state.setItemsProcessed(state.getIterations() * count);
+	}
+	BENCHMARK(saveSnapshot)->args({ 10000 })->args({ 100000 });
+
+	/// Restore a world from a snapshot, while a number of families are registered (range 0 = entities, range 1 = families)
+	static void loadSnapshot(BenchmarkState& state) {
+		auto count = state.range(0);
+		ComponentRegistry registry;
+		registerComponents(registry);
+		std::string data;
+		{
+			Engine engine;
+			createWorld(engine, count);
+			std::ostringstream stream;
+			engine.saveSnapshot(stream, registry);
+			data = stream.str();
+		}
+		while (state.keepRunning()) {
+			Engine engine;
+			for (int64_t i = 0; i < state.range(1); i++)
+				engine.getEntitiesFor(getBenchFamily(static_cast<int>(i)));
+			engine.loadSnapshot(data.data(), data.size(), registry);
+			state.pauseTiming();
+			engine.removeAllEntities();
+			state.resumeTiming();
+		}
+		state.setItemsProcessed(state.getIterations() * count);
+	}
+	BENCHMARK(loadSnapshot)->args({ 10000, 0 })->args({ 100000, 0 })->args({ 100000, 32 });
+
+	/// Write the delta of a frame, in which some components were modified (range 0 = entities, range 1 = modified)
+	static void writeDelta(BenchmarkState& state) {
+		auto count = state.range(0);
+		ComponentRegistry registry;
+		registerComponents(registry);
+		Engine engine;
+		createWorld(engine, count);
+		ecstasy::DeltaRecorder recorder(engine, registry);
+		auto& entities = *engine.getEntities();
+		size_t next = 0;
+		while (state.keepRunning()) {
+			state.pauseTiming();
+			for (int64_t i = 0; i < state.range(1); i++)
+				entities[next++ % entities.size()]->getMut<BenchComponent<0>>()->value += 1;
+			state.resumeTiming();
+			std::ostringstream stream;
+			recorder.writeDelta(stream);
+			doNotOptimize(stream);
+		}
+		state.setItemsProcessed(state.getIterations() * count);
+	}
+	BENCHMARK(writeDelta)->args({ 10000, 100 })->args({ 100000, 1000 });
+}
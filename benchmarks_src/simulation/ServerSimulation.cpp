@@ -0,0 +1,918 @@
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include <ecstasy/core/Engine.hpp>
+#include <ecstasy/core/EntitySystem.hpp>
+#include <ecstasy/core/Family.hpp>
+#include <ecstasy/core/Component.hpp>
+#include <ecstasy/systems/IteratingSystem.hpp>
+#include <ecstasy/systems/SortedIteratingSystem.hpp>
+#include <ecstasy/systems/IntervalSystem.hpp>
+#include <ecstasy/systems/IntervalIteratingSystem.hpp>
+#include <ecstasy/utils/EntityFactory.hpp>
+#include <ecstasy/utils/ComponentFactory.hpp>
+#include <ecstasy/utils/Blueprint.hpp>
+#include <ecstasy/utils/BlueprintParser.hpp>
+#include <ecstasy/utils/DefaultMemoryManager.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+/*
+ * A macro benchmark simulating a game server: Waves of monsters are spawned from blueprints and despawned again,
+ * players and monsters shoot projectiles at each other, status effects are added and removed, and entities are
+ * sorted for collision, replication and rendering. It reports frame time percentiles and the peak number of
+ * allocations, so different storage and scheduling modes can be compared on the same workload.
+ */
+namespace simulation {
+	using namespace ecstasy;
+
+	const float WORLD_SIZE = 1000;
+	const float FRAME_TIME = 1.0f / 60.0f;
+
+	struct Options {
+		int frames = 3000;
+		int waveSize = 500;
+		int maxWaves = 8;
+		int players = 64;
+		uint32_t seed = 1;
+		SortMode sortMode = SortMode::Full;
+		bool staggered = false;
+		float frameBudget = 0;
+		std::string out;
+	};
+
+	/// A small deterministic random number generator (xorshift32), so runs are comparable.
+	class Random {
+	private:
+		uint32_t state;
+
+	public:
+		explicit Random(uint32_t seed) : state(seed ? seed : 1) {}
+
+		uint32_t next() {
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			return state;
+		}
+
+		/// @return A value in the range [0, 1)
+		float nextFloat() {
+			return (next() & 0xFFFFFF) / 16777216.0f;
+		}
+
+		/// @return A value in the range [min, max)
+		float range(float min, float max) {
+			return min + nextFloat() * (max - min);
+		}
+
+		/// @return @a true once in count calls on average
+		bool chance(uint32_t count) {
+			return next() % count == 0;
+		}
+	};
+
+	struct Context {
+		Options options;
+		Random random;
+		std::deque<std::vector<uint64_t>> waves;
+		uint64_t spawned = 0;
+		uint64_t despawned = 0;
+		uint64_t projectilesFired = 0;
+		uint64_t hits = 0;
+		uint64_t statusEffectsApplied = 0;
+		uint64_t replicatedBytes = 0;
+
+		explicit Context(const Options& options) : options(options), random(options.seed) {}
+	};
+
+	// Components
+	struct PositionComponent : public Component<PositionComponent> {
+		float x = 0, y = 0;
+	};
+	struct VelocityComponent : public Component<VelocityComponent> {
+		float x = 0, y = 0;
+	};
+	struct HealthComponent : public Component<HealthComponent> {
+		float value = 100, max = 100;
+	};
+	struct TeamComponent : public Component<TeamComponent> {
+		int team = 0;
+	};
+	struct AiComponent : public Component<AiComponent> {
+		float targetX = 0, targetY = 0, speed = 1;
+	};
+	struct WeaponComponent : public Component<WeaponComponent> {
+		float cooldown = 0, rate = 1, damage = 10;
+	};
+	struct ProjectileComponent : public Component<ProjectileComponent> {
+		float damage = 10;
+	};
+	struct LifetimeComponent : public Component<LifetimeComponent> {
+		float remaining = 1;
+	};
+	struct ColliderComponent : public Component<ColliderComponent> {
+		float radius = 1;
+	};
+	struct SpriteComponent : public Component<SpriteComponent> {
+		int layer = 0, frame = 0;
+	};
+	struct ReplicatedComponent : public Component<ReplicatedComponent> {
+		float priority = 0;
+		bool dirty = true;
+	};
+	struct RegenComponent : public Component<RegenComponent> {
+		float rate = 1;
+	};
+	struct BurningComponent : public Component<BurningComponent> {
+		float remaining = 2, damage = 5;
+	};
+	struct LootComponent : public Component<LootComponent> {
+		int value = 1;
+	};
+	struct PlayerComponent : public Component<PlayerComponent> {
+		int score = 0;
+	};
+
+	// Component factories
+#define DECLARE_COMPONENT_FACTORY(Name, Component, Body)\
+	class Name : public ComponentFactory {\
+	public:\
+		bool assemble(Entity* entity, ComponentBlueprint& blueprint) override {\
+			auto component = entity->emplace<Component>();\
+			Body\
+			return true;\
+		}\
+	};
+
+	DECLARE_COMPONENT_FACTORY(HealthFactory, HealthComponent,
+		component->max = component->value = blueprint.getFloat("value", 100);)
+	DECLARE_COMPONENT_FACTORY(TeamFactory, TeamComponent, component->team = blueprint.getInt("team", 0);)
+	DECLARE_COMPONENT_FACTORY(AiFactory, AiComponent, component->speed = blueprint.getFloat("speed", 1);)
+	DECLARE_COMPONENT_FACTORY(WeaponFactory, WeaponComponent,
+		component->rate = blueprint.getFloat("rate", 1);
+		component->damage = blueprint.getFloat("damage", 10);)
+	DECLARE_COMPONENT_FACTORY(ProjectileFactory, ProjectileComponent,
+		component->damage = blueprint.getFloat("damage", 10);)
+	DECLARE_COMPONENT_FACTORY(LifetimeFactory, LifetimeComponent,
+		component->remaining = blueprint.getFloat("seconds", 1);)
+	DECLARE_COMPONENT_FACTORY(ColliderFactory, ColliderComponent,
+		component->radius = blueprint.getFloat("radius", 1);)
+	DECLARE_COMPONENT_FACTORY(SpriteFactory, SpriteComponent, component->layer = blueprint.getInt("layer", 0);)
+	DECLARE_COMPONENT_FACTORY(RegenFactory, RegenComponent, component->rate = blueprint.getFloat("rate", 1);)
+	DECLARE_COMPONENT_FACTORY(LootFactory, LootComponent, component->value = blueprint.getInt("value", 1);)
+
+	const char* const BLUEPRINTS[][2] = {
+		{ "player",
+			"add Position\nadd Velocity\nadd Health\n set value 500\nadd Team\n set team 0\n"
+			"add Weapon\n set rate 4\n set damage 25\nadd Collider\n set radius 2\nadd Sprite\n set layer 3\n"
+			"add Replicated\nadd Regen\n set rate 5\nadd Player\n" },
+		{ "grunt",
+			"add Position\nadd Velocity\nadd Health\n set value 60\nadd Team\n set team 1\nadd Ai\n set speed 20\n"
+			"add Collider\n set radius 1\nadd Sprite\n set layer 1\nadd Replicated\n" },
+		{ "archer",
+			"add Position\nadd Velocity\nadd Health\n set value 40\nadd Team\n set team 1\nadd Ai\n set speed 15\n"
+			"add Weapon\n set rate 0.5\n set damage 8\nadd Collider\n set radius 1\nadd Sprite\n set layer 1\n"
+			"add Replicated\n" },
+		{ "brute",
+			"add Position\nadd Velocity\nadd Health\n set value 300\nadd Team\n set team 1\nadd Ai\n set speed 8\n"
+			"add Collider\n set radius 3\nadd Sprite\n set layer 2\nadd Replicated\nadd Regen\n set rate 2\n" },
+		{ "projectile",
+			"add Position\nadd Velocity\nadd Projectile\nadd Team\nadd Lifetime\n set seconds 1.5\n"
+			"add Collider\n set radius 0.5\nadd Sprite\n set layer 4\n" },
+		{ "loot",
+			"add Position\nadd Loot\n set value 5\nadd Lifetime\n set seconds 10\nadd Sprite\n set layer 0\n"
+			"add Replicated\n" }
+	};
+
+	std::shared_ptr<EntityFactory> createEntityFactory() {
+		auto factory = std::make_shared<EntityFactory>();
+		factory->addComponentFactory<SimpleComponentFactory<PositionComponent>>("Position");
+		factory->addComponentFactory<SimpleComponentFactory<VelocityComponent>>("Velocity");
+		factory->addComponentFactory<HealthFactory>("Health");
+		factory->addComponentFactory<TeamFactory>("Team");
+		factory->addComponentFactory<AiFactory>("Ai");
+		factory->addComponentFactory<WeaponFactory>("Weapon");
+		factory->addComponentFactory<ProjectileFactory>("Projectile");
+		factory->addComponentFactory<LifetimeFactory>("Lifetime");
+		factory->addComponentFactory<ColliderFactory>("Collider");
+		factory->addComponentFactory<SpriteFactory>("Sprite");
+		factory->addComponentFactory<SimpleComponentFactory<ReplicatedComponent>>("Replicated");
+		factory->addComponentFactory<RegenFactory>("Regen");
+		factory->addComponentFactory<LootFactory>("Loot");
+		factory->addComponentFactory<SimpleComponentFactory<PlayerComponent>>("Player");
+
+		for (auto& definition : BLUEPRINTS) {
+			std::istringstream stream(definition[1]);
+			std::shared_ptr<EntityBlueprint> blueprint;
+			auto error = parseBlueprint(stream, blueprint);
+			if (!error.empty()) {
+				std::cerr << "Failed to parse blueprint " << definition[0] << ": " << error << std::endl;
+				std::exit(1);
+			}
+			factory->addEntityBlueprint(definition[0], blueprint);
+		}
+		return factory;
+	}
+
+	Entity* spawn(Engine* engine, Context& context, const char* blueprint, float x, float y) {
+		auto entity = engine->assembleEntity(blueprint);
+		auto position = entity->get<PositionComponent>();
+		position->x = x;
+		position->y = y;
+		engine->addEntity(entity);
+		context.spawned++;
+		return entity;
+	}
+
+	// 1. Spawns a wave of monsters every few seconds and despawns the oldest wave when there are too many.
+	class WaveSystem : public IntervalSystem<WaveSystem> {
+	private:
+		Context& context;
+		Engine* engine = nullptr;
+
+	public:
+		explicit WaveSystem(Context& context) : IntervalSystem(2.0f, 0), context(context) {}
+
+		void addedToEngine(Engine* engine) override {
+			this->engine = engine;
+		}
+
+	protected:
+		void updateInterval() override {
+			static const char* const monsters[] = { "grunt", "grunt", "grunt", "archer", "archer", "brute" };
+			std::vector<uint64_t> wave;
+			wave.reserve(context.options.waveSize);
+			float centerX = context.random.range(0, WORLD_SIZE);
+			float centerY = context.random.range(0, WORLD_SIZE);
+			for (int i = 0; i < context.options.waveSize; i++) {
+				auto blueprint = monsters[context.random.next() % 6];
+				auto entity = spawn(engine, context, blueprint, centerX + context.random.range(-50, 50),
+					centerY + context.random.range(-50, 50));
+				wave.push_back(entity->getId());
+			}
+			context.waves.push_back(std::move(wave));
+
+			if (static_cast<int>(context.waves.size()) > context.options.maxWaves) {
+				for (auto id : context.waves.front()) {
+					auto entity = engine->getEntity(id);
+					if (entity) {
+						engine->removeEntity(entity);
+						context.despawned++;
+					}
+				}
+				context.waves.pop_front();
+			}
+		}
+	};
+
+	// 2. Picks new targets for monsters a few times per second.
+	class AiThinkSystem : public IntervalIteratingSystem<AiThinkSystem> {
+	private:
+		Context& context;
+
+	public:
+		explicit AiThinkSystem(Context& context)
+			: IntervalIteratingSystem(Family::all<AiComponent, PositionComponent>().get(), 0.25f, 1),
+			context(context) {}
+
+	protected:
+		void processEntity(Entity* entity) override {
+			auto ai = entity->get<AiComponent>();
+			auto position = entity->get<PositionComponent>();
+			ai->targetX = std::min(WORLD_SIZE, std::max(0.0f, position->x + context.random.range(-100, 100)));
+			ai->targetY = std::min(WORLD_SIZE, std::max(0.0f, position->y + context.random.range(-100, 100)));
+		}
+	};
+
+	// 3. Steers monsters towards their target.
+	class SteeringSystem : public IteratingSystem<SteeringSystem> {
+	public:
+		SteeringSystem() : IteratingSystem(Family::all<AiComponent, PositionComponent, VelocityComponent>().get(), 2) {}
+
+	protected:
+		void processEntity(Entity* entity, float deltaTime) override {
+			auto ai = entity->get<AiComponent>();
+			auto position = entity->get<PositionComponent>();
+			auto velocity = entity->get<VelocityComponent>();
+			float dx = ai->targetX - position->x;
+			float dy = ai->targetY - position->y;
+			float length = std::sqrt(dx * dx + dy * dy);
+			if (length > 0.01f) {
+				velocity->x = dx / length * ai->speed;
+				velocity->y = dy / length * ai->speed;
+			}
+		}
+	};
+
+	// 4. Random player input.
+	class PlayerInputSystem : public IteratingSystem<PlayerInputSystem> {
+	private:
+		Context& context;
+
+	public:
+		explicit PlayerInputSystem(Context& context)
+			: IteratingSystem(Family::all<PlayerComponent, VelocityComponent>().get(), 3), context(context) {}
+
+	protected:
+		void processEntity(Entity* entity, float deltaTime) override {
+			if (context.random.chance(30)) {
+				auto velocity = entity->get<VelocityComponent>();
+				velocity->x = context.random.range(-40, 40);
+				velocity->y = context.random.range(-40, 40);
+			}
+		}
+	};
+
+	// 5. Integrates velocities.
+	class MovementSystem : public StaticIteratingSystem<MovementSystem> {
+	public:
+		MovementSystem() : StaticIteratingSystem(Family::all<PositionComponent, VelocityComponent>().get(), 4) {}
+
+		void processEntity(Entity* entity, float deltaTime) {
+			auto position = entity->get<PositionComponent>();
+			auto velocity = entity->get<VelocityComponent>();
+			position->x += velocity->x * deltaTime;
+			position->y += velocity->y * deltaTime;
+		}
+	};
+
+	// 6. Slows down everything but projectiles.
+	class DampingSystem : public IteratingSystem<DampingSystem> {
+	public:
+		DampingSystem()
+			: IteratingSystem(Family::all<VelocityComponent>().exclude<ProjectileComponent, AiComponent>().get(), 5) {}
+
+	protected:
+		void processEntity(Entity* entity, float deltaTime) override {
+			auto velocity = entity->get<VelocityComponent>();
+			velocity->x *= 0.99f;
+			velocity->y *= 0.99f;
+		}
+	};
+
+	// 7. Keeps entities inside the world.
+	class BoundsSystem : public IteratingSystem<BoundsSystem> {
+	public:
+		BoundsSystem() : IteratingSystem(Family::all<PositionComponent>().exclude<ProjectileComponent>().get(), 6) {}
+
+	protected:
+		void processEntity(Entity* entity, float deltaTime) override {
+			auto position = entity->get<PositionComponent>();
+			position->x = std::min(WORLD_SIZE, std::max(0.0f, position->x));
+			position->y = std::min(WORLD_SIZE, std::max(0.0f, position->y));
+		}
+	};
+
+	// 8. Cools down weapons.
+	class WeaponCooldownSystem : public IteratingSystem<WeaponCooldownSystem> {
+	public:
+		WeaponCooldownSystem() : IteratingSystem(Family::all<WeaponComponent>().get(), 7) {}
+
+	protected:
+		void processEntity(Entity* entity, float deltaTime) override {
+			auto weapon = entity->get<WeaponComponent>();
+			if (weapon->cooldown > 0)
+				weapon->cooldown -= deltaTime;
+		}
+	};
+
+	// 9. Fires projectiles from blueprints.
+	class FireSystem : public IntervalIteratingSystem<FireSystem> {
+	private:
+		Context& context;
+		Engine* engine = nullptr;
+
+	public:
+		explicit FireSystem(Context& context)
+			: IntervalIteratingSystem(Family::all<WeaponComponent, PositionComponent, TeamComponent>().get(), 0.1f, 8),
+			context(context) {}
+
+		void addedToEngine(Engine* engine) override {
+			IntervalIteratingSystem::addedToEngine(engine);
+			this->engine = engine;
+		}
+
+	protected:
+		void processEntity(Entity* entity) override {
+			auto weapon = entity->get<WeaponComponent>();
+			if (weapon->cooldown > 0)
+				return;
+			weapon->cooldown = 1.0f / weapon->rate;
+			auto position = entity->get<PositionComponent>();
+			auto projectile = engine->assembleEntity("projectile");
+			auto projectilePosition = projectile->get<PositionComponent>();
+			projectilePosition->x = position->x;
+			projectilePosition->y = position->y;
+			auto velocity = projectile->get<VelocityComponent>();
+			float angle = context.random.range(0, 6.2831853f);
+			velocity->x = std::cos(angle) * 120;
+			velocity->y = std::sin(angle) * 120;
+			projectile->get<ProjectileComponent>()->damage = weapon->damage;
+			projectile->get<TeamComponent>()->team = entity->get<TeamComponent>()->team;
+			engine->addEntity(projectile);
+			context.projectilesFired++;
+		}
+	};
+
+	// 10. Removes expired entities.
+	class LifetimeSystem : public IteratingSystem<LifetimeSystem> {
+	private:
+		Engine* engine = nullptr;
+
+	public:
+		LifetimeSystem() : IteratingSystem(Family::all<LifetimeComponent>().get(), 9) {}
+
+		void addedToEngine(Engine* engine) override {
+			IteratingSystem::addedToEngine(engine);
+			this->engine = engine;
+		}
+
+	protected:
+		void processEntity(Entity* entity, float deltaTime) override {
+			auto lifetime = entity->get<LifetimeComponent>();
+			lifetime->remaining -= deltaTime;
+			if (lifetime->remaining <= 0)
+				engine->removeEntity(entity);
+		}
+	};
+
+	struct CompareX {
+		bool operator()(Entity* a, Entity* b) const {
+			return a->get<PositionComponent>()->x < b->get<PositionComponent>()->x;
+		}
+	};
+
+	// 11. Sweep and prune collision of projectiles against everything of another team.
+	class CollisionSystem : public SortedIteratingSystem<CollisionSystem, CompareX> {
+	private:
+		Context& context;
+		Engine* engine = nullptr;
+		const std::vector<Entity*>* sorted = nullptr;
+		size_t index = 0;
+
+	public:
+		explicit CollisionSystem(Context& context)
+			: SortedIteratingSystem(Family::all<ColliderComponent, PositionComponent, TeamComponent>().get(), CompareX(), 10),
+			context(context) {}
+
+		void addedToEngine(Engine* engine) override {
+			SortedIteratingSystem::addedToEngine(engine);
+			this->engine = engine;
+		}
+
+		void update(float deltaTime) override {
+			// Positions change every frame
+			forceSort();
+			sorted = getEntities();
+			index = 0;
+			SortedIteratingSystem::update(deltaTime);
+		}
+
+	protected:
+		void processEntity(Entity* entity, float deltaTime) override {
+			size_t current = index++;
+			auto projectile = entity->get<ProjectileComponent>();
+			if (!projectile || entity->isScheduledForRemoval())
+				return;
+			auto position = entity->get<PositionComponent>();
+			auto radius = entity->get<ColliderComponent>()->radius;
+			auto team = entity->get<TeamComponent>()->team;
+			for (size_t i = current + 1; i < sorted->size() && i <= current + 16; i++) {
+				auto other = (*sorted)[i];
+				auto otherPosition = other->get<PositionComponent>();
+				auto otherRadius = other->get<ColliderComponent>()->radius;
+				if (otherPosition->x - position->x > radius + otherRadius)
+					break;
+				if (other->get<TeamComponent>()->team == team || other->has<ProjectileComponent>())
+					continue;
+				if (std::abs(otherPosition->y - position->y) > radius + otherRadius)
+					continue;
+				auto health = other->getMut<HealthComponent>();
+				if (health) {
+					health->value -= projectile->damage;
+					context.hits++;
+				}
+				engine->removeEntity(entity);
+				return;
+			}
+		}
+	};
+
+	// 12. Randomly sets entities on fire (component churn).
+	class IgniteSystem : public IntervalIteratingSystem<IgniteSystem> {
+	private:
+		Context& context;
+
+	public:
+		explicit IgniteSystem(Context& context)
+			: IntervalIteratingSystem(Family::all<HealthComponent>().exclude<BurningComponent>().get(), 0.5f, 11),
+			context(context) {}
+
+	protected:
+		void processEntity(Entity* entity) override {
+			if (context.random.chance(20)) {
+				entity->emplace<BurningComponent>();
+				context.statusEffectsApplied++;
+			}
+		}
+	};
+
+	// 13. Burning damages entities until it expires.
+	class BurningSystem : public IteratingSystem<BurningSystem> {
+	public:
+		BurningSystem() : IteratingSystem(Family::all<BurningComponent, HealthComponent>().get(), 12) {}
+
+	protected:
+		void processEntity(Entity* entity, float deltaTime) override {
+			auto burning = entity->get<BurningComponent>();
+			entity->getMut<HealthComponent>()->value -= burning->damage * deltaTime;
+			burning->remaining -= deltaTime;
+			if (burning->remaining <= 0)
+				entity->remove<BurningComponent>();
+		}
+	};
+
+	// 14. Regenerates health.
+	class RegenSystem : public IteratingSystem<RegenSystem> {
+	public:
+		RegenSystem() : IteratingSystem(Family::all<RegenComponent, HealthComponent>().get(), 13) {}
+
+	protected:
+		void processEntity(Entity* entity, float deltaTime) override {
+			auto health = entity->get<HealthComponent>();
+			if (health->value < health->max) {
+				health = entity->getMut<HealthComponent>();
+				health->value = std::min(health->max, health->value + entity->get<RegenComponent>()->rate * deltaTime);
+			}
+		}
+	};
+
+	// 15. Removes dead entities and drops loot. Players respawn instead.
+	class DeathSystem : public IteratingSystem<DeathSystem> {
+	private:
+		Context& context;
+		Engine* engine = nullptr;
+
+	public:
+		explicit DeathSystem(Context& context)
+			: IteratingSystem(Family::all<HealthComponent, PositionComponent>().get(), 14), context(context) {}
+
+		void addedToEngine(Engine* engine) override {
+			IteratingSystem::addedToEngine(engine);
+			this->engine = engine;
+		}
+
+	protected:
+		void processEntity(Entity* entity, float deltaTime) override {
+			auto health = entity->get<HealthComponent>();
+			if (health->value > 0)
+				return;
+			auto position = entity->get<PositionComponent>();
+			if (entity->has<PlayerComponent>()) {
+				entity->getMut<HealthComponent>()->value = health->max;
+				position->x = context.random.range(0, WORLD_SIZE);
+				position->y = context.random.range(0, WORLD_SIZE);
+				return;
+			}
+			if (context.random.chance(4))
+				spawn(engine, context, "loot", position->x, position->y);
+			engine->removeEntity(entity);
+		}
+	};
+
+	// 16. Players collect loot.
+	class LootSystem : public IntervalIteratingSystem<LootSystem> {
+	private:
+		Context& context;
+		Engine* engine = nullptr;
+		const std::vector<Entity*>* players = nullptr;
+
+	public:
+		explicit LootSystem(Context& context)
+			: IntervalIteratingSystem(Family::all<LootComponent, PositionComponent>().get(), 0.2f, 15), context(context) {}
+
+		void addedToEngine(Engine* engine) override {
+			IntervalIteratingSystem::addedToEngine(engine);
+			this->engine = engine;
+			players = engine->getEntitiesFor(Family::all<PlayerComponent>().get());
+		}
+
+	protected:
+		void processEntity(Entity* entity) override {
+			if (players->empty() || !context.random.chance(8))
+				return;
+			auto player = (*players)[context.random.next() % players->size()];
+			player->getMut<PlayerComponent>()->score += entity->get<LootComponent>()->value;
+			engine->removeEntity(entity);
+		}
+	};
+
+	// 17. Replication priority depends on the distance to the world center and whether something changed.
+	class ReplicationPrioritySystem : public IteratingSystem<ReplicationPrioritySystem> {
+	public:
+		ReplicationPrioritySystem()
+			: IteratingSystem(Family::all<ReplicatedComponent, PositionComponent>().get(), 16) {}
+
+	protected:
+		void processEntity(Entity* entity, float deltaTime) override {
+			auto replicated = entity->get<ReplicatedComponent>();
+			auto position = entity->get<PositionComponent>();
+			float dx = position->x - WORLD_SIZE / 2;
+			float dy = position->y - WORLD_SIZE / 2;
+			replicated->priority = (replicated->dirty ? 1000.0f : 0.0f) - std::sqrt(dx * dx + dy * dy);
+		}
+	};
+
+	// 18. Marks entities with changed health as dirty.
+	class HealthChangedSystem : public IteratingSystem<HealthChangedSystem> {
+	public:
+		HealthChangedSystem()
+			: IteratingSystem(Family::changed<HealthComponent>().all<ReplicatedComponent>().get(), 17) {}
+
+	protected:
+		void processEntity(Entity* entity, float deltaTime) override {
+			entity->get<ReplicatedComponent>()->dirty = true;
+		}
+	};
+
+	struct ComparePriority {
+		bool operator()(Entity* a, Entity* b) const {
+			return a->get<ReplicatedComponent>()->priority > b->get<ReplicatedComponent>()->priority;
+		}
+	};
+
+	// 19. Serializes the most important entities into a packet.
+	class ReplicationSystem : public SortedIteratingSystem<ReplicationSystem, ComparePriority> {
+	private:
+		Context& context;
+		std::vector<float> packet;
+		size_t budget = 0;
+
+	public:
+		explicit ReplicationSystem(Context& context)
+			: SortedIteratingSystem(Family::all<ReplicatedComponent, PositionComponent>().get(), ComparePriority(), 18),
+			context(context) {}
+
+		void update(float deltaTime) override {
+			forceSort();
+			packet.clear();
+			budget = 1024;
+			SortedIteratingSystem::update(deltaTime);
+			context.replicatedBytes += packet.size() * sizeof(float);
+		}
+
+	protected:
+		void processEntity(Entity* entity, float deltaTime) override {
+			auto replicated = entity->get<ReplicatedComponent>();
+			if (!budget || !replicated->dirty)
+				return;
+			budget--;
+			replicated->dirty = false;
+			auto position = entity->get<PositionComponent>();
+			packet.push_back(static_cast<float>(entity->getId()));
+			packet.push_back(position->x);
+			packet.push_back(position->y);
+		}
+	};
+
+	struct CompareLayer {
+		bool operator()(Entity* a, Entity* b) const {
+			return a->get<SpriteComponent>()->layer < b->get<SpriteComponent>()->layer;
+		}
+	};
+
+	// 20. Collects visible sprites of a spectator camera in layer order.
+	class RenderCullSystem : public SortedIteratingSystem<RenderCullSystem, CompareLayer> {
+	private:
+		std::vector<Entity*> visible;
+
+	public:
+		RenderCullSystem()
+			: SortedIteratingSystem(Family::all<SpriteComponent, PositionComponent>().get(), CompareLayer(), 19) {}
+
+		void update(float deltaTime) override {
+			visible.clear();
+			SortedIteratingSystem::update(deltaTime);
+		}
+
+	protected:
+		void processEntity(Entity* entity, float deltaTime) override {
+			auto position = entity->get<PositionComponent>();
+			if (position->x > 250 && position->x < 750 && position->y > 250 && position->y < 750)
+				visible.push_back(entity);
+		}
+	};
+
+	// 21. Advances sprite animations at 30 fps.
+	class AnimationSystem : public IntervalIteratingSystem<AnimationSystem> {
+	public:
+		AnimationSystem() : IntervalIteratingSystem(Family::all<SpriteComponent>().get(), 1.0f / 30.0f, 20) {}
+
+	protected:
+		void processEntity(Entity* entity) override {
+			auto sprite = entity->get<SpriteComponent>();
+			sprite->frame = (sprite->frame + 1) % 8;
+		}
+	};
+
+	// 22. Aggregates the score once per second.
+	class ScoreSystem : public IntervalIteratingSystem<ScoreSystem> {
+	public:
+		int totalScore = 0;
+
+		ScoreSystem() : IntervalIteratingSystem(Family::all<PlayerComponent>().get(), 1.0f, 21) {}
+
+		void updateInterval() override {
+			totalScore = 0;
+			IntervalIteratingSystem::updateInterval();
+		}
+
+	protected:
+		void processEntity(Entity* entity) override {
+			totalScore += entity->get<PlayerComponent>()->score;
+		}
+	};
+
+	struct Result {
+		float avg, p50, p90, p99, max;
+		uint32_t peakAllocations;
+		MemoryStats memory;
+		size_t finalEntities;
+		size_t peakEntities;
+		double totalSeconds;
+	};
+
+	Result run(Context& context) {
+		auto memoryManager = std::make_shared<DefaultMemoryManager>();
+		Engine engine(memoryManager);
+		engine.setEntityFactory(createEntityFactory());
+		engine.setFrameBudget(context.options.frameBudget);
+
+		// Listeners
+		uint64_t entitiesAdded = 0, entitiesRemoved = 0, playersAdded = 0, burningAdded = 0;
+		Signal11::ConnectionScope scope;
+		scope += engine.entityAdded.connect([&](Entity*) { entitiesAdded++; });
+		scope += engine.entityRemoved.connect([&](Entity*) { entitiesRemoved++; });
+		scope += engine.getEntityAddedSignal(Family::all<PlayerComponent>().get()).connect([&](Entity*) { playersAdded++; });
+		scope += engine.componentAdded.connect([&](Entity*, ComponentBase* component) {
+			if (component->type == getComponentType<BurningComponent>())
+				burningAdded++;
+		});
+
+		engine.emplaceSystem<WaveSystem>(context);
+		engine.emplaceSystem<AiThinkSystem>(context)->setStaggered(context.options.staggered);
+		engine.emplaceSystem<SteeringSystem>();
+		engine.emplaceSystem<PlayerInputSystem>(context);
+		engine.emplaceSystem<MovementSystem>();
+		engine.emplaceSystem<DampingSystem>();
+		engine.emplaceSystem<BoundsSystem>();
+		engine.emplaceSystem<WeaponCooldownSystem>();
+		engine.emplaceSystem<FireSystem>(context)->setStaggered(context.options.staggered);
+		engine.emplaceSystem<LifetimeSystem>();
+		engine.emplaceSystem<CollisionSystem>(context)->setSortMode(context.options.sortMode);
+		engine.emplaceSystem<IgniteSystem>(context)->setStaggered(context.options.staggered);
+		engine.emplaceSystem<BurningSystem>();
+		engine.emplaceSystem<RegenSystem>();
+		engine.emplaceSystem<DeathSystem>(context);
+		engine.emplaceSystem<LootSystem>(context)->setStaggered(context.options.staggered);
+		engine.emplaceSystem<ReplicationPrioritySystem>();
+		engine.emplaceSystem<HealthChangedSystem>();
+		engine.emplaceSystem<ReplicationSystem>(context)->setSortMode(context.options.sortMode);
+		engine.emplaceSystem<RenderCullSystem>()->setSortMode(context.options.sortMode);
+		engine.emplaceSystem<AnimationSystem>()->setStaggered(context.options.staggered);
+		engine.emplaceSystem<ScoreSystem>();
+
+		// Deferrable systems may be skipped when a frame budget is set
+		engine.getSystem<AnimationSystem>()->setPriorityClass(PriorityClass::Deferrable);
+		engine.getSystem<RenderCullSystem>()->setPriorityClass(PriorityClass::Deferrable);
+		engine.getSystem<ScoreSystem>()->setPriorityClass(PriorityClass::Deferrable);
+
+		for (int i = 0; i < context.options.players; i++)
+			spawn(&engine, context, "player", context.random.range(0, WORLD_SIZE), context.random.range(0, WORLD_SIZE));
+
+		RollingStats frameTimes(context.options.frames);
+		Result result = {};
+		auto start = std::chrono::steady_clock::now();
+		for (int frame = 0; frame < context.options.frames; frame++) {
+			auto frameStart = std::chrono::steady_clock::now();
+			engine.update(FRAME_TIME);
+			frameTimes.add(std::chrono::duration<float>(std::chrono::steady_clock::now() - frameStart).count());
+			result.peakAllocations = std::max(result.peakAllocations, memoryManager->getAllocationCount());
+			result.peakEntities = std::max(result.peakEntities, engine.getEntities()->size());
+		}
+		result.totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		result.avg = frameTimes.getAvg();
+		result.p50 = frameTimes.getPercentile(50);
+		result.p90 = frameTimes.getPercentile(90);
+		result.p99 = frameTimes.getP99();
+		result.max = frameTimes.getMax();
+		result.finalEntities = engine.getEntities()->size();
+		result.memory = memoryManager->getStats();
+
+		if (playersAdded != static_cast<uint64_t>(context.options.players) || entitiesAdded < context.spawned
+			|| entitiesRemoved < context.despawned || !burningAdded) {
+			std::cerr << "Unexpected listener counts" << std::endl;
+			std::exit(1);
+		}
+		return result;
+	}
+
+	void writeJson(std::ostream& stream, const Context& context, const Result& result) {
+		auto& options = context.options;
+		stream << std::fixed << std::setprecision(6)
+			<< "{\n\t\"options\": { \"frames\": " << options.frames << ", \"wave_size\": " << options.waveSize
+			<< ", \"max_waves\": " << options.maxWaves << ", \"players\": " << options.players
+			<< ", \"seed\": " << options.seed
+			<< ", \"sort_mode\": \"" << (options.sortMode == SortMode::Full ? "full" : "incremental") << "\""
+			<< ", \"staggered\": " << (options.staggered ? "true" : "false")
+			<< ", \"frame_budget\": " << options.frameBudget << " },\n"
+			<< "\t\"frame_time\": { \"avg\": " << result.avg << ", \"p50\": " << result.p50 << ", \"p90\": "
+			<< result.p90 << ", \"p99\": " << result.p99 << ", \"max\": " << result.max << ", \"unit\": \"s\" },\n"
+			<< "\t\"total_time\": " << result.totalSeconds << ",\n"
+			<< "\t\"peak_allocations\": " << result.peakAllocations << ",\n"
+			<< "\t\"peak_used_bytes\": " << result.memory.peakUsedBytes << ",\n"
+			<< "\t\"reserved_bytes\": " << result.memory.reservedBytes << ",\n"
+			<< "\t\"peak_entities\": " << result.peakEntities << ",\n"
+			<< "\t\"final_entities\": " << result.finalEntities << ",\n"
+			<< "\t\"spawned\": " << context.spawned << ",\n"
+			<< "\t\"despawned\": " << context.despawned << ",\n"
+			<< "\t\"projectiles\": " << context.projectilesFired << ",\n"
+			<< "\t\"hits\": " << context.hits << ",\n"
+			<< "\t\"status_effects\": " << context.statusEffectsApplied << ",\n"
+			<< "\t\"replicated_bytes\": " << context.replicatedBytes << "\n}\n";
+	}
+
+	bool parseOptions(int argc, char** argv, Options& options) {
+		for (int i = 1; i < argc; i++) {
+			std::string arg = argv[i];
+			auto value = arg.substr(arg.find('=') + 1);
+			if (arg.compare(0, 9, "--frames=") == 0)
+				options.frames = std::max(1, std::atoi(value.c_str()));
+			else if (arg.compare(0, 12, "--wave-size=") == 0)
+				options.waveSize = std::atoi(value.c_str());
+			else if (arg.compare(0, 12, "--max-waves=") == 0)
+				options.maxWaves = std::atoi(value.c_str());
+			else if (arg.compare(0, 10, "--players=") == 0)
+				options.players = std::atoi(value.c_str());
+			else if (arg.compare(0, 7, "--seed=") == 0)
+				options.seed = static_cast<uint32_t>(std::atol(value.c_str()));
+			else if (arg == "--sort-mode=full")
+				options.sortMode = SortMode::Full;
+			else if (arg == "--sort-mode=incremental")
+				options.sortMode = SortMode::Incremental;
+			else if (arg == "--staggered")
+				options.staggered = true;
+			else if (arg.compare(0, 15, "--frame-budget=") == 0)
+				options.frameBudget = static_cast<float>(std::atof(value.c_str()));
+			else if (arg.compare(0, 6, "--out=") == 0)
+				options.out = value;
+			else {
+				std::cerr << "Usage: " << argv[0] << " [--frames=<count>] [--wave-size=<count>] [--max-waves=<count>]"
+					<< " [--players=<count>] [--seed=<number>] [--sort-mode=full|incremental] [--staggered]"
+					<< " [--frame-budget=<seconds>] [--out=<file>]" << std::endl;
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+int main(int argc, char** argv) {
+	using namespace simulation;
+	Options options;
+	if (!parseOptions(argc, argv, options))
+		return 1;
+
+	Context context(options);
+	auto result = run(context);
+	writeJson(std::cout, context, result);
+	if (!options.out.empty()) {
+		std::ofstream file(options.out);
+		if (!file.is_open()) {
+			std::cerr << "Could not open " << options.out << std::endl;
+			return 1;
+		}
+		writeJson(file, context, result);
+	}
+	return 0;
+}
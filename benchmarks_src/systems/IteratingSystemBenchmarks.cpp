@@ -0,0 +1,67 @@
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include "../BenchmarkBase.hpp"
+#include <ecstasy/systems/IteratingSystem.hpp>
+
+namespace IteratingSystemBenchmarks {
+	using ecstasy::Engine;
+	using ecstasy::Entity;
+	using ecstasy::Family;
+
+	class MoveSystem : public ecstasy::IteratingSystem<MoveSystem> {
+	public:
+		MoveSystem() : IteratingSystem(Family::all<BenchComponent<0>, BenchComponent<1>>().get()) {}
+
+		void processEntity(Entity* entity, float deltaTime) override {
+			entity->get<BenchComponent<0>>()->value += entity->get<BenchComponent<1>>()->value * deltaTime;
+		}
+	};
+
+	class StaticMoveSystem : public ecstasy::StaticIteratingSystem<StaticMoveSystem> {
+	public:
+		StaticMoveSystem() : StaticIteratingSystem(Family::all<BenchComponent<0>, BenchComponent<1>>().get()) {}
+
+		void processEntity(Entity* entity, float deltaTime) {
+			entity->get<BenchComponent<0>>()->value += entity->get<BenchComponent<1>>()->value * deltaTime;
+		}
+	};
+
+	/// Update an engine with one system (range 0 = entities, range 1 = components per entity)
+	template<typename S>
+	static void iterate(BenchmarkState& state) {
+		auto count = state.range(0);
+		Engine engine;
+		engine.emplaceSystem<S>();
+		for (int64_t i = 0; i < count; i++) {
+			auto entity = engine.createEntity();
+			emplaceComponents(entity, state.range(1));
+			engine.addEntity(entity);
+		}
+		while (state.keepRunning())
+			engine.update(0.016f);
+		state.setItemsProcessed(state.getIterations() * count);
+	}
+
+	static void iteratingSystem(BenchmarkState& state) {
+		iterate<MoveSystem>(state);
+	}
+	BENCHMARK(iteratingSystem)->args({ 10000, 2 })->args({ 100000, 2 })->args({ 100000, 8 })->args({ 1000000, 2 });
+
+	static void staticIteratingSystem(BenchmarkState& state) {
+		iterate<StaticMoveSystem>(state);
+	}
+	BENCHMARK(staticIteratingSystem)->args({ 10000, 2 })->args({ 100000, 2 })->args({ 1000000, 2 });
+}
@@ -0,0 +1,186 @@
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include "../BenchmarkBase.hpp"
+#include <ecstasy/utils/Blueprint.hpp>
+#include <ecstasy/utils/BlueprintPack.hpp>
+#include <ecstasy/utils/BlueprintParser.hpp>
+#include <ecstasy/utils/Tokenizer.hpp>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace BlueprintBenchmarks {
+	using ecstasy::EntityBlueprint;
+	using ecstasy::BlueprintPack;
+
+	const char* const PACK_FILE = "blueprint_benchmark.bin";
+
+	/// A blueprint with 8 components and 3 values each
+	std::string createBlueprintText(int64_t index) {
+		std::ostringstream text;
+		for (int i = 0; i < 8; i++) {
+			text << "add Component" << i << "\n";
+			text << "\tset x " << index * 0.5f << "\n";
+			text << "\tset count " << index + i << "\n";
+			text << "\tset label \"blueprint number " << index << "\" # comment\n";
+		}
+		return text.str();
+	}
+
+	/// Parse blueprint texts (range 0 = blueprints)
+	static void parseText(BenchmarkState& state) {
+		auto count = state.range(0);
+		std::vector<std::string> texts;
+		for (int64_t i = 0; i < count; i++)
+			texts.push_back(createBlueprintText(i));
+		while (state.keepRunning()) {
+			for (auto& text : texts) {
+				std::istringstream stream(text);
+				std::shared_ptr<EntityBlueprint> blueprint;
+				ecstasy::parseBlueprint(stream, blueprint);
+				doNotOptimize(blueprint);
+			}
+		}
+		state.setItemsProcessed(state.getIterations() * count);
+	}
+	BENCHMARK(parseText)->args({ 8000 });
+
+	/// Tokenize blueprint texts line by line into strings (range 0 = blueprints)
+	static void tokenizeStrings(BenchmarkState& state) {
+		auto count = state.range(0);
+		std::string texts;
+		for (int64_t i = 0; i < count; i++)
+			texts += createBlueprintText(i);
+		while (state.keepRunning()) {
+			std::istringstream stream(texts);
+			std::vector<std::string> tokens;
+			std::string line;
+			while (std::getline(stream, line)) {
+				tokens.clear();
+				ecstasy::parseTokens(line, tokens);
+				doNotOptimize(tokens);
+			}
+		}
+		state.setItemsProcessed(state.getIterations() * count);
+	}
+	BENCHMARK(tokenizeStrings)->args({ 8000 });
+
+	/// Tokenize blueprint texts in one buffer using views (range 0 = blueprints)
+	static void tokenizeViews(BenchmarkState& state) {
+		auto count = state.range(0);
+		std::string texts;
+		for (int64_t i = 0; i < count; i++)
+			texts += createBlueprintText(i);
+		while (state.keepRunning()) {
+			ecstasy::LineTokenizer tokenizer(texts);
+			while (tokenizer.nextLine())
+				doNotOptimize(tokenizer.getTokens());
+		}
+		state.setItemsProcessed(state.getIterations() * count);
+	}
+	BENCHMARK(tokenizeViews)->args({ 8000 });
+
+	/// Open a blueprint pack and read all blueprints (range 0 = blueprints)
+	static void readPack(BenchmarkState& state) {
+		auto count = state.range(0);
+		std::map<std::string, std::shared_ptr<EntityBlueprint>> blueprints;
+		for (int64_t i = 0; i < count; i++) {
+			std::istringstream stream(createBlueprintText(i));
+			ecstasy::parseBlueprint(stream, blueprints["blueprint" + std::to_string(i)]);
+		}
+		{
+			std::ofstream file(PACK_FILE, std::ios::binary);
+			BlueprintPack::write(file, blueprints);
+		}
+		while (state.keepRunning()) {
+			BlueprintPack pack;
+			pack.open(PACK_FILE);
+			for (uint32_t i = 0; i < pack.getBlueprintCount(); i++)
+				doNotOptimize(pack.getBlueprint(i));
+		}
+		std::remove(PACK_FILE);
+		state.setItemsProcessed(state.getIterations() * count);
+	}
+	BENCHMARK(readPack)->args({ 8000 });
+
+	/// Open a blueprint pack and look up each blueprint by name (range 0 = blueprints)
+	static void findInPack(BenchmarkState& state) {
+		auto count = state.range(0);
+		std::map<std::string, std::shared_ptr<EntityBlueprint>> blueprints;
+		std::vector<std::string> names;
+		for (int64_t i = 0; i < count; i++) {
+			names.push_back("blueprint" + std::to_string(i));
+			blueprints[names.back()] = std::make_shared<EntityBlueprint>();
+		}
+		{
+			std::ofstream file(PACK_FILE, std::ios::binary);
+			BlueprintPack::write(file, blueprints);
+		}
+		while (state.keepRunning()) {
+			BlueprintPack pack;
+			pack.open(PACK_FILE);
+			for (auto& name : names)
+				doNotOptimize(pack.find(name));
+		}
+		std::remove(PACK_FILE);
+		state.setItemsProcessed(state.getIterations() * count);
+	}
+	BENCHMARK(findInPack)->args({ 8000 });
+
+	/// Create a component blueprint with 8 values, of which 3 are read
+	std::shared_ptr<ecstasy::ComponentBlueprint> createComponentBlueprint() {
+		auto blueprint = std::make_shared<ecstasy::ComponentBlueprint>("Component");
+		for (int i = 0; i < 5; i++)
+			blueprint->set("unused" + std::to_string(i), std::to_string(i));
+		blueprint->set("x", "0.5");
+		blueprint->set("count", "42");
+		blueprint->set("visible", "true");
+		return blueprint;
+	}
+
+	/// Read blueprint values by their name (range 0 = reads)
+	static void readValuesByName(BenchmarkState& state) {
+		auto count = state.range(0);
+		auto blueprint = createComponentBlueprint();
+		while (state.keepRunning()) {
+			for (int64_t i = 0; i < count; i++) {
+				doNotOptimize(blueprint->getFloat("x", 0));
+				doNotOptimize(blueprint->getInt("count", 0));
+				doNotOptimize(blueprint->getBool("visible", false));
+			}
+		}
+		state.setItemsProcessed(state.getIterations() * count);
+	}
+	BENCHMARK(readValuesByName)->args({ 8000 });
+
+	/// Read blueprint values by their interned key (range 0 = reads)
+	static void readValuesByKey(BenchmarkState& state) {
+		auto count = state.range(0);
+		auto blueprint = createComponentBlueprint();
+		auto x = ecstasy::ComponentBlueprint::getKey("x");
+		auto countKey = ecstasy::ComponentBlueprint::getKey("count");
+		auto visible = ecstasy::ComponentBlueprint::getKey("visible");
+		while (state.keepRunning()) {
+			for (int64_t i = 0; i < count; i++) {
+				doNotOptimize(blueprint->getFloat(x, 0));
+				doNotOptimize(blueprint->getInt(countKey, 0));
+				doNotOptimize(blueprint->getBool(visible, false));
+			}
+		}
+		state.setItemsProcessed(state.getIterations() * count);
+	}
+	BENCHMARK(readValuesByKey)->args({ 8000 });
+}
@@ -0,0 +1,134 @@
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include "../BenchmarkBase.hpp"
+#include <ecstasy/utils/Blueprint.hpp>
+#include <ecstasy/utils/BlueprintParser.hpp>
+#include <ecstasy/utils/ComponentFactory.hpp>
+#include <ecstasy/utils/ComponentFields.hpp>
+#include <ecstasy/utils/EntityFactory.hpp>
+#include <sstream>
+
+namespace EntityFactoryBenchmarks {
+	using ecstasy::Engine;
+	using ecstasy::Entity;
+	using ecstasy::EntityFactory;
+	using ecstasy::EntityBlueprint;
+	using ecstasy::ComponentBlueprint;
+
+	/// Reads the blueprint values on every assembly
+	template<int N>
+	class ParsingFactory : public ecstasy::ComponentFactory {
+	public:
+		bool assemble(Entity* entity, ComponentBlueprint& blueprint) override {
+			entity->emplace<BenchComponent<N>>()->value = blueprint.getFloat("value", 0);
+			return true;
+		}
+	};
+
+	/// Reads the blueprint values once when the blueprint is compiled
+	template<int N>
+	class CompiledFactory : public ecstasy::CompiledComponentFactory<float> {
+	protected:
+		void parse(float& data, const ComponentBlueprint& blueprint) override {
+			data = blueprint.getFloat("value", 0);
+		}
+
+		bool create(Entity* entity, const float& data) override {
+			entity->emplace<BenchComponent<N>>()->value = data;
+			return true;
+		}
+	};
+
+	/// Writes the blueprint values to the registered fields
+	template<int N>
+	using ReflectedFactory = ecstasy::ReflectedComponentFactory<BenchComponent<N>>;
+
+	template<template<int> class Factory>
+	std::shared_ptr<EntityFactory> createFactory() {
+		auto factory = std::make_shared<EntityFactory>();
+		factory->addComponentFactory<Factory<0>>("A");
+		factory->addComponentFactory<Factory<1>>("B");
+		factory->addComponentFactory<Factory<2>>("C");
+		factory->addComponentFactory<Factory<3>>("D");
+
+		std::istringstream stream("add A\n set value 1\nadd B\n set value 2\nadd C\n set value 3\nadd D\n set value 4\n");
+		std::shared_ptr<EntityBlueprint> blueprint;
+		ecstasy::parseBlueprint(stream, blueprint);
+		factory->addEntityBlueprint("monster", blueprint);
+		return factory;
+	}
+
+	/// Assemble entities with 4 components by blueprint name (range 0 = entities)
+	static void assembleByName(BenchmarkState& state) {
+		auto count = state.range(0);
+		Engine engine;
+		engine.setEntityFactory(createFactory<ParsingFactory>());
+		std::vector<Entity*> entities;
+		entities.reserve(count);
+		while (state.keepRunning()) {
+			for (int64_t i = 0; i < count; i++)
+				entities.push_back(engine.assembleEntity("monster"));
+			state.pauseTiming();
+			engine.removeEntities(entities);
+			entities.clear();
+			state.resumeTiming();
+		}
+		state.setItemsProcessed(state.getIterations() * count);
+	}
+	BENCHMARK(assembleByName)->args({ 10000 })->args({ 100000 });
+
+	/// Assemble entities with 4 components using a compiled blueprint (range 0 = entities)
+	static void assembleCompiled(BenchmarkState& state) {
+		auto count = state.range(0);
+		Engine engine;
+		auto factory = createFactory<CompiledFactory>();
+		engine.setEntityFactory(factory);
+		auto id = factory->compile("monster");
+		std::vector<Entity*> entities;
+		entities.reserve(count);
+		while (state.keepRunning()) {
+			for (int64_t i = 0; i < count; i++)
+				entities.push_back(engine.assembleEntity(id));
+			state.pauseTiming();
+			engine.removeEntities(entities);
+			entities.clear();
+			state.resumeTiming();
+		}
+		state.setItemsProcessed(state.getIterations() * count);
+	}
+	BENCHMARK(assembleCompiled)->args({ 10000 })->args({ 100000 });
+
+	/// Assemble entities with 4 components using a compiled blueprint and registered fields (range 0 = entities)
+	static void assembleReflected(BenchmarkState& state) {
+		auto count = state.range(0);
+		Engine engine;
+		auto factory = createFactory<ReflectedFactory>();
+		engine.setEntityFactory(factory);
+		auto id = factory->compile("monster");
+		std::vector<Entity*> entities;
+		entities.reserve(count);
+		while (state.keepRunning()) {
+			for (int64_t i = 0; i < count; i++)
+				entities.push_back(engine.assembleEntity(id));
+			state.pauseTiming();
+			engine.removeEntities(entities);
+			entities.clear();
+			state.resumeTiming();
+		}
+		state.setItemsProcessed(state.getIterations() * count);
+	}
+	BENCHMARK(assembleReflected)->args({ 10000 })->args({ 100000 });
+}
@@ -0,0 +1,72 @@
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include "../BenchmarkBase.hpp"
+#include <ecstasy/utils/DefaultMemoryManager.hpp>
+
+namespace MemoryManagerBenchmarks {
+	using ecstasy::DefaultMemoryManager;
+
+	/// Allocate and free blocks in LIFO order (range 0 = allocations, range 1 = block size)
+	static void allocateFree(BenchmarkState& state) {
+		auto count = state.range(0);
+		auto size = static_cast<uint32_t>(state.range(1));
+		DefaultMemoryManager memoryManager;
+		std::vector<void*> blocks(count);
+		while (state.keepRunning()) {
+			for (int64_t i = 0; i < count; i++)
+				blocks[i] = memoryManager.allocate(size, 8);
+			for (int64_t i = count - 1; i >= 0; i--)
+				memoryManager.free(size, 8, blocks[i]);
+		}
+		state.setItemsProcessed(state.getIterations() * count);
+	}
+	BENCHMARK(allocateFree)->args({ 10000, 16 })->args({ 10000, 128 })->args({ 1000000, 16 });
+
+	/// Allocate blocks and free them in an interleaved order (range 0 = allocations, range 1 = block size)
+	static void allocateFreeInterleaved(BenchmarkState& state) {
+		auto count = state.range(0);
+		auto size = static_cast<uint32_t>(state.range(1));
+		DefaultMemoryManager memoryManager;
+		std::vector<void*> blocks(count);
+		while (state.keepRunning()) {
+			for (int64_t i = 0; i < count; i++)
+				blocks[i] = memoryManager.allocate(size, 8);
+			for (int64_t i = 0; i < count; i += 2)
+				memoryManager.free(size, 8, blocks[i]);
+			for (int64_t i = 1; i < count; i += 2)
+				memoryManager.free(size, 8, blocks[i]);
+		}
+		state.setItemsProcessed(state.getIterations() * count);
+	}
+	BENCHMARK(allocateFreeInterleaved)->args({ 10000, 16 })->args({ 100000, 64 });
+
+	/// Allocate blocks, free them and give the memory back (range 0 = allocations, range 1 = block size)
+	static void reduceMemory(BenchmarkState& state) {
+		auto count = state.range(0);
+		auto size = static_cast<uint32_t>(state.range(1));
+		DefaultMemoryManager memoryManager;
+		std::vector<void*> blocks(count);
+		while (state.keepRunning()) {
+			for (int64_t i = 0; i < count; i++)
+				blocks[i] = memoryManager.allocate(size, 8);
+			for (int64_t i = 0; i < count; i++)
+				memoryManager.free(size, 8, blocks[i]);
+			memoryManager.reduceMemory();
+		}
+		state.setItemsProcessed(state.getIterations() * count);
+	}
+	BENCHMARK(reduceMemory)->args({ 10000, 16 })->args({ 100000, 64 });
+}
@@ -16,6 +16,9 @@
  ******************************************************************************/
 #include <ecstasy/core/Types.hpp>
 #include <ecstasy/utils/alignof.hpp>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 namespace ecstasy {
 	/// Non-Template base-class for Component. Extend Component instead.
@@ -28,7 +31,30 @@ namespace ecstasy {
 		const uint32_t memoryAlign;
 		virtual ~ComponentBase() {}
 
+		/// @return The change tick of the Engine when this component was last added or modified (see Entity::getMut()).
+		uint32_t getChangeTick() const { return changeTick; }
+
+		/**
+		 * Move construct a copy of this component in the specified memory. Used by Engine::compactMemory().
+		 * The caller is responsible for destroying and freeing this component afterwards.
+		 *
+		 * @param memory Memory of memorySize bytes, aligned to memoryAlign
+		 * @return The new component or @a nullptr if the component class is not move constructible.
+		 */
+		virtual ComponentBase* relocate(void* memory) = 0;
+
+		/**
+		 * Copy construct a copy of this component in the specified memory. Used by Engine::instantiate().
+		 *
+		 * @param memory Memory of memorySize bytes, aligned to memoryAlign
+		 * @return The new component or @a nullptr if the component class is not copy constructible.
+		 */
+		virtual ComponentBase* clone(void* memory) const = 0;
+
 	private:
+		friend class Entity;
+		uint32_t changeTick = 0;
+
 		template<typename T> friend struct Component;
 		// Private Constructor so nobody derives from this
 		explicit ComponentBase(ComponentType type, uint32_t memorySize, uint32_t memoryAlign)
@@ -44,6 +70,31 @@ namespace ecstasy {
 	template<typename T>
 	struct Component : public ComponentBase {
 		Component() : ComponentBase(getComponentType<T>(), sizeof(T), alignof(T)) {}
+
+		ComponentBase* relocate(void* memory) override {
+			return relocateTo(memory, std::is_move_constructible<T>());
+		}
+
+		ComponentBase* clone(void* memory) const override {
+			return cloneTo(memory, std::is_copy_constructible<T>());
+		}
+
+	private:
+		ComponentBase* relocateTo(void* memory, std::true_type) {
+			return new(memory) T(std::move(*static_cast<T*>(this)));
+		}
+
+		ComponentBase* relocateTo(void* memory, std::false_type) {
+			return nullptr;
+		}
+
+		ComponentBase* cloneTo(void* memory, std::true_type) const {
+			return new(memory) T(*static_cast<const T*>(this));
+		}
+
+		ComponentBase* cloneTo(void* memory, std::false_type) const {
+			return nullptr;
+		}
 	};
 }
 
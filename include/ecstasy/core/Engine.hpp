@@ -18,8 +18,11 @@
 #include <ecstasy/core/Types.hpp>
 #include <ecstasy/core/Entity.hpp>
 #include <ecstasy/core/EntityOperations.hpp>
+#include <ecstasy/core/EngineStats.hpp>
 #include <ecstasy/utils/MemoryManager.hpp>
+#include <ecstasy/utils/TraceRecorder.hpp>
 #include <stdint.h>
+#include <iosfwd>
 #include <vector>
 #include <string>
 #include <unordered_map>
@@ -27,6 +30,7 @@
 
 namespace ecstasy {
 	class EntityFactory;
+	class ComponentRegistry;
 	class EntitySystemBase;
 	class ComponentBase;
 	class Family;
@@ -36,6 +40,14 @@ namespace ecstasy {
 	/// Signal11::Signal for Entity signals
 	typedef Signal11::Signal<void(Entity*)> EntitySignal;
 
+	/// The memory used by the components of one ComponentType, see Engine::getComponentMemoryStats().
+	struct ComponentMemoryStats {
+		/// The number of components
+		uint32_t count = 0;
+		/// The number of bytes used by the components
+		uint64_t bytes = 0;
+	};
+
 	/**
 	 * The heart of the Entity framework. It is responsible for keeping track of Entity and
 	 * managing EntitySystem objects. The Engine should be updated every tick via the update(float) method.
@@ -57,6 +69,7 @@ namespace ecstasy {
 		friend class ComponentOperationHandler;
 		friend class EntityOperationHandler;
 		friend class Entity;
+		friend class DeltaRecorder;
 
 		std::vector<Entity*> entities;
 		std::unordered_map<uint64_t, Entity*> entitiesById;
@@ -74,7 +87,14 @@ namespace ecstasy {
 
 		bool updating = false;
 		bool notifying = false;
+		bool compacting = false;
+		size_t compactionIndex = 0;
 		uint64_t nextEntityId = 1;
+		uint32_t changeTick = 1;
+		float frameBudget = 0;
+		uint32_t signalEmissions = 0;
+		EngineStats stats;
+		std::shared_ptr<TraceRecorder> traceRecorder;
 
 		// Mechanism to delay component addition/removal to avoid affecting system processing
 		EntityOperationHandler entityOperationHandler;
@@ -89,6 +109,11 @@ namespace ecstasy {
 		EntitySignal entityAdded;
 		/// Will dispatch an event when an entity is removed.
 		EntitySignal entityRemoved;
+		/**
+		 * Will dispatch an event when a component has been moved to new memory by compactMemory().
+		 * Pointers to the old component are no longer valid. Listeners must not add or remove entities or components.
+		 */
+		ComponentSignal componentRelocated;
 
 	public:
 		/**
@@ -111,6 +136,14 @@ namespace ecstasy {
 			return memoryManager;
 		};
 
+		/**
+		 * Count the components of all entities added to this engine. This iterates over all entities,
+		 * so it is meant for diagnostics rather than being called every frame.
+		 *
+		 * @return The memory used per ComponentType (use the ComponentType as index).
+		 */
+		std::vector<ComponentMemoryStats> getComponentMemoryStats() const;
+
 		/// @return A new Entity. In order to add it to the Engine, use addEntity(Entity).
 		Entity* createEntity();
 
@@ -124,6 +157,61 @@ namespace ecstasy {
 		 */
 		Entity* assembleEntity(const std::string& blueprintname);
 
+		/**
+		 * Creates and assembles an Entity using a blueprint compiled by EntityFactory::compile().
+		 * In order to add it to the Engine, use addEntity().
+		 * setEntityFactory must be called before first use.
+		 *
+		 * @param id The id of the compiled blueprint
+		 * @return A fully assembled Entity or @a nullptr if the assembly failed.
+		 */
+		Entity* assembleEntity(BlueprintId id);
+
+		/**
+		 * Creates and assembles a number of entities using the same blueprint. The blueprint gets compiled
+		 * (see EntityFactory::compile()) and memory for the entities and their components is reserved up front.
+		 * In order to add them to the Engine, use addEntities().
+		 * setEntityFactory must be called before first use.
+		 *
+		 * @param count The number of entities to create
+		 * @param blueprintname The name of the entity blueprint
+		 * @return The assembled entities or an empty list if the assembly failed.
+		 */
+		std::vector<Entity*> createEntities(uint32_t count, const std::string& blueprintname);
+
+		/**
+		 * Like createEntities(uint32_t, const std::string&), but using a blueprint compiled by EntityFactory::compile().
+		 *
+		 * @param count The number of entities to create
+		 * @param id The id of the compiled blueprint
+		 * @return The assembled entities or an empty list if the assembly failed.
+		 */
+		std::vector<Entity*> createEntities(uint32_t count, BlueprintId id);
+
+		/**
+		 * Creates a number of entities, each with a default constructed instance of the specified components.
+		 * Memory for the entities and their components is reserved up front.
+		 * In order to add them to the Engine, use addEntities().
+		 *
+		 * @tparam Components The Component classes to emplace
+		 * @param count The number of entities to create
+		 * @return The new entities
+		 */
+		template<typename ... Components>
+		std::vector<Entity*> createEntities(uint32_t count) {
+			using expand = int[];
+			std::vector<Entity*> result;
+			result.reserve(count);
+			memoryManager->reservePinned(sizeof(Entity), alignof(Entity), count);
+			(void)expand{ 0, (reserveComponents<Components>(count), 0)... };
+			for (uint32_t i = 0; i < count; i++) {
+				auto entity = createEntity();
+				(void)expand{ 0, (entity->template emplace<Components>(), 0)... };
+				result.push_back(entity);
+			}
+			return result;
+		}
+
 		/**
 		 * Set the EntityFactory to use with assembleEntity.
 		 *
@@ -138,6 +226,38 @@ namespace ecstasy {
 		 */
 		void reduceMemory();
 
+		/**
+		 * Prepare for a number of entities, e.g. before loading a level. Pre-sizes the entity containers and lets the
+		 * MemoryManager reserve memory for the Entity objects. Memory not in use is released again by reduceMemory().
+		 *
+		 * @param entityCount The total number of entities expected.
+		 */
+		void reserve(uint32_t entityCount);
+
+		/**
+		 * Let the MemoryManager reserve memory for components of the specified class.
+		 * Memory not in use is released again by reduceMemory().
+		 *
+		 * @tparam T The Component class
+		 * @param count The number of components, which are about to be created.
+		 */
+		template<typename T>
+		void reserveComponents(uint32_t count) {
+			memoryManager->reserve(sizeof(T), alignof(T), count);
+		}
+
+		/**
+		 * Incrementally compact the memory: Components are moved out of sparsely used memory pages, so the pages can be
+		 * released. Call this repeatedly (e.g. once per frame) until it returns @a true. Listen to componentRelocated
+		 * if you keep pointers to components across calls. Components, which are not move constructible, stay in place.
+		 * Requires a MemoryManager supporting compaction (like DefaultMemoryManager).
+		 *
+		 * @param timeBudget The time in seconds this call may take. 0 means unlimited.
+		 * @return @a true when the compaction has finished and unused memory has been released.
+		 * @throws std::logic_error when called during update().
+		 */
+		bool compactMemory(float timeBudget = 0);
+
 		/**
 		 * Adds an entity to this Engine.
 		 *
@@ -153,10 +273,79 @@ namespace ecstasy {
 		void removeEntity(Entity* entity);
 
 		/**
-		 * Removes all entities registered with this Engine.
+		 * Removes all entities registered with this Engine, one by one, starting with the most recently added one.
+		 * Listeners see the remaining entities in the engine and their families.
 		 */
 		void removeAllEntities();
 
+		/**
+		 * Creates copies of a prototype Entity and adds them to this Engine using addEntities().
+		 * The components are copy constructed into memory reserved up front. No componentAdded signals are emitted
+		 * for the copied components. The prototype does not need to be added to an engine.
+		 *
+		 * @param prototype The Entity to copy
+		 * @param count The number of copies
+		 * @return The new entities or an empty list if one of the components is not copy constructible.
+		 */
+		std::vector<Entity*> instantiate(const Entity* prototype, uint32_t count);
+
+		/**
+		 * Write all entities to a compact binary snapshot: The entity ids, a component mask per Entity and the
+		 * fields of all components (see ECS_COMPONENT_FIELDS()), grouped by component type. Component types are
+		 * stored by the names they have been registered with, so the snapshot can be loaded by another build.
+		 * Data is written in the native byte order.
+		 *
+		 * @param stream The stream to write to.
+		 * @param registry The names of the component types. All component types in use must be registered.
+		 * @return An empty string on success, otherwise an error message.
+		 * @throws std::logic_error when called during update().
+		 */
+		std::string saveSnapshot(std::ostream& stream, const ComponentRegistry& registry) const;
+
+		/**
+		 * Replace all entities with the ones stored in a snapshot written by saveSnapshot().
+		 * The entities keep their ids. Memory for the entities and components is reserved up front, the components
+		 * are constructed without componentAdded signals and the entities are added using addEntities().
+		 * The current entities are only removed once the whole snapshot has been read successfully.
+		 *
+		 * @param data The snapshot data
+		 * @param size The size of @a data in bytes
+		 * @param registry The component types to restore. All types in the snapshot must be registered.
+		 * @return An empty string on success, otherwise an error message. On errors, the Engine is left unchanged.
+		 * @throws std::logic_error when called during update().
+		 */
+		std::string loadSnapshot(const char* data, size_t size, const ComponentRegistry& registry);
+
+		/**
+		 * @copybrief loadSnapshot(const char*, size_t, const ComponentRegistry&)
+		 *
+		 * @param stream The stream to read the snapshot from
+		 * @param registry The component types to restore. All types in the snapshot must be registered.
+		 * @return An empty string on success, otherwise an error message. On errors, the Engine is left unchanged.
+		 * @throws std::logic_error when called during update().
+		 */
+		std::string loadSnapshot(std::istream& stream, const ComponentRegistry& registry);
+
+		/**
+		 * Adds a list of entities to this Engine. Family membership is only evaluated once per distinct set of
+		 * components and the family lists grow in one go. The signals are emitted after all entities have been added.
+		 * During update() this falls back to addEntity() for each Entity.
+		 *
+		 * @param newEntities The entities to add. Each Entity must only be contained once.
+		 * @throws std::invalid_argument if one of the entities has already been added to an engine.
+		 */
+		void addEntities(const std::vector<Entity*>& newEntities);
+
+		/**
+		 * Removes a list of entities from this Engine. The entity and family lists are compacted in one pass each.
+		 * The signals are emitted after all entities have been removed, then the entities get destroyed.
+		 * During update() this falls back to removeEntity() for each Entity.
+		 *
+		 * @param oldEntities The entities to remove
+		 * @throws std::invalid_argument if one of the entities does not belong to this engine.
+		 */
+		void removeEntities(const std::vector<Entity*>& oldEntities);
+
 		/**
 		 * @param id The id of an Entity
 		 * @return The entity associated with the specified id or @a nullptr if no such entity exists.
@@ -258,6 +447,60 @@ namespace ecstasy {
 		 */
 		EntitySignal& getEntityRemovedSignal(const Family& family);
 
+		/**
+		 * The change tick is increased after each system update. Components remember the tick when they were last
+		 * added or modified, which allows systems to detect changes since they last ran.
+		 *
+		 * @return The current change tick
+		 */
+		uint32_t getChangeTick() const {
+			return changeTick;
+		}
+
+		/**
+		 * Set the time an update may take. When the budget is exhausted, systems with PriorityClass::Deferrable
+		 * will be skipped until the next update. Systems supporting it may also stop processing early (see
+		 * EntitySystemBase::isOverBudget()).
+		 *
+		 * @param seconds The frame budget in seconds. 0 means unlimited.
+		 */
+		void setFrameBudget(float seconds) {
+			frameBudget = seconds;
+		}
+
+		/// @return The frame budget in seconds. 0 means unlimited.
+		float getFrameBudget() const {
+			return frameBudget;
+		}
+
+		/**
+		 * Per-system statistics of the recent updates. Only recorded if ECSTASY_PROFILING is defined.
+		 *
+		 * @return The statistics
+		 */
+		EngineStats& getStats() {
+			return stats;
+		}
+
+		/// @copydoc getStats()
+		const EngineStats& getStats() const {
+			return stats;
+		}
+
+		/**
+		 * Record system updates, delayed operations, family registrations and reduceMemory() calls.
+		 *
+		 * @param recorder The TraceRecorder to use or nullptr to stop recording.
+		 */
+		void setTraceRecorder(std::shared_ptr<TraceRecorder> recorder) {
+			traceRecorder = recorder;
+		}
+
+		/// @return The TraceRecorder set using setTraceRecorder() or nullptr.
+		const std::shared_ptr<TraceRecorder>& getTraceRecorder() const {
+			return traceRecorder;
+		}
+
 		/**
 		 * Updates all the systems in this Engine.
 		 *
@@ -267,6 +510,14 @@ namespace ecstasy {
 
 	private:
 		void onComponentChange(Entity* entity, ComponentBase* component);
+		void addEntitiesInternal(const std::vector<Entity*>& newEntities);
+		void discardEntities(const std::vector<Entity*>& newEntities);
+
+		void countSignal() {
+#ifdef ECSTASY_PROFILING
+			signalEmissions++;
+#endif
+		}
 
 		uint64_t obtainEntityId() {
 			return nextEntityId++;
@@ -287,5 +538,6 @@ namespace ecstasy {
 }
 
 #ifdef USING_ECSTASY
+	using ecstasy::ComponentMemoryStats;
 	using ecstasy::Engine;
 #endif
@@ -0,0 +1,169 @@
+#pragma once
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include <ecstasy/core/Types.hpp>
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+namespace ecstasy {
+	/**
+	 * Keeps the most recent samples of a value and calculates statistics over them.
+	 */
+	class RollingStats {
+	private:
+		std::vector<float> samples;
+		size_t capacity;
+		size_t next = 0;
+
+	public:
+		/// @param capacity The maximum number of samples to keep
+		explicit RollingStats(size_t capacity = 128) : capacity(capacity) {}
+
+		/// @param value The sample to add. Replaces the oldest sample if the capacity is reached.
+		void add(float value);
+
+		/// Remove all samples
+		void clear();
+
+		/// @return The number of samples currently stored
+		size_t getSampleCount() const {
+			return samples.size();
+		}
+
+		/// @return The most recent sample or 0 if there are no samples.
+		float getLast() const;
+
+		/// @return The smallest sample or 0 if there are no samples.
+		float getMin() const;
+
+		/// @return The largest sample or 0 if there are no samples.
+		float getMax() const;
+
+		/// @return The average of all samples or 0 if there are no samples.
+		float getAvg() const;
+
+		/**
+		 * @param percentile The percentile in the range [0, 100]
+		 * @return The sample at the specified percentile or 0 if there are no samples.
+		 */
+		float getPercentile(float percentile) const;
+
+		/// @return The 99th percentile
+		float getP99() const {
+			return getPercentile(99);
+		}
+	};
+
+	/**
+	 * Statistics of one EntitySystem. One sample is added for each update of the system.
+	 */
+	struct SystemStats {
+		/// The time spent in EntitySystemBase::update() in seconds
+		RollingStats time;
+		/// The number of entities processed by the system
+		RollingStats entities;
+		/// The number of delayed entity and component operations executed after the update
+		RollingStats operations;
+		/// The number of engine signals emitted during the update and the delayed operations
+		RollingStats signals;
+
+		/// @param capacity The maximum number of samples to keep
+		explicit SystemStats(size_t capacity) : time(capacity), entities(capacity), operations(capacity), signals(capacity) {}
+	};
+
+	/**
+	 * Per-system statistics gathered by Engine::update().
+	 * Statistics are only recorded if ecstasy has been compiled with ECSTASY_PROFILING defined.
+	 * Otherwise no samples will be added.
+	 */
+	class EngineStats {
+	private:
+		size_t capacity;
+		RollingStats frameTime;
+		RollingStats frameAllocations;
+		RollingStats frameFrees;
+		std::vector<std::unique_ptr<SystemStats>> systemsByType;
+
+	public:
+		/// @param capacity The maximum number of samples to keep per value
+		explicit EngineStats(size_t capacity = 128) : capacity(capacity), frameTime(capacity), frameAllocations(capacity),
+			frameFrees(capacity) {}
+		EngineStats(const EngineStats&) = delete;
+
+		/// @return @a true if ecstasy has been compiled with profiling support.
+		static bool isEnabled() {
+#ifdef ECSTASY_PROFILING
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		/// @return The time spent in Engine::update() in seconds.
+		const RollingStats& getFrameTime() const {
+			return frameTime;
+		}
+
+		/// @return The number of allocations made by the MemoryManager during Engine::update().
+		const RollingStats& getFrameAllocations() const {
+			return frameAllocations;
+		}
+
+		/// @return The number of frees made by the MemoryManager during Engine::update().
+		const RollingStats& getFrameFrees() const {
+			return frameFrees;
+		}
+
+		/**
+		 * @param type The type of the EntitySystem
+		 * @return The statistics for the specified system type or @a nullptr if none have been recorded.
+		 */
+		const SystemStats* getSystemStats(SystemType type) const {
+			if (type >= systemsByType.size())
+				return nullptr;
+			return systemsByType[type].get();
+		}
+
+		/**
+		 * @tparam T The EntitySystem class
+		 * @return The statistics for the specified system class or @a nullptr if none have been recorded.
+		 */
+		template<typename T>
+		const SystemStats* getSystemStats() const {
+			return getSystemStats(getSystemType<T>());
+		}
+
+		/// Remove all recorded samples
+		void clear();
+
+		/**
+		 * @param time The time spent in Engine::update()
+		 * @param allocations The number of allocations made during Engine::update()
+		 * @param frees The number of frees made during Engine::update()
+		 */
+		void addFrame(float time, uint32_t allocations = 0, uint32_t frees = 0);
+
+		/**
+		 * @param type The type of the EntitySystem
+		 * @param time The time spent in EntitySystemBase::update()
+		 * @param entities The number of entities processed
+		 * @param operations The number of delayed operations executed
+		 * @param signals The number of signals emitted
+		 */
+		void addSystem(SystemType type, float time, uint32_t entities, uint32_t operations, uint32_t signals);
+	};
+}
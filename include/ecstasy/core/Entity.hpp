@@ -18,6 +18,7 @@
 #include <stdint.h>
 #include <vector>
 #include <ecstasy/core/EntityOperations.hpp>
+#include <ecstasy/core/Component.hpp>
 #include <ecstasy/utils/MemoryManager.hpp>
 #include <ecstasy/utils/alignof.hpp>
 
@@ -30,6 +31,7 @@ namespace ecstasy {
 		friend class Family;
 		friend class ComponentOperationHandler;
 		friend class Engine;
+		friend class DeltaRecorder;
 	public:
 		/// A flag that can be used to bit mask this entity. Up to the user to manage.
 		uint32_t flags = 0;
@@ -45,6 +47,7 @@ namespace ecstasy {
 		Bits familyBits;
 		Engine* engine = nullptr;
 		MemoryManager *memoryManager = nullptr;
+		const uint32_t* changeTick = nullptr;
 
 		Entity() {}
 
@@ -137,6 +140,42 @@ namespace ecstasy {
 			return static_cast<T*>(getComponent(getComponentType<T>()));
 		}
 
+		/**
+		 * Retrieve a Component from this Entity by class with the intention to modify it.
+		 * The Component will be marked as changed, see Family::changed().
+		 *
+		 * @tparam T The Component class
+		 * @return The instance of the specified Component attached to this Entity, or @a nullptr if no such Component exists.
+		 */
+		template<typename T>
+		T* getMut() {
+			auto component = getComponent(getComponentType<T>());
+			if (component)
+				component->changeTick = *changeTick;
+			return static_cast<T*>(component);
+		}
+
+		/**
+		 * Mark a Component as changed, see Family::changed().
+		 *
+		 * @tparam T The Component class
+		 */
+		template<typename T>
+		void markChanged() {
+			getMut<T>();
+		}
+
+		/**
+		 * @param type The component type
+		 * @param tick A change tick of the Engine
+		 * @return @a true if the Component of the specified type exists and has been changed after the specified tick.
+		 */
+		bool hasChangedSince(ComponentType type, uint32_t tick) const {
+			auto component = getComponent(type);
+			// Compare the difference to support wrapping ticks
+			return component && static_cast<int32_t>(component->changeTick - tick) > 0;
+		}
+
 		/**
 		 * @tparam T The Component class
 		 * @return Whether or not the Entity has a Component for the specified class.
@@ -156,6 +195,11 @@ namespace ecstasy {
 		void addInternal (ComponentBase* component);
 		ComponentBase* removeInternal(ComponentType type);
 		void removeAllInternal();
+		uint32_t relocateComponents();
+		bool cloneComponents(const Entity& prototype);
+		void attachInternal(ComponentBase* component);
+		void markChangedInternal(ComponentBase* component);
+		void destroyComponentsInternal();
 
 	public:
 		/// @return This Entity's Component bits, describing all the {@link Component}s it contains.
@@ -68,8 +68,12 @@ namespace ecstasy {
 		}
 
 		virtual bool isActive() = 0;
-		void process() {
+
+		/// @return The number of operations processed
+		uint32_t process() {
+			uint32_t count = 0;
 			while(nextOperation) {
+				count++;
 				auto operation = nextOperation;
 				switch(operation->type) {
 				case OperationType::Add: onAdd(operation); break;
@@ -85,6 +89,7 @@ namespace ecstasy {
 			}
 			nextOperation = nullptr;
 			lastOperation = nullptr;
+			return count;
 		}
 
 	protected:
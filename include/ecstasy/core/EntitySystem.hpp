@@ -15,10 +15,23 @@
  * limitations under the License.
  ******************************************************************************/
 #include <ecstasy/core/Types.hpp>
+#include <chrono>
 
 namespace ecstasy {
 	class Engine;
 
+	/// Describes how an EntitySystem is treated when the frame budget of the Engine is exhausted.
+	enum class PriorityClass {
+		/// The system is always updated.
+		Critical,
+		/**
+		 * The system is skipped when the frame budget is exhausted. The skipped time is added to its next update, no
+		 * matter how many frames have been skipped. So if the budget is exhausted every frame, the system will not run
+		 * and the time passed to it will keep growing.
+		 */
+		Deferrable
+	};
+
 	/**
 	 * Non-Template base-class for EntitySystem. Extend EntitySystem instead.
 	 */
@@ -28,6 +41,13 @@ namespace ecstasy {
 		bool processing = true;
 		Engine* engine = nullptr;
 		int priority;
+		PriorityClass priorityClass = PriorityClass::Critical;
+		float timeBudget = 0;
+		float deferredTime = 0;
+		float lastUpdateTime = 0;
+		uint32_t processedEntities = 0;
+		bool hasDeadline = false;
+		std::chrono::steady_clock::time_point deadline;
 
 	public:
 		/// The unique identifier of this EntitySystem's class
@@ -77,7 +97,63 @@ namespace ecstasy {
 		/// @return The engine
 		Engine* getEngine() { return engine; }
 
+		/**
+		 * Set the time this system may spend per update. Systems supporting it (like IteratingSystem with
+		 * setResumable()) will stop processing when the budget has been used up and resume in the next frame.
+		 *
+		 * @param seconds The time budget in seconds. 0 means unlimited.
+		 */
+		void setTimeBudget(float seconds) {
+			timeBudget = seconds;
+		}
+
+		/// @return The time budget in seconds. 0 means unlimited.
+		float getTimeBudget() const {
+			return timeBudget;
+		}
+
+		/**
+		 * @param priorityClass Whether this system may be deferred when the frame budget of the Engine is exhausted.
+		 */
+		void setPriorityClass(PriorityClass priorityClass) {
+			this->priorityClass = priorityClass;
+		}
+
+		/// @return The PriorityClass of this system
+		PriorityClass getPriorityClass() const {
+			return priorityClass;
+		}
+
+		/**
+		 * The update time is only measured if this system or the Engine has a time budget, or if ECSTASY_PROFILING is
+		 * defined. Otherwise the clock is not read at all.
+		 *
+		 * @return The time in seconds the last measured update took.
+		 */
+		float getLastUpdateTime() const {
+			return lastUpdateTime;
+		}
+
+		/**
+		 * Check if this system has used up its time budget or the frame budget of the engine during the current update.
+		 *
+		 * @return @a true if processing should be stopped.
+		 */
+		bool isOverBudget() const {
+			return hasDeadline && std::chrono::steady_clock::now() >= deadline;
+		}
+
 	protected:
+		/**
+		 * Report processed entities to Engine::getStats(). Does nothing unless ECSTASY_PROFILING is defined.
+		 *
+		 * @param count The number of entities processed
+		 */
+		void countProcessedEntities(uint32_t count) {
+#ifdef ECSTASY_PROFILING
+			processedEntities += count;
+#endif
+		}
 
 		/**
 		 * Called when this EntitySystem is added to an Engine.
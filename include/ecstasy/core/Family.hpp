@@ -17,6 +17,7 @@
 
 #include <ecstasy/core/Types.hpp>
 #include <ecstasy/utils/Bits.hpp>
+#include <vector>
 
 namespace ecstasy {
 	class Entity;
@@ -47,7 +48,7 @@ namespace ecstasy {
 
 	/**
 	 * A builder pattern to create Family objects.
-	 * Use Family::all(), Family::one() or Family::exclude() to start
+	 * Use Family::all(), Family::one(), Family::exclude() or Family::changed() to start
 	 */
 	class FamilyBuilder {
 		friend class Family;
@@ -55,6 +56,7 @@ namespace ecstasy {
 		Bits* m_all = new Bits();
 		Bits* m_one = new Bits();
 		Bits* m_exclude = new Bits();
+		Bits* m_changed = new Bits();
 
 		FamilyBuilder() {}
 
@@ -99,6 +101,24 @@ namespace ecstasy {
 			return *this;
 		}
 
+		/**
+		 * Entities will have to contain all of the specified components (like all()). Additionally, the iterating
+		 * systems (IteratingSystem, IteratingSystemFor, SortedIteratingSystem, RadixSortedIteratingSystem and
+		 * IntervalIteratingSystem) will only process entities, in which at least one of the specified components has
+		 * been added or modified (see Entity::getMut()) since the system last ran.
+		 * Modifications made by a system while it runs are marked with its own change tick, so the system will not see
+		 * its own changes on its next run. Other systems will.
+		 *
+		 * @tparam Args The components to watch for changes.
+		 * @return *this for chaining
+		 */
+		template<typename... Args>
+		FamilyBuilder& changed() {
+			getComponentTypeBits<Args...>(*m_all);
+			getComponentTypeBits<Args...>(*m_changed);
+			return *this;
+		}
+
 		/// @return A Family for the configured component types
 		const Family& get ();
 	};
@@ -107,7 +127,7 @@ namespace ecstasy {
 	 * Represents a group of {@link Component}s. It is used to describe what Entity objects an EntitySystem should
 	 * process. Families can't be instantiated directly but must be accessed via a builder.
 	 * This is to avoid duplicate families that describe the same components
-	 * Start with Family::all(), Family::one() or Family::exclude().
+	 * Start with Family::all(), Family::one(), Family::exclude() or Family::changed().
 	 */
 	class Family {
 	private:
@@ -116,6 +136,8 @@ namespace ecstasy {
 		Bits* m_all;
 		Bits* m_one;
 		Bits* m_exclude;
+		Bits* m_changed;
+		std::vector<ComponentType> changedTypes;
 
 	public:
 		/// The unique identifier of this Family
@@ -124,7 +146,7 @@ namespace ecstasy {
 	private:
 		friend class FamilyBuilder;
 		// Private constructor
-		Family(Bits* all, Bits* one, Bits* exclude) : m_all(all), m_one(one), m_exclude(exclude), index(getUniqueTypeId<FamilyType>()) {}
+		Family(Bits* all, Bits* one, Bits* exclude, Bits* changed);
 
 	public:
 		Family(const Family&) = delete;
@@ -136,6 +158,19 @@ namespace ecstasy {
 		 */
 		bool matches (Entity* entity) const;
 
+		/// @return @a true if this family has been created with component types to watch for changes.
+		bool hasChangeFilter() const {
+			return !changedTypes.empty();
+		}
+
+		/**
+		 * @param entity An entity
+		 * @param tick A change tick of the Engine
+		 * @return Whether one of the watched components of the entity has been changed after the specified tick.
+		 *         Always @a true if this family has no change filter.
+		 */
+		bool changedSince(Entity* entity, uint32_t tick) const;
+
 		/// @return A builder singleton instance to get a Family
 		static FamilyBuilder& all() {
 			return builder.reset();
@@ -168,6 +203,16 @@ namespace ecstasy {
 			return builder.reset().exclude<Args...>();
 		}
 
+		/**
+		 * @tparam Args Entities will have to contain all of the specified components and at least one of them must
+		 *         have changed since the system last ran. See FamilyBuilder::changed().
+		 * @return A builder singleton instance to get a Family
+		 */
+		template<typename... Args>
+		static FamilyBuilder& changed() {
+			return builder.reset().changed<Args...>();
+		}
+
 		/// @return @a true if the families are equal
 		bool operator == (const Family& other) const {
 			return this == &other;
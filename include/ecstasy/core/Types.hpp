@@ -60,6 +60,9 @@ namespace ecstasy {
 		return type;
 	}
 
+	/// Identifies a blueprint compiled by EntityFactory::compile().
+	typedef uint32_t BlueprintId;
+
 	/// Uniquely identifies an EntitySystem sub-class.
 	ECS_UUID_TYPE(SystemType)
 
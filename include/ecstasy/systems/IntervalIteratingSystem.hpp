@@ -16,39 +16,137 @@
 ******************************************************************************/
 #include <ecstasy/systems/IntervalSystem.hpp>
 #include <ecstasy/core/Engine.hpp>
+#include <cmath>
 
 namespace ecstasy {
 	class Entity;
 
 	/**
-	 * A simple EntitySystem that processes a Family of entities not once per frame, but after a given interval.
-	 * Entity processing logic should be placed in processEntity().
+	 * Common implementation of IntervalIteratingSystem and StaticIntervalIteratingSystem.
+	 * Extend one of those instead.
+	 *
+	 * By default all entities are processed at once every interval. In staggered mode (see setStaggered()), every
+	 * frame processes a slice of the entities proportional to the time passed, so each entity is still processed
+	 * once per interval, but the cost is spread evenly across frames.
+	 * If the Family has been created using Family::changed(), only entities with changes since the last interval will
+	 * be processed. In staggered mode, changes are checked against the start of the previous cycle, so nothing is
+	 * missed, but the system may see changes it made itself during that cycle.
 	 *
 	 * @tparam T: The EntitySystem class used to create the type.
+	 * @tparam D: The class implementing processEntity(Entity*).
 	 */
-	template<typename T>
-	class IntervalIteratingSystem: public IntervalSystem<T> {
+	template<typename T, typename D>
+	class BasicIntervalIteratingSystem: public IntervalSystem<T> {
 	private:
 		const Family& family;
 		const std::vector<Entity*>* entities;
+		bool staggered = false;
+		float sliceAccumulator = 0;
+		size_t sliceIndex = 0;
+		bool cycleStarted = false;
+		uint32_t lastChangeTick = 0;
+		uint32_t cycleChangeTick = 0;
 
 	public:
 		/**
 		 * @param family Represents the collection of family the system should process
 		 * @copydetails IntervalSystem::IntervalSystem()
 		 */
-		IntervalIteratingSystem(const Family& family, float interval, int priority = 0)
+		BasicIntervalIteratingSystem(const Family& family, float interval, int priority = 0)
 			: IntervalSystem<T>(interval, priority), family(family) {}
 
+		void update(float deltaTime) override {
+			if (!staggered) {
+				IntervalSystem<T>::update(deltaTime);
+				return;
+			}
+
+			sliceAccumulator += deltaTime;
+			auto interval = this->getInterval();
+			auto self = static_cast<D*>(this);
+			bool filter = family.hasChangeFilter();
+			for (;;) {
+				if (!cycleStarted) {
+					// Entities are checked against the start of the previous cycle, so no change is missed
+					cycleChangeTick = lastChangeTick;
+					lastChangeTick = this->getEngine()->getChangeTick();
+					cycleStarted = true;
+				}
+				auto count = entities->size();
+				if (sliceIndex > count)
+					sliceIndex = count;
+				float progress = sliceAccumulator >= interval ? 1.0f : (sliceAccumulator / interval);
+				auto target = static_cast<size_t>(std::ceil(progress * count));
+				if (target > count)
+					target = count;
+
+				while (sliceIndex < target) {
+					auto entity = (*entities)[sliceIndex++];
+					if (!filter || family.changedSince(entity, cycleChangeTick)) {
+						self->processEntity(entity);
+						this->countProcessedEntities(1);
+					}
+					if (this->isOverBudget())
+						return;
+				}
+
+				if (sliceAccumulator < interval)
+					return;
+				// The current cycle is complete, start the next one
+				sliceAccumulator -= interval;
+				sliceIndex = 0;
+				cycleStarted = false;
+				if (sliceAccumulator <= 0 || count == 0)
+					return;
+			}
+		}
+
+		/**
+		 * Enable or disable staggered processing. In staggered mode, entities are processed in slices every frame
+		 * instead of all at once every interval. updateInterval() is not called in staggered mode.
+		 * When the system is over budget (see EntitySystemBase::isOverBudget()), the remaining entities of the slice
+		 * are processed in the following frames. At least one entity is processed per frame.
+		 * Slices are taken by position in the family, so if entities are added or removed during a cycle, some
+		 * entities might be skipped or processed twice in that cycle.
+		 *
+		 * @param staggered @a true to enable staggered processing
+		 */
+		void setStaggered(bool staggered) {
+			this->staggered = staggered;
+			sliceAccumulator = 0;
+			sliceIndex = 0;
+			cycleStarted = false;
+		}
+
+		/// @return @a true if staggered processing is enabled
+		bool isStaggered() const {
+			return staggered;
+		}
+
 	protected:
 		void addedToEngine(Engine* engine) override {
 			entities = engine->getEntitiesFor(family);
 		}
 
 		void updateInterval() override {
+			auto self = static_cast<D*>(this);
+			if (family.hasChangeFilter()) {
+				auto since = lastChangeTick;
+				lastChangeTick = this->getEngine()->getChangeTick();
+				uint32_t count = 0;
+				for (auto entity: *entities) {
+					if (family.changedSince(entity, since)) {
+						self->processEntity(entity);
+						count++;
+					}
+				}
+				this->countProcessedEntities(count);
+				return;
+			}
 			for (auto entity: *entities) {
-				processEntity(entity);
+				self->processEntity(entity);
 			}
+			this->countProcessedEntities(static_cast<uint32_t>(entities->size()));
 		}
 
 	public:
@@ -61,6 +159,24 @@ namespace ecstasy {
 		const Family& getFamily() const {
 			return family;
 		}
+	};
+
+	/**
+	 * A simple EntitySystem that processes a Family of entities not once per frame, but after a given interval.
+	 * Entity processing logic should be placed in processEntity().
+	 *
+	 * @tparam T: The EntitySystem class used to create the type.
+	 */
+	template<typename T>
+	class IntervalIteratingSystem: public BasicIntervalIteratingSystem<T, IntervalIteratingSystem<T>> {
+		friend class BasicIntervalIteratingSystem<T, IntervalIteratingSystem<T>>;
+	public:
+		/**
+		 * @param family Represents the collection of family the system should process
+		 * @copydetails IntervalSystem::IntervalSystem()
+		 */
+		IntervalIteratingSystem(const Family& family, float interval, int priority = 0)
+			: BasicIntervalIteratingSystem<T, IntervalIteratingSystem<T>>(family, interval, priority) {}
 
 	protected:
 		/**
@@ -70,8 +186,31 @@ namespace ecstasy {
 		 */
 		virtual void processEntity(Entity* entity) = 0;
 	};
+
+	/**
+	 * Like IntervalIteratingSystem, but processEntity() is not virtual. Instead it is called directly on the system
+	 * class (CRTP), so the compiler is able to inline it into the iteration loop.
+	 *
+	 * The system class must provide a method accessible to this class (i.e. public) with this signature:
+	 * @code
+	 * void processEntity(Entity* entity);
+	 * @endcode
+	 *
+	 * @tparam T: The EntitySystem class used to create the type. Must implement processEntity().
+	 */
+	template<typename T>
+	class StaticIntervalIteratingSystem: public BasicIntervalIteratingSystem<T, T> {
+	public:
+		/**
+		 * @param family Represents the collection of family the system should process
+		 * @copydetails IntervalSystem::IntervalSystem()
+		 */
+		StaticIntervalIteratingSystem(const Family& family, float interval, int priority = 0)
+			: BasicIntervalIteratingSystem<T, T>(family, interval, priority) {}
+	};
 }
 
 #ifdef USING_ECSTASY
 	using ecstasy::IntervalIteratingSystem;
+	using ecstasy::StaticIntervalIteratingSystem;
 #endif
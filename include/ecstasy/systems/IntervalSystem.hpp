@@ -15,6 +15,7 @@
 * limitations under the License.
 ******************************************************************************/
 #include <ecstasy/core/EntitySystem.hpp>
+#include <cmath>
 
 namespace ecstasy {
 	class Entity;
@@ -23,6 +24,10 @@ namespace ecstasy {
 	 * A simple EntitySystem that does not run its update logic every call to update(float), but after a
 	 * given interval. The actual logic should be placed in updateInterval().
 	 *
+	 * This can be used as a fixed timestep: Limit the number of steps per frame using setMaxStepsPerFrame() to avoid
+	 * a spiral of death after a hitch, override updateIntervals() to process all pending steps in one call and use
+	 * getAlpha() to interpolate between the last two steps when rendering.
+	 *
 	 * @tparam T: The EntitySystem class used to create the type.
 	 */
 	template<typename T>
@@ -30,6 +35,7 @@ namespace ecstasy {
 	private:
 		float interval;
 		float accumulator = 0;
+		uint32_t maxStepsPerFrame = 0;
 
 	public:
 		/**
@@ -38,13 +44,49 @@ namespace ecstasy {
 		 */
 		explicit IntervalSystem(float interval, int priority = 0) : EntitySystem<T>(priority), interval(interval) {}
 
+		/// @return The time in seconds between calls to updateInterval().
+		float getInterval() const {
+			return interval;
+		}
+
+		/**
+		 * Limit the number of intervals processed in one frame. Time exceeding this limit will be dropped.
+		 *
+		 * @param maxSteps The maximum number of steps per frame. 0 means unlimited.
+		 */
+		void setMaxStepsPerFrame(uint32_t maxSteps) {
+			maxStepsPerFrame = maxSteps;
+		}
+
+		/// @return The maximum number of steps per frame. 0 means unlimited.
+		uint32_t getMaxStepsPerFrame() const {
+			return maxStepsPerFrame;
+		}
+
+		/**
+		 * The progress towards the next interval. Use this to interpolate between the previous and the current state.
+		 *
+		 * @return A value between 0 and 1.
+		 */
+		float getAlpha() const {
+			return accumulator / interval;
+		}
+
 		void update(float deltaTime) override {
 			accumulator += deltaTime;
 
+			uint32_t steps = 0;
 			while (accumulator >= interval) {
+				if (maxStepsPerFrame && steps == maxStepsPerFrame) {
+					accumulator = std::fmod(accumulator, interval);
+					break;
+				}
 				accumulator -= interval;
-				updateInterval();
+				steps++;
 			}
+
+			if (steps)
+				updateIntervals(steps);
 		}
 
 	protected:
@@ -52,6 +94,17 @@ namespace ecstasy {
 		 * The processing logic of the system should be placed here.
 		 */
 		virtual void updateInterval() = 0;
+
+		/**
+		 * Called once per frame with the number of pending intervals. By default, this calls updateInterval() for
+		 * each step. Override this to process multiple steps at once.
+		 *
+		 * @param steps The number of intervals to process (at least 1).
+		 */
+		virtual void updateIntervals(uint32_t steps) {
+			for (uint32_t i = 0; i < steps; i++)
+				updateInterval();
+		}
 	};
 }
 
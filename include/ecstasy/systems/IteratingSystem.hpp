@@ -21,16 +21,21 @@ namespace ecstasy {
 	class Entity;
 
 	/**
-	 * A simple EntitySystem that iterates over each entity and calls processEntity() for each entity every time the
-	 * EntitySystem is updated. This is really just a convenience class as most systems iterate over a list of entities.
+	 * Common implementation of IteratingSystem and StaticIteratingSystem.
+	 * Extend one of those instead.
 	 *
 	 * @tparam T The EntitySystem class used to create the type.
+	 * @tparam D The class implementing processEntity(Entity*, float).
 	 */
-	template<typename T>
-	class IteratingSystem : public EntitySystem<T> {
+	template<typename T, typename D>
+	class BasicIteratingSystem : public EntitySystem<T> {
 	private:
 		const Family& family;
 		const std::vector<Entity*>* entities;
+		uint32_t lastChangeTick = 0;
+		uint32_t passChangeTick = 0;
+		bool resumable = false;
+		size_t resumeIndex = 0;
 
 	public:
 		/**
@@ -39,11 +44,74 @@ namespace ecstasy {
 		 * @param family The family of entities iterated over in this System
 		 * @copydetails EntitySystem::EntitySystem()
 		 */
-		IteratingSystem(const Family& family, int priority = 0) : EntitySystem<T>(priority), family(family) {}
+		BasicIteratingSystem(const Family& family, int priority = 0) : EntitySystem<T>(priority), family(family) {}
 
 		void update(float deltaTime) override {
-			for (auto entity : *entities)
-				processEntity(entity, deltaTime);
+			if (resumable) {
+				updateResumable(deltaTime);
+				return;
+			}
+
+			auto self = static_cast<D*>(this);
+			if (family.hasChangeFilter()) {
+				auto since = lastChangeTick;
+				lastChangeTick = this->getEngine()->getChangeTick();
+				uint32_t count = 0;
+				for (auto entity : *entities) {
+					if (family.changedSince(entity, since)) {
+						self->processEntity(entity, deltaTime);
+						count++;
+					}
+				}
+				this->countProcessedEntities(count);
+			} else {
+				for (auto entity : *entities)
+					self->processEntity(entity, deltaTime);
+				this->countProcessedEntities(static_cast<uint32_t>(entities->size()));
+			}
+		}
+
+		/**
+		 * In resumable mode, the system stops processing when it is over budget (see EntitySystemBase::isOverBudget())
+		 * and resumes with the next entity in the following update. The budget is checked after every 16 entities.
+		 * If entities are added or removed in between, some entities might be skipped or processed twice in a pass.
+		 *
+		 * @param resumable @a true to enable resumable mode
+		 */
+		void setResumable(bool resumable) {
+			this->resumable = resumable;
+			resumeIndex = 0;
+		}
+
+		/// @return @a true if resumable mode is enabled
+		bool isResumable() const {
+			return resumable;
+		}
+
+	private:
+		void updateResumable(float deltaTime) {
+			auto self = static_cast<D*>(this);
+			bool filter = family.hasChangeFilter();
+			if (resumeIndex == 0) {
+				passChangeTick = lastChangeTick;
+				lastChangeTick = this->getEngine()->getChangeTick();
+			}
+			auto& list = *entities;
+			uint32_t count = 0;
+			for (size_t i = resumeIndex; i < list.size(); i++) {
+				auto entity = list[i];
+				if (!filter || family.changedSince(entity, passChangeTick)) {
+					self->processEntity(entity, deltaTime);
+					count++;
+				}
+				if ((i & 15) == 15 && i + 1 < list.size() && this->isOverBudget()) {
+					this->countProcessedEntities(count);
+					resumeIndex = i + 1;
+					return;
+				}
+			}
+			this->countProcessedEntities(count);
+			resumeIndex = 0;
 		}
 
 	protected:
@@ -61,6 +129,28 @@ namespace ecstasy {
 		const Family& getFamily() const {
 			return family;
 		}
+	};
+
+	/**
+	 * A simple EntitySystem that iterates over each entity and calls processEntity() for each entity every time the
+	 * EntitySystem is updated. This is really just a convenience class as most systems iterate over a list of entities.
+	 * If the Family has been created using Family::changed(), only entities with changes since the last update will be
+	 * processed.
+	 *
+	 * @tparam T The EntitySystem class used to create the type.
+	 */
+	template<typename T>
+	class IteratingSystem : public BasicIteratingSystem<T, IteratingSystem<T>> {
+		friend class BasicIteratingSystem<T, IteratingSystem<T>>;
+	public:
+		/**
+		 * Instantiates a system that will iterate over the entities described by the Family, with a specific priority.
+		 *
+		 * @param family The family of entities iterated over in this System
+		 * @copydetails EntitySystem::EntitySystem()
+		 */
+		IteratingSystem(const Family& family, int priority = 0)
+			: BasicIteratingSystem<T, IteratingSystem<T>>(family, priority) {}
 
 	protected:
 		/**
@@ -72,8 +162,33 @@ namespace ecstasy {
 		 */
 		virtual void processEntity(Entity* entity, float deltaTime) = 0;
 	};
+
+	/**
+	 * Like IteratingSystem, but processEntity() is not virtual. Instead it is called directly on the system class
+	 * (CRTP), so the compiler is able to inline it into the iteration loop.
+	 *
+	 * The system class must provide a method accessible to this class (i.e. public) with this signature:
+	 * @code
+	 * void processEntity(Entity* entity, float deltaTime);
+	 * @endcode
+	 *
+	 * @tparam T The EntitySystem class used to create the type. Must implement processEntity().
+	 */
+	template<typename T>
+	class StaticIteratingSystem : public BasicIteratingSystem<T, T> {
+	public:
+		/**
+		 * Instantiates a system that will iterate over the entities described by the Family, with a specific priority.
+		 *
+		 * @param family The family of entities iterated over in this System
+		 * @copydetails EntitySystem::EntitySystem()
+		 */
+		StaticIteratingSystem(const Family& family, int priority = 0)
+			: BasicIteratingSystem<T, T>(family, priority) {}
+	};
 }
 
 #ifdef USING_ECSTASY
 	using ecstasy::IteratingSystem;
+	using ecstasy::StaticIteratingSystem;
 #endif
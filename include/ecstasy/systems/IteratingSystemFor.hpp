@@ -0,0 +1,154 @@
+#pragma once
+/*******************************************************************************
+* Copyright 2015 See AUTHORS file.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*   http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+******************************************************************************/
+#include <ecstasy/core/EntitySystem.hpp>
+#include <ecstasy/core/Engine.hpp>
+#include <ecstasy/core/Family.hpp>
+#include <tuple>
+#include <utility>
+#include <unordered_map>
+
+namespace ecstasy {
+	class Entity;
+
+	/**
+	 * Like IteratingSystem, but processEntity() receives typed references to the specified components.
+	 * The component pointers are resolved once when an Entity joins the Family and stored in a contiguous array,
+	 * so iterating does not need to look up components per Entity. processEntity() is called without virtual dispatch.
+	 *
+	 * The system class must provide a method accessible to this class (i.e. public) with this signature:
+	 * @code
+	 * void processEntity(Entity* entity, Components&... components, float deltaTime);
+	 * @endcode
+	 *
+	 * The order in which entities are processed is not specified.
+	 *
+	 * @tparam T The EntitySystem class used to create the type.
+	 * @tparam Components The Component classes to pass to processEntity()
+	 */
+	template<typename T, typename ... Components>
+	class IteratingSystemFor : public EntitySystem<T> {
+	private:
+		typedef std::tuple<Entity*, Components*...> Row;
+
+		const Family& family;
+		std::vector<Row> rows;
+		std::unordered_map<Entity*, size_t> rowIndices;
+		Signal11::ConnectionScope scope;
+		uint32_t lastChangeTick = 0;
+
+	public:
+		/**
+		 * Instantiates a system that will iterate over all entities containing the specified components.
+		 *
+		 * @copydetails EntitySystem::EntitySystem()
+		 */
+		explicit IteratingSystemFor(int priority = 0)
+			: EntitySystem<T>(priority), family(Family::all<Components...>().get()) {}
+
+		/**
+		 * Instantiates a system that will iterate over the entities described by the Family, with a specific priority.
+		 *
+		 * @param family The family of entities iterated over in this System. It must require all of the Components.
+		 * @copydetails EntitySystem::EntitySystem()
+		 */
+		IteratingSystemFor(const Family& family, int priority = 0)
+			: EntitySystem<T>(priority), family(family) {}
+
+		void update(float deltaTime) override {
+			auto self = static_cast<T*>(this);
+			if (family.hasChangeFilter()) {
+				auto since = lastChangeTick;
+				lastChangeTick = this->getEngine()->getChangeTick();
+				uint32_t count = 0;
+				for (auto& row : rows) {
+					if (family.changedSince(std::get<0>(row), since)) {
+						process(self, row, deltaTime, std::index_sequence_for<Components...>());
+						count++;
+					}
+				}
+				this->countProcessedEntities(count);
+			} else {
+				for (auto& row : rows)
+					process(self, row, deltaTime, std::index_sequence_for<Components...>());
+				this->countProcessedEntities(static_cast<uint32_t>(rows.size()));
+			}
+		}
+
+		/// @return The number of entities processed by the system
+		size_t getEntityCount() const {
+			return rows.size();
+		}
+
+		/// @return The Family used when the system was created
+		const Family& getFamily() const {
+			return family;
+		}
+
+	protected:
+		void addedToEngine(Engine* engine) override {
+			rows.clear();
+			rowIndices.clear();
+			auto entities = engine->getEntitiesFor(family);
+			rows.reserve(entities->size());
+			for (auto entity : *entities)
+				entityAdded(entity);
+			scope += engine->getEntityAddedSignal(family).connect(this, &IteratingSystemFor::entityAdded);
+			scope += engine->getEntityRemovedSignal(family).connect(this, &IteratingSystemFor::entityRemoved);
+			scope += engine->componentRelocated.connect(this, &IteratingSystemFor::componentRelocated);
+		}
+
+		void removedFromEngine(Engine* engine) override {
+			scope.removeAll();
+			rows.clear();
+			rowIndices.clear();
+		}
+
+	private:
+		template<size_t ... Indices>
+		static void process(T* self, Row& row, float deltaTime, std::index_sequence<Indices...>) {
+			self->processEntity(std::get<0>(row), *std::get<Indices + 1>(row)..., deltaTime);
+		}
+
+		void entityAdded(Entity* entity) {
+			rowIndices[entity] = rows.size();
+			rows.emplace_back(entity, entity->template get<Components>()...);
+		}
+
+		void componentRelocated(Entity* entity, ComponentBase* component) {
+			auto it = rowIndices.find(entity);
+			if (it != rowIndices.end())
+				rows[it->second] = Row(entity, entity->template get<Components>()...);
+		}
+
+		void entityRemoved(Entity* entity) {
+			auto it = rowIndices.find(entity);
+			if (it == rowIndices.end())
+				return;
+			size_t index = it->second;
+			rowIndices.erase(it);
+			if (index + 1 != rows.size()) {
+				rows[index] = rows.back();
+				rowIndices[std::get<0>(rows[index])] = index;
+			}
+			rows.pop_back();
+		}
+	};
+}
+
+#ifdef USING_ECSTASY
+	using ecstasy::IteratingSystemFor;
+#endif
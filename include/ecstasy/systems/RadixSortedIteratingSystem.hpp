@@ -0,0 +1,186 @@
+#pragma once
+/*******************************************************************************
+* Copyright 2015 See AUTHORS file.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*   http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+******************************************************************************/
+#include <ecstasy/core/EntitySystem.hpp>
+#include <ecstasy/core/Engine.hpp>
+#include <ecstasy/utils/RadixSort.hpp>
+#include <algorithm>
+#include <unordered_set>
+
+namespace ecstasy {
+	class Entity;
+
+	/**
+	 * Like SortedIteratingSystem, but instead of a comparator, it uses a key extractor, which returns an integral or
+	 * floating point sort key for an Entity. The keys are stored alongside the entities and sorted using a radix sort,
+	 * so sorting takes linear time and the key extractor is only called once per Entity and sort.
+	 * Adding entities will cause the entity list to be resorted, which extracts the keys of all entities again.
+	 * Call forceSort() if you changed your sorting criteria.
+	 * If the Family has been created using Family::changed(), only entities with changes since the last update will be
+	 * processed.
+	 *
+	 * @tparam T The EntitySystem class used to create the type.
+	 * @tparam K The key extractor type. Must be callable with an Entity* and return an arithmetic type.
+	 */
+	template<typename T, typename K>
+	class RadixSortedIteratingSystem : public EntitySystem<T> {
+	public:
+		/// The type returned by the key extractor
+		typedef typename std::decay<decltype(std::declval<K&>()(std::declval<Entity*>()))>::type KeyType;
+
+	private:
+		typedef typename RadixKey<KeyType>::type SortKey;
+		typedef std::pair<SortKey, Entity*> Item;
+
+		const Family& family;
+		mutable std::vector<Item> items;
+		mutable std::vector<Item> buffer;
+		mutable std::vector<Entity*> sortedEntities;
+		mutable std::unordered_set<Entity*> removedEntities;
+		mutable bool shouldSort = false;
+		mutable K keyExtractor;
+		uint32_t lastChangeTick = 0;
+		Signal11::ConnectionScope scope;
+
+	public:
+		/**
+		 * Instantiates a system that will iterate over the entities described by the Family, with a specific priority.
+		 *
+		 * @param family The family of entities iterated over in this System
+		 * @param keyExtractor The key extractor to get the sort key of an Entity
+		 * @copydetails EntitySystem::EntitySystem()
+		 */
+		RadixSortedIteratingSystem(const Family& family, K keyExtractor, int priority=0)
+			: EntitySystem<T>(priority), family(family), keyExtractor(keyExtractor) {}
+
+		/**
+		 * Call this if the sorting criteria have changed.
+		 * The keys will be extracted again and sorted when the entities are processed.
+		 */
+		void forceSort() {
+			shouldSort = true;
+		}
+
+	private:
+		void sort() const {
+			if (!removedEntities.empty()) {
+				items.erase(std::remove_if(items.begin(), items.end(), [this](const Item& item) {
+					return removedEntities.count(item.second) != 0;
+				}), items.end());
+				removedEntities.clear();
+				if (!shouldSort)
+					updateSortedEntities();
+			}
+
+			if (shouldSort) {
+				for (auto& item : items)
+					item.first = RadixKey<KeyType>::get(keyExtractor(item.second));
+				radixSort(items, buffer);
+				updateSortedEntities();
+				shouldSort = false;
+			}
+		}
+
+		void updateSortedEntities() const {
+			sortedEntities.resize(items.size());
+			for (size_t i = 0; i < items.size(); i++)
+				sortedEntities[i] = items[i].second;
+		}
+
+		void entityAdded(Entity* entity) {
+			// If it was re-added before the removal has been compacted, the old item is still present.
+			// The key is extracted when sorting.
+			if (!removedEntities.erase(entity))
+				items.emplace_back(SortKey(), entity);
+			shouldSort = true;
+		}
+
+		void entityRemoved(Entity* entity) {
+			removedEntities.insert(entity);
+		}
+
+	protected:
+		void addedToEngine(Engine* engine) override {
+			auto newEntities = engine->getEntitiesFor(family);
+			items.clear();
+			removedEntities.clear();
+			for (auto entity : *newEntities)
+				items.emplace_back(SortKey(), entity);
+			shouldSort = true;
+			sort();
+			scope += engine->getEntityAddedSignal(family).connect(this, &RadixSortedIteratingSystem::entityAdded);
+			scope += engine->getEntityRemovedSignal(family).connect(this, &RadixSortedIteratingSystem::entityRemoved);
+		}
+
+		void removedFromEngine(Engine* engine) override {
+			scope.removeAll();
+			items.clear();
+			buffer.clear();
+			sortedEntities.clear();
+			removedEntities.clear();
+			shouldSort = false;
+		}
+
+	public:
+		void update(float deltaTime) override {
+			sort();
+			if (family.hasChangeFilter()) {
+				auto since = lastChangeTick;
+				lastChangeTick = this->getEngine()->getChangeTick();
+				uint32_t count = 0;
+				for (auto entity : sortedEntities) {
+					if (family.changedSince(entity, since)) {
+						processEntity(entity, deltaTime);
+						count++;
+					}
+				}
+				this->countProcessedEntities(count);
+				return;
+			}
+			for (auto entity : sortedEntities) {
+				processEntity(entity, deltaTime);
+			}
+			this->countProcessedEntities(static_cast<uint32_t>(sortedEntities.size()));
+		}
+
+		/**
+		 * @return The set of entities processed by the system
+		 */
+		const std::vector<Entity*>* getEntities() const {
+			sort();
+			return &sortedEntities;
+		}
+
+		/// @return The Family used when the system was created
+		const Family& getFamily() const {
+			return family;
+		}
+
+	protected:
+		/**
+		 * This method is called on every entity on every update call of the EntitySystem.
+		 * Override this to implement your system's specific processing.
+		 *
+		 * @param entity The current Entity being processed
+		 * @param deltaTime The delta time between the last and current frame
+		 */
+		virtual void processEntity(Entity* entity, float deltaTime) = 0;
+	};
+}
+
+#ifdef USING_ECSTASY
+	using ecstasy::RadixSortedIteratingSystem;
+#endif
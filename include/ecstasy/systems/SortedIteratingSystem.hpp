@@ -16,27 +16,43 @@
 ******************************************************************************/
 #include <ecstasy/core/EntitySystem.hpp>
 #include <ecstasy/core/Engine.hpp>
+#include <algorithm>
+#include <unordered_set>
 
 namespace ecstasy {
 	class Entity;
 
+	/// The strategy used by SortedIteratingSystem to keep its entities sorted.
+	enum class SortMode {
+		/// Every addition or removal causes the complete entity list to be resorted.
+		Full,
+		/**
+		 * Only newly added entities are sorted and then merged into the already sorted list. Removed entities are
+		 * collected and compacted out in one pass. forceSort() tries an insertion sort first, which is cheap when the
+		 * list is nearly sorted, and falls back to a full sort otherwise.
+		 */
+		Incremental
+	};
+
 	/**
-	 * Like IteratingSystem, but sorted using a comparator.
-	 * It processes each Entity of a given Family in the order specified by a comparator and
-	 * calls processEntity() for each Entity every time the EntitySystem is updated. This is really just a convenience
-	 * class as rendering systems tend to iterate over a list of entities in a sorted manner. Adding entities will cause
-	 * the entity list to be resorted. Call forceSort() if you changed your sorting criteria.
+	 * Common implementation of SortedIteratingSystem and StaticSortedIteratingSystem.
+	 * Extend one of those instead.
 	 *
 	 * @tparam T The EntitySystem class used to create the type.
 	 * @tparam C The comparator type
+	 * @tparam D The class implementing processEntity(Entity*, float).
 	 */
-	template<typename T, typename C>
-	class SortedIteratingSystem : public EntitySystem<T> {
+	template<typename T, typename C, typename D>
+	class BasicSortedIteratingSystem : public EntitySystem<T> {
 	private:
 		const Family& family;
-		std::vector<Entity*> sortedEntities;
-		bool shouldSort;
-		C comparator;
+		mutable std::vector<Entity*> sortedEntities;
+		mutable std::vector<Entity*> addedEntities;
+		mutable std::unordered_set<Entity*> removedEntities;
+		mutable bool shouldSort = false;
+		mutable C comparator;
+		SortMode sortMode = SortMode::Full;
+		uint32_t lastChangeTick = 0;
 		Signal11::ConnectionScope scope;
 
 	public:
@@ -47,7 +63,7 @@ namespace ecstasy {
 		 * @param comparator The comparator to sort the entities
 		 * @copydetails EntitySystem::EntitySystem()
 		 */
-		SortedIteratingSystem(const Family& family, C comparator, int priority=0)
+		BasicSortedIteratingSystem(const Family& family, C comparator, int priority=0)
 			: EntitySystem<T>(priority) , family(family), comparator(comparator) {}
 
 		/**
@@ -58,24 +74,96 @@ namespace ecstasy {
 			shouldSort = true;
 		}
 
+		/**
+		 * Change the sorting strategy. Pending changes will be sorted using the old strategy first.
+		 *
+		 * @param mode The new SortMode
+		 */
+		void setSortMode(SortMode mode) {
+			sort();
+			sortMode = mode;
+		}
+
+		/// @return The current SortMode
+		SortMode getSortMode() const {
+			return sortMode;
+		}
+
 	private:
-		void sort() {
+		void sort() const {
+			if (!removedEntities.empty()) {
+				sortedEntities.erase(std::remove_if(sortedEntities.begin(), sortedEntities.end(), [this](Entity* entity) {
+					return removedEntities.count(entity) != 0;
+				}), sortedEntities.end());
+				removedEntities.clear();
+			}
+
+			if (shouldSort && sortMode == SortMode::Incremental) {
+				// Resorting a list which was sorted before is usually cheap using an insertion sort
+				if (!insertionSort(sortedEntities.size() * 4))
+					std::sort(sortedEntities.begin(), sortedEntities.end(), comparator);
+				shouldSort = false;
+			}
+
+			if (!addedEntities.empty()) {
+				std::sort(addedEntities.begin(), addedEntities.end(), comparator);
+				auto middle = sortedEntities.size();
+				sortedEntities.insert(sortedEntities.end(), addedEntities.begin(), addedEntities.end());
+				std::inplace_merge(sortedEntities.begin(), sortedEntities.begin() + middle, sortedEntities.end(), comparator);
+				addedEntities.clear();
+			}
+
 			if (shouldSort) {
 				std::sort(sortedEntities.begin(), sortedEntities.end(), comparator);
 				shouldSort = false;
 			}
 		}
 
+		/**
+		 * Insertion sort, which gives up once more than maxMoves elements have been moved.
+		 *
+		 * @param maxMoves The maximum number of moves allowed
+		 * @return @a true if the list is sorted, @a false if the sort has been aborted.
+		 */
+		bool insertionSort(size_t maxMoves) const {
+			size_t moves = 0;
+			for (size_t i = 1; i < sortedEntities.size(); i++) {
+				auto entity = sortedEntities[i];
+				size_t j = i;
+				for (; j > 0 && comparator(entity, sortedEntities[j - 1]); j--) {
+					sortedEntities[j] = sortedEntities[j - 1];
+					if (++moves > maxMoves) {
+						sortedEntities[j - 1] = entity;
+						return false;
+					}
+				}
+				sortedEntities[j] = entity;
+			}
+			return true;
+		}
+
 		void entityAdded(Entity* entity) {
-			sortedEntities.push_back(entity);
-			shouldSort = true;
+			if (sortMode == SortMode::Incremental) {
+				addedEntities.push_back(entity);
+			} else {
+				sortedEntities.push_back(entity);
+				shouldSort = true;
+			}
 		}
 
 		void entityRemoved(Entity* entity) {
-			auto it = std::find(sortedEntities.begin(), sortedEntities.end(), entity);
-			if (it != sortedEntities.end()) {
-				sortedEntities.erase(it);
-				shouldSort = true;
+			if (sortMode == SortMode::Incremental) {
+				auto it = std::find(addedEntities.begin(), addedEntities.end(), entity);
+				if (it != addedEntities.end())
+					addedEntities.erase(it);
+				else
+					removedEntities.insert(entity);
+			} else {
+				auto it = std::find(sortedEntities.begin(), sortedEntities.end(), entity);
+				if (it != sortedEntities.end()) {
+					sortedEntities.erase(it);
+					shouldSort = true;
+				}
 			}
 		}
 
@@ -83,6 +171,8 @@ namespace ecstasy {
 		void addedToEngine(Engine* engine) override {
 			auto newEntities = engine->getEntitiesFor(family);
 			sortedEntities.clear();
+			addedEntities.clear();
+			removedEntities.clear();
 			if (!newEntities->empty()) {
 				for (auto entity : *newEntities) {
 					sortedEntities.push_back(entity);
@@ -90,22 +180,39 @@ namespace ecstasy {
 				std::sort(sortedEntities.begin(), sortedEntities.end(), comparator);
 			}
 			shouldSort = false;
-			scope += engine->getEntityAddedSignal(family).connect(this, &SortedIteratingSystem::entityAdded);
-			scope += engine->getEntityRemovedSignal(family).connect(this, &SortedIteratingSystem::entityRemoved);
+			scope += engine->getEntityAddedSignal(family).connect(this, &BasicSortedIteratingSystem::entityAdded);
+			scope += engine->getEntityRemovedSignal(family).connect(this, &BasicSortedIteratingSystem::entityRemoved);
 		}
 
 		void removedFromEngine(Engine* engine) override {
 			scope.removeAll();
 			sortedEntities.clear();
+			addedEntities.clear();
+			removedEntities.clear();
 			shouldSort = false;
 		}
 
 	public:
 		void update(float deltaTime) override {
 			sort();
+			auto self = static_cast<D*>(this);
+			if (family.hasChangeFilter()) {
+				auto since = lastChangeTick;
+				lastChangeTick = this->getEngine()->getChangeTick();
+				uint32_t count = 0;
+				for (auto entity : sortedEntities) {
+					if (family.changedSince(entity, since)) {
+						self->processEntity(entity, deltaTime);
+						count++;
+					}
+				}
+				this->countProcessedEntities(count);
+				return;
+			}
 			for (auto entity : sortedEntities) {
-				processEntity(entity, deltaTime);
+				self->processEntity(entity, deltaTime);
 			}
+			this->countProcessedEntities(static_cast<uint32_t>(sortedEntities.size()));
 		}
 
 		/**
@@ -120,6 +227,34 @@ namespace ecstasy {
 		const Family& getFamily() const {
 			return family;
 		}
+	};
+
+	/**
+	 * Like IteratingSystem, but sorted using a comparator.
+	 * It processes each Entity of a given Family in the order specified by a comparator and
+	 * calls processEntity() for each Entity every time the EntitySystem is updated. This is really just a convenience
+	 * class as rendering systems tend to iterate over a list of entities in a sorted manner. Adding entities will cause
+	 * the entity list to be resorted. Call forceSort() if you changed your sorting criteria.
+	 * For large lists with little churn, consider using SortMode::Incremental (see setSortMode()).
+	 * If the Family has been created using Family::changed(), only entities with changes since the last update will be
+	 * processed.
+	 *
+	 * @tparam T The EntitySystem class used to create the type.
+	 * @tparam C The comparator type
+	 */
+	template<typename T, typename C>
+	class SortedIteratingSystem : public BasicSortedIteratingSystem<T, C, SortedIteratingSystem<T, C>> {
+		friend class BasicSortedIteratingSystem<T, C, SortedIteratingSystem<T, C>>;
+	public:
+		/**
+		 * Instantiates a system that will iterate over the entities described by the Family, with a specific priority.
+		 *
+		 * @param family The family of entities iterated over in this System
+		 * @param comparator The comparator to sort the entities
+		 * @copydetails EntitySystem::EntitySystem()
+		 */
+		SortedIteratingSystem(const Family& family, C comparator, int priority=0)
+			: BasicSortedIteratingSystem<T, C, SortedIteratingSystem<T, C>>(family, comparator, priority) {}
 
 	protected:
 		/**
@@ -131,8 +266,36 @@ namespace ecstasy {
 		 */
 		virtual void processEntity(Entity* entity, float deltaTime) = 0;
 	};
+
+	/**
+	 * Like SortedIteratingSystem, but processEntity() is not virtual. Instead it is called directly on the system
+	 * class (CRTP), so the compiler is able to inline it into the iteration loop.
+	 *
+	 * The system class must provide a method accessible to this class (i.e. public) with this signature:
+	 * @code
+	 * void processEntity(Entity* entity, float deltaTime);
+	 * @endcode
+	 *
+	 * @tparam T The EntitySystem class used to create the type. Must implement processEntity().
+	 * @tparam C The comparator type
+	 */
+	template<typename T, typename C>
+	class StaticSortedIteratingSystem : public BasicSortedIteratingSystem<T, C, T> {
+	public:
+		/**
+		 * Instantiates a system that will iterate over the entities described by the Family, with a specific priority.
+		 *
+		 * @param family The family of entities iterated over in this System
+		 * @param comparator The comparator to sort the entities
+		 * @copydetails EntitySystem::EntitySystem()
+		 */
+		StaticSortedIteratingSystem(const Family& family, C comparator, int priority=0)
+			: BasicSortedIteratingSystem<T, C, T>(family, comparator, priority) {}
+	};
 }
 
 #ifdef USING_ECSTASY
 	using ecstasy::SortedIteratingSystem;
+	using ecstasy::StaticSortedIteratingSystem;
+	using ecstasy::SortMode;
 #endif
@@ -15,21 +15,68 @@
  * limitations under the License.
  ******************************************************************************/
 
-#include <map>
 #include <string>
 #include <vector>
 #include <memory>
+#include <stdint.h>
 
 namespace ecstasy {
+	/// Identifies an interned key of a ComponentBlueprint value, see ComponentBlueprint::getKey().
+	typedef uint32_t BlueprintKey;
+
 	/**
 	 * Stores the name of a component and key/value pairs to construct the component.
 	 * See EntityFactory.
+	 *
+	 * Values are parsed into their int, float and bool representations when they are set, and stored in a flat array
+	 * sorted by their interned key. Component factories can look up keys once using getKey() and then read values
+	 * without any string comparisons or conversions.
 	 */
 	class ComponentBlueprint {
+	public:
+		/// Flags of a Value, describing which representations are valid.
+		enum ValueFlags : uint32_t {
+			HAS_INT = 1,
+			HAS_FLOAT = 2,
+			HAS_BOOL = 4,
+			BOOL_VALUE = 8
+		};
+
+		/// A value with all of its parsed representations.
+		struct Value {
+			BlueprintKey key;
+			/// The name of the key, owned by the key registry.
+			const std::string* keyName;
+			uint32_t flags;
+			int intValue;
+			float floatValue;
+			std::string text;
+
+			/// @return true if the text is "true", false if it is "false", otherwise @a defaultValue.
+			bool getBool(bool defaultValue) const {
+				return (flags & HAS_BOOL) ? (flags & BOOL_VALUE) != 0 : defaultValue;
+			}
+			/// @return The text as integer, or @a defaultValue if it is not a valid number.
+			int getInt(int defaultValue) const {
+				return (flags & HAS_INT) ? intValue : defaultValue;
+			}
+			/// @return The text as float, or @a defaultValue if it is not a valid number.
+			float getFloat(float defaultValue) const {
+				return (flags & HAS_FLOAT) ? floatValue : defaultValue;
+			}
+		};
+
+		/// Returned by findKey() if a key has never been interned.
+		static const BlueprintKey INVALID_KEY = 0xFFFFFFFF;
+
 	private:
 		friend class EntityFactory;
+		friend class BlueprintPack;
 		std::string name;
-		std::map<std::string, std::string> values;
+		std::vector<Value> values;
+
+		Value& insert(BlueprintKey key);
+		const Value* findByName(const std::string& key) const;
 
 	public:
 		/**
@@ -48,6 +95,50 @@ namespace ecstasy {
 		 */
 		void set(const std::string& key, const std::string& value);
 
+		/**
+		 * Set a key/value pair
+		 *
+		 * @param key the interned key
+		 * @param value the value
+		 */
+		void set(BlueprintKey key, const std::string& value);
+
+		/**
+		 * Get the interned id of a key, interning it if needed. This is thread-safe.
+		 *
+		 * @param name the key
+		 * @return The id of the key, which is the same for all blueprints.
+		 */
+		static BlueprintKey getKey(const std::string& name);
+
+		/**
+		 * Get the interned id of a key without interning it.
+		 *
+		 * @param name the key
+		 * @return The id of the key or INVALID_KEY if no blueprint ever used this key.
+		 */
+		static BlueprintKey findKey(const std::string& name);
+
+		/**
+		 * @param key an interned key
+		 * @return The name of the key.
+		 */
+		static const std::string& getKeyName(BlueprintKey key);
+
+		/**
+		 * Find a value
+		 *
+		 * @param key the interned key
+		 * @return The value or nullptr if none exists for key.
+		 */
+		const Value* find(BlueprintKey key) const;
+
+		/// @return The name of the component.
+		const std::string& getName() const { return name; }
+
+		/// @return All values, sorted by their key.
+		const std::vector<Value>& getValues() const { return values; }
+
 		/**
 		 * Get a boolean value
 		 *
@@ -57,6 +148,12 @@ namespace ecstasy {
 		 */
 		bool getBool(const std::string& key, bool defaultValue) const;
 
+		/// @copydoc getBool(const std::string&, bool) const
+		bool getBool(BlueprintKey key, bool defaultValue) const {
+			auto value = find(key);
+			return value ? value->getBool(defaultValue) : defaultValue;
+		}
+
 		/**
 		 * Get an integer value
 		 *
@@ -66,6 +163,12 @@ namespace ecstasy {
 		 */
 		int getInt(const std::string& key, int defaultValue) const;
 
+		/// @copydoc getInt(const std::string&, int) const
+		int getInt(BlueprintKey key, int defaultValue) const {
+			auto value = find(key);
+			return value ? value->getInt(defaultValue) : defaultValue;
+		}
+
 		/**
 		 * Get a float value
 		 *
@@ -75,6 +178,12 @@ namespace ecstasy {
 		 */
 		float getFloat(const std::string& key, float defaultValue) const;
 
+		/// @copydoc getFloat(const std::string&, float) const
+		float getFloat(BlueprintKey key, float defaultValue) const {
+			auto value = find(key);
+			return value ? value->getFloat(defaultValue) : defaultValue;
+		}
+
 		/**
 		 * Get a string value
 		 *
@@ -83,6 +192,12 @@ namespace ecstasy {
 		 * @return The corresponding value or @a defaultValue if none exists.
 		 */
 		const std::string& getString(const std::string& key, const std::string& defaultValue) const;
+
+		/// @copydoc getString(const std::string&, const std::string&) const
+		const std::string& getString(BlueprintKey key, const std::string& defaultValue) const {
+			auto value = find(key);
+			return value ? value->text : defaultValue;
+		}
 	};
 
 	/**
@@ -92,6 +207,7 @@ namespace ecstasy {
 	class EntityBlueprint {
 	private:
 		friend class EntityFactory;
+		friend class BlueprintPack;
 		std::vector<std::shared_ptr<ComponentBlueprint>> components;
 
 	public:
@@ -103,6 +219,7 @@ namespace ecstasy {
 }
 
 #ifdef USING_ECSTASY
+	using ecstasy::BlueprintKey;
 	using ecstasy::ComponentBlueprint;
 	using ecstasy::EntityBlueprint;
 #endif
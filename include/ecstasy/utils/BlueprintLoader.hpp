@@ -0,0 +1,83 @@
+#pragma once
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace ecstasy {
+	class EntityFactory;
+
+	/**
+	 * Loads many blueprint files (see parseBlueprint()) concurrently and adds them to an EntityFactory.
+	 * Collect the files using addFile(), addDirectory() or addManifest(), then call load().
+	 */
+	class BlueprintLoader {
+	private:
+		std::vector<std::pair<std::string, std::string>> files;
+		uint32_t threadCount;
+
+	public:
+		/// @param threadCount The number of threads used to parse the files. 0 uses one per hardware thread.
+		explicit BlueprintLoader(uint32_t threadCount = 0) : threadCount(threadCount) {}
+		BlueprintLoader(const BlueprintLoader&) = delete;
+
+		/**
+		 * @param name the name to add the EntityBlueprint as
+		 * @param filename the blueprint file
+		 */
+		void addFile(const std::string& name, const std::string& filename) {
+			files.emplace_back(name, filename);
+		}
+
+		/**
+		 * Add all files in a directory (not recursive). The blueprint names are the filenames without extension.
+		 *
+		 * @param directory the directory to search
+		 * @param extension the extension of the blueprint files
+		 * @return An empty string on success, otherwise an error message.
+		 */
+		std::string addDirectory(const std::string& directory, const std::string& extension = ".def");
+
+		/**
+		 * Add the files listed in a manifest. Each line of the manifest contains a blueprint name followed by the
+		 * filename relative to the manifest. Comments start with '#'.
+		 *
+		 * @param filename the manifest file
+		 * @return An empty string on success, otherwise an error message containing line information.
+		 */
+		std::string addManifest(const std::string& filename);
+
+		/// @return The number of files added so far.
+		size_t getFileCount() const {
+			return files.size();
+		}
+
+		/**
+		 * Parse all files added so far and add the blueprints to the factory in the order the files have been added.
+		 * Files which fail to parse are skipped, the others are added nonetheless. The file list is cleared afterwards.
+		 *
+		 * @param factory the factory to add the blueprints to
+		 * @return An empty string on success, otherwise one line per failed file ("filename: error").
+		 */
+		std::string load(EntityFactory& factory);
+	};
+}
+
+#ifdef USING_ECSTASY
+	using ecstasy::BlueprintLoader;
+#endif
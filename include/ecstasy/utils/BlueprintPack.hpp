@@ -0,0 +1,152 @@
+#pragma once
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include <ecstasy/utils/StringView.hpp>
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <ostream>
+
+namespace ecstasy {
+	class EntityBlueprint;
+
+	/**
+	 * A compact binary file containing a set of named {@link EntityBlueprint}s. All strings are stored once in a
+	 * string table and values are stored along with their parsed int, float and bool representations.
+	 * The file is memory mapped when opened and a blueprint is only read when it gets requested.
+	 * Packs are written in the native byte order, so they should be created on the platform they are used on.
+	 *
+	 * Use EntityFactory::addBlueprintPack() to assemble entities from a pack.
+	 */
+	class BlueprintPack {
+	public:
+		/// Returned by find() if no blueprint has the specified name.
+		static const uint32_t NOT_FOUND = 0xFFFFFFFF;
+
+	private:
+		struct Header {
+			char magic[4];
+			uint32_t version;
+			uint32_t stringCount;
+			uint32_t stringBytes;
+			uint32_t blueprintCount;
+			uint32_t componentCount;
+			uint32_t valueCount;
+		};
+		struct StringEntry {
+			uint32_t offset;
+			uint32_t length;
+		};
+		struct BlueprintEntry {
+			uint32_t name;
+			uint32_t firstComponent;
+			uint32_t componentCount;
+		};
+		struct ComponentEntry {
+			uint32_t name;
+			uint32_t firstValue;
+			uint32_t valueCount;
+		};
+		struct ValueEntry {
+			uint32_t key;
+			uint32_t text;
+			/// ComponentBlueprint::ValueFlags
+			uint32_t flags;
+			int32_t intValue;
+			float floatValue;
+		};
+
+		const char* data = nullptr;
+		size_t size = 0;
+		bool mapped = false;
+		const Header* header = nullptr;
+		const StringEntry* strings = nullptr;
+		const BlueprintEntry* blueprints = nullptr;
+		const ComponentEntry* components = nullptr;
+		const ValueEntry* values = nullptr;
+		const char* stringData = nullptr;
+
+	public:
+		BlueprintPack() {}
+		BlueprintPack(const BlueprintPack&) = delete;
+		~BlueprintPack() { close(); }
+
+		/**
+		 * Open a pack file. The file stays mapped until close() is called.
+		 *
+		 * @param filename The file to open
+		 * @return An empty string on success, otherwise an error message.
+		 */
+		std::string open(const std::string& filename);
+
+		/// Release the file opened by open().
+		void close();
+
+		/// @return The number of blueprints in this pack.
+		uint32_t getBlueprintCount() const {
+			return header ? header->blueprintCount : 0;
+		}
+
+		/**
+		 * @param index The index of the blueprint (less than getBlueprintCount())
+		 * @return The name of the blueprint, which stays valid until close() is called.
+		 */
+		StringView getBlueprintName(uint32_t index) const;
+
+		/**
+		 * Look up a blueprint by name without copying any data.
+		 *
+		 * @param name The name of the blueprint
+		 * @return The index of the blueprint or NOT_FOUND.
+		 */
+		uint32_t find(StringView name) const;
+
+		/**
+		 * Read a blueprint from the pack.
+		 *
+		 * @param index The index of the blueprint (see find())
+		 * @return The blueprint or @a nullptr if the index is invalid or the pack is corrupt.
+		 */
+		std::shared_ptr<EntityBlueprint> getBlueprint(uint32_t index) const;
+
+		/**
+		 * Write a set of blueprints as a pack.
+		 *
+		 * @param stream The binary stream to write to
+		 * @param blueprints The blueprints by name
+		 * @return An empty string on success, otherwise an error message.
+		 */
+		static std::string write(std::ostream& stream,
+			const std::map<std::string, std::shared_ptr<EntityBlueprint>>& blueprints);
+
+	private:
+		bool getString(uint32_t index, StringView& result) const;
+	};
+
+	/**
+	 * Convert blueprint text files (see parseBlueprint()) into a BlueprintPack file.
+	 *
+	 * @param files The blueprint files by the name to store the blueprint as.
+	 * @param filename The pack file to write
+	 * @return An empty string on success, otherwise an error message.
+	 */
+	std::string convertBlueprints(const std::map<std::string, std::string>& files, const std::string& filename);
+}
+
+#ifdef USING_ECSTASY
+	using ecstasy::BlueprintPack;
+#endif
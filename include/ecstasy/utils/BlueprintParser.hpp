@@ -14,6 +14,7 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  ******************************************************************************/
+#include <ecstasy/utils/StringView.hpp>
 #include <memory>
 #include <string>
 #include <istream>
@@ -21,7 +22,7 @@
 namespace ecstasy {
 	class EntityBlueprint;
 	/**
-	 * Parse a blueprint file.
+	 * Parse a blueprint file. The file is read in one go.
 	 *
 	 * @param filename the file to parse
 	 * @param result an empty shared_ptr to store the result.
@@ -37,4 +38,13 @@ namespace ecstasy {
 	 * @return An empty string on success, otherwise an error message containing line information.
 	 */
 	std::string parseBlueprint(std::istream& stream, std::shared_ptr<EntityBlueprint>& result);
+
+	/**
+	 * Parse a blueprint from a text in memory.
+	 *
+	 * @param text the blueprint text
+	 * @param result an empty shared_ptr to store the result.
+	 * @return An empty string on success, otherwise an error message containing line information.
+	 */
+	std::string parseBlueprintText(StringView text, std::shared_ptr<EntityBlueprint>& result);
 }
@@ -16,6 +16,7 @@
  ******************************************************************************/
 
 #include <ecstasy/core/Entity.hpp>
+#include <memory>
 
 namespace ecstasy {
 	class ComponentBlueprint;
@@ -25,6 +26,8 @@ namespace ecstasy {
 	 */
 	class ComponentFactory {
 	public:
+		virtual ~ComponentFactory() {}
+
 		/**
 		 * Create a Component based on the blueprint and add it to the Entity.
 		 *
@@ -33,6 +36,75 @@ namespace ecstasy {
 		 * @return @a true on success.
 		 */
 		virtual bool assemble(Entity* entity, ComponentBlueprint& blueprint) = 0;
+
+		/**
+		 * Read the values of a blueprint once, so they don't need to be parsed on every assembly.
+		 * The default implementation returns @a nullptr, so assembleCompiled() falls back to assemble().
+		 *
+		 * @param blueprint the blueprint
+		 * @return The data to pass to assembleCompiled() or @a nullptr.
+		 */
+		virtual std::shared_ptr<const void> compile(const ComponentBlueprint& blueprint) {
+			return nullptr;
+		}
+
+		/**
+		 * Create a Component based on the data returned by compile() and add it to the Entity.
+		 * The default implementation calls assemble().
+		 *
+		 * @param entity the Entity to add the Component to.
+		 * @param blueprint the blueprint passed to compile()
+		 * @param data the data returned by compile()
+		 * @return @a true on success.
+		 */
+		virtual bool assembleCompiled(Entity* entity, ComponentBlueprint& blueprint, const void* data) {
+			return assemble(entity, blueprint);
+		}
+	};
+
+	/**
+	 * A template ComponentFactory implementation for components, which read data from the blueprint.
+	 * The blueprint values are parsed into a Data object, which is done only once when the blueprint gets compiled
+	 * (see EntityFactory::compile()).
+	 *
+	 * @tparam Data A default constructible type holding the values read from the blueprint.
+	 */
+	template<typename Data>
+	class CompiledComponentFactory : public ComponentFactory {
+	protected:
+		/**
+		 * Read the values of the blueprint.
+		 *
+		 * @param data the Data to fill
+		 * @param blueprint the blueprint
+		 */
+		virtual void parse(Data& data, const ComponentBlueprint& blueprint) = 0;
+
+		/**
+		 * Create a Component based on the parsed values and add it to the Entity.
+		 *
+		 * @param entity the Entity to add the Component to.
+		 * @param data the values read by parse()
+		 * @return @a true on success.
+		 */
+		virtual bool create(Entity* entity, const Data& data) = 0;
+
+	public:
+		bool assemble(Entity* entity, ComponentBlueprint& blueprint) override {
+			Data data;
+			parse(data, blueprint);
+			return create(entity, data);
+		}
+
+		std::shared_ptr<const void> compile(const ComponentBlueprint& blueprint) override {
+			auto data = std::make_shared<Data>();
+			parse(*data, blueprint);
+			return data;
+		}
+
+		bool assembleCompiled(Entity* entity, ComponentBlueprint& blueprint, const void* data) override {
+			return create(entity, *static_cast<const Data*>(data));
+		}
 	};
 
 	/**
@@ -55,4 +127,5 @@ namespace ecstasy {
 #ifdef USING_ECSTASY
 	using ecstasy::ComponentFactory;
 	using ecstasy::SimpleComponentFactory;
+	using ecstasy::CompiledComponentFactory;
 #endif
@@ -0,0 +1,225 @@
+#pragma once
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include <ecstasy/utils/Blueprint.hpp>
+#include <ecstasy/utils/ComponentFactory.hpp>
+#include <initializer_list>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace ecstasy {
+	/// The types a reflected component field can have.
+	enum class FieldType : uint8_t {
+		BOOL,
+		INT,
+		FLOAT,
+		STRING
+	};
+
+	/// Maps a C++ type to its FieldType. Only the specialized types are supported.
+	template<typename F> struct FieldTypeOf;
+	template<> struct FieldTypeOf<bool> { static const FieldType value = FieldType::BOOL; };
+	template<> struct FieldTypeOf<int> { static const FieldType value = FieldType::INT; };
+	template<> struct FieldTypeOf<float> { static const FieldType value = FieldType::FLOAT; };
+	template<> struct FieldTypeOf<std::string> { static const FieldType value = FieldType::STRING; };
+
+	/**
+	 * Describes the fields of a component type: their names, types and offsets within the component.
+	 * Use ECS_COMPONENT_FIELDS() to register the fields of a component and getComponentFields() to access them.
+	 *
+	 * Blueprint values are written directly to the fields at their offsets, and the fields can be written to and read
+	 * from a compact binary representation.
+	 */
+	class ComponentFields {
+	public:
+		/// A registered field
+		struct Field {
+			std::string name;
+			BlueprintKey key;
+			FieldType type;
+			size_t offset;
+		};
+
+		/// A blueprint value resolved to the field it is written to
+		struct FieldValue {
+			uint32_t field;
+			ComponentBlueprint::Value value;
+		};
+
+		/// The values of a blueprint, resolved once by parse()
+		typedef std::vector<FieldValue> Values;
+
+	private:
+		std::vector<Field> fields;
+
+	public:
+		/**
+		 * Create the field descriptions of a component.
+		 *
+		 * @param names The comma separated names of the fields, in the same order as @a members.
+		 * @param members Pointers to the members of T.
+		 * @return The field descriptions.
+		 */
+		template<typename T, typename ... Members>
+		static ComponentFields create(const char* names, Members T::* ... members) {
+			ComponentFields result;
+			const T object{};
+			result.addFields(names, { getFieldType<Members>()... }, { getOffset(object, members)... });
+			return result;
+		}
+
+		/// @return All registered fields, in the order of registration.
+		const std::vector<Field>& getFields() const { return fields; }
+
+		/**
+		 * Resolve the values of a blueprint to the fields they will be written to.
+		 * Values without a matching field are ignored.
+		 *
+		 * @param values Receives the resolved values.
+		 * @param blueprint the blueprint
+		 */
+		void parse(Values& values, const ComponentBlueprint& blueprint) const;
+
+		/**
+		 * Write resolved values to a component. Values which can't be converted to the type of the field are skipped.
+		 *
+		 * @param component The component to write to.
+		 * @param values The values returned by parse().
+		 */
+		void apply(void* component, const Values& values) const;
+
+		/**
+		 * Append the fields of a component to a buffer in native byte order.
+		 *
+		 * @param component The component to read from.
+		 * @param buffer The buffer to append to.
+		 */
+		void write(const void* component, std::vector<char>& buffer) const;
+
+		/**
+		 * Read the fields of a component from data written by write().
+		 *
+		 * @param component The component to write to.
+		 * @param position The position to read from, moved past the fields on success.
+		 * @param end The end of the data.
+		 * @return false if the data is truncated.
+		 */
+		bool read(void* component, const char*& position, const char* end) const;
+
+	private:
+		void addFields(const char* names, std::initializer_list<FieldType> types, std::initializer_list<size_t> offsets);
+
+		template<typename F>
+		static FieldType getFieldType() {
+			static_assert(std::is_same<F, bool>::value || std::is_same<F, int>::value
+				|| std::is_same<F, float>::value || std::is_same<F, std::string>::value,
+				"Component fields must be of type bool, int, float or std::string");
+			return FieldTypeOf<F>::value;
+		}
+
+		template<typename T, typename F>
+		static size_t getOffset(const T& object, F T::* member) {
+			// offsetof() is not supported for components, as they are not standard layout
+			return reinterpret_cast<const char*>(&(object.*member)) - reinterpret_cast<const char*>(&object);
+		}
+	};
+
+	/**
+	 * @tparam T The component type. Its fields must have been registered using ECS_COMPONENT_FIELDS().
+	 * @return The field descriptions of T.
+	 */
+	template<typename T>
+	const ComponentFields& getComponentFields() {
+		// Found via argument dependent lookup, see ECS_COMPONENT_FIELDS()
+		return getEcstasyComponentFields(static_cast<const T*>(nullptr));
+	}
+
+	/**
+	 * A ComponentFactory for components with registered fields (see ECS_COMPONENT_FIELDS()).
+	 * The blueprint values with the same names as the fields are written to the component after it has been created.
+	 *
+	 * @tparam T The component type. It must be default constructible.
+	 */
+	template<typename T>
+	class ReflectedComponentFactory : public CompiledComponentFactory<ComponentFields::Values> {
+	public:
+		ReflectedComponentFactory() {}
+		ReflectedComponentFactory(const ReflectedComponentFactory&) = delete;
+
+	protected:
+		void parse(ComponentFields::Values& values, const ComponentBlueprint& blueprint) override {
+			getComponentFields<T>().parse(values, blueprint);
+		}
+
+		bool create(Entity* entity, const ComponentFields::Values& values) override {
+			auto component = entity->emplace<T>();
+			if (!component)
+				return false;
+			getComponentFields<T>().apply(component, values);
+			return true;
+		}
+	};
+}
+
+/// @cond
+#define ECS_FIELDS_EXPAND(x) x
+#define ECS_FIELDS_GET_MACRO(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, NAME, ...) NAME
+#define ECS_FIELDS_1(T, f) &T::f
+#define ECS_FIELDS_2(T, f, ...) &T::f, ECS_FIELDS_EXPAND(ECS_FIELDS_1(T, __VA_ARGS__))
+#define ECS_FIELDS_3(T, f, ...) &T::f, ECS_FIELDS_EXPAND(ECS_FIELDS_2(T, __VA_ARGS__))
+#define ECS_FIELDS_4(T, f, ...) &T::f, ECS_FIELDS_EXPAND(ECS_FIELDS_3(T, __VA_ARGS__))
+#define ECS_FIELDS_5(T, f, ...) &T::f, ECS_FIELDS_EXPAND(ECS_FIELDS_4(T, __VA_ARGS__))
+#define ECS_FIELDS_6(T, f, ...) &T::f, ECS_FIELDS_EXPAND(ECS_FIELDS_5(T, __VA_ARGS__))
+#define ECS_FIELDS_7(T, f, ...) &T::f, ECS_FIELDS_EXPAND(ECS_FIELDS_6(T, __VA_ARGS__))
+#define ECS_FIELDS_8(T, f, ...) &T::f, ECS_FIELDS_EXPAND(ECS_FIELDS_7(T, __VA_ARGS__))
+#define ECS_FIELDS_9(T, f, ...) &T::f, ECS_FIELDS_EXPAND(ECS_FIELDS_8(T, __VA_ARGS__))
+#define ECS_FIELDS_10(T, f, ...) &T::f, ECS_FIELDS_EXPAND(ECS_FIELDS_9(T, __VA_ARGS__))
+#define ECS_FIELDS_11(T, f, ...) &T::f, ECS_FIELDS_EXPAND(ECS_FIELDS_10(T, __VA_ARGS__))
+#define ECS_FIELDS_12(T, f, ...) &T::f, ECS_FIELDS_EXPAND(ECS_FIELDS_11(T, __VA_ARGS__))
+#define ECS_FIELDS_13(T, f, ...) &T::f, ECS_FIELDS_EXPAND(ECS_FIELDS_12(T, __VA_ARGS__))
+#define ECS_FIELDS_14(T, f, ...) &T::f, ECS_FIELDS_EXPAND(ECS_FIELDS_13(T, __VA_ARGS__))
+#define ECS_FIELDS_15(T, f, ...) &T::f, ECS_FIELDS_EXPAND(ECS_FIELDS_14(T, __VA_ARGS__))
+#define ECS_FIELDS_16(T, f, ...) &T::f, ECS_FIELDS_EXPAND(ECS_FIELDS_15(T, __VA_ARGS__))
+#define ECS_FIELDS_MEMBERS(T, ...) ECS_FIELDS_EXPAND(ECS_FIELDS_GET_MACRO(__VA_ARGS__, ECS_FIELDS_16, ECS_FIELDS_15, \
+	ECS_FIELDS_14, ECS_FIELDS_13, ECS_FIELDS_12, ECS_FIELDS_11, ECS_FIELDS_10, ECS_FIELDS_9, ECS_FIELDS_8, ECS_FIELDS_7, \
+	ECS_FIELDS_6, ECS_FIELDS_5, ECS_FIELDS_4, ECS_FIELDS_3, ECS_FIELDS_2, ECS_FIELDS_1, _)(T, __VA_ARGS__))
+/// @endcond
+
+/**
+ * Register up to 16 fields of a component type, so they can be read from blueprints (see ReflectedComponentFactory)
+ * and serialized. Use it in the namespace of the component, after its definition:
+ * @code
+ * ECS_COMPONENT_FIELDS(PositionComponent, x, y)
+ * @endcode
+ * The component must be default constructible and the fields must be public and of type bool, int, float or
+ * std::string.
+ * The blueprint keys are the names of the fields.
+ */
+#define ECS_COMPONENT_FIELDS(T, ...) \
+	inline const ::ecstasy::ComponentFields& getEcstasyComponentFields(const T*) { \
+		static const ::ecstasy::ComponentFields fields = \
+			::ecstasy::ComponentFields::create<T>(#__VA_ARGS__, ECS_FIELDS_MEMBERS(T, __VA_ARGS__)); \
+		return fields; \
+	}
+
+#ifdef USING_ECSTASY
+	using ecstasy::FieldType;
+	using ecstasy::ComponentFields;
+	using ecstasy::ReflectedComponentFactory;
+#endif
@@ -0,0 +1,129 @@
+#pragma once
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include <ecstasy/core/Component.hpp>
+#include <ecstasy/utils/ComponentFields.hpp>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace ecstasy {
+	/// @cond
+	template<typename T, typename = void>
+	struct HasComponentFields : std::false_type {};
+	template<typename T>
+	struct HasComponentFields<T, decltype(void(getEcstasyComponentFields(static_cast<const T*>(nullptr))))>
+		: std::true_type {};
+	/// @endcond
+
+	/**
+	 * Maps component types to stable names, so they can be serialized (see Engine::saveSnapshot()).
+	 * ComponentType ids depend on the order in which the types are first used, so they must not be stored.
+	 */
+	class ComponentRegistry {
+	public:
+		/// A registered component type
+		struct Entry {
+			std::string name;
+			ComponentType type;
+			uint32_t memorySize;
+			uint32_t memoryAlign;
+			/// The registered fields or @a nullptr if the component has none (see ECS_COMPONENT_FIELDS())
+			const ComponentFields* fields;
+			/// Default constructs the component in memory of memorySize bytes, aligned to memoryAlign
+			ComponentBase* (*create)(void* memory);
+			/// @return The address of the component class, which the offsets of fields are relative to
+			void* (*data)(ComponentBase* component);
+		};
+
+	private:
+		std::vector<Entry> entries;
+		std::vector<uint32_t> indicesByType;
+		std::unordered_map<std::string, uint32_t> indicesByName;
+
+		enum : uint32_t { NONE = 0xFFFFFFFF };
+
+	public:
+		ComponentRegistry() {}
+		ComponentRegistry(const ComponentRegistry&) = delete;
+
+		/**
+		 * Register a component type. Its fields are serialized if they have been registered with
+		 * ECS_COMPONENT_FIELDS(), otherwise only the presence of the component is stored.
+		 *
+		 * @tparam T The component type. It must be default constructible.
+		 * @param name A unique name, which stays the same across builds.
+		 * @return @a false if the name or the type has already been registered.
+		 */
+		template<typename T>
+		bool add(const std::string& name) {
+			auto type = getComponentType<T>();
+			if (indicesByName.count(name) || (type < indicesByType.size() && indicesByType[type] != NONE))
+				return false;
+
+			Entry entry;
+			entry.name = name;
+			entry.type = type;
+			entry.memorySize = sizeof(T);
+			entry.memoryAlign = alignof(T);
+			entry.fields = getFields<T>(HasComponentFields<T>());
+			entry.create = [](void* memory) -> ComponentBase* { return new(memory) T(); };
+			entry.data = [](ComponentBase* component) -> void* { return static_cast<T*>(component); };
+
+			if (type >= indicesByType.size())
+				indicesByType.resize(type + 1, NONE);
+			indicesByType[type] = static_cast<uint32_t>(entries.size());
+			indicesByName.emplace(name, static_cast<uint32_t>(entries.size()));
+			entries.push_back(entry);
+			return true;
+		}
+
+		/**
+		 * @param type The ComponentType
+		 * @return The registered entry or @a nullptr.
+		 */
+		const Entry* get(ComponentType type) const {
+			if (type >= indicesByType.size() || indicesByType[type] == NONE)
+				return nullptr;
+			return &entries[indicesByType[type]];
+		}
+
+		/**
+		 * @param name The name used in add()
+		 * @return The registered entry or @a nullptr.
+		 */
+		const Entry* find(const std::string& name) const {
+			auto it = indicesByName.find(name);
+			return it == indicesByName.end() ? nullptr : &entries[it->second];
+		}
+
+	private:
+		template<typename T>
+		static const ComponentFields* getFields(std::true_type) {
+			return &getComponentFields<T>();
+		}
+
+		template<typename T>
+		static const ComponentFields* getFields(std::false_type) {
+			return nullptr;
+		}
+	};
+}
+
+#ifdef USING_ECSTASY
+	using ecstasy::ComponentRegistry;
+#endif
@@ -49,6 +49,7 @@ namespace ecstasy {
 		char* dataEnd;
 		uint64_t bitflags = 0xFFFFFFFFFFFFFFFF;
 		uint64_t dataOffset = 0;
+		bool evacuating = false;
 
 	public:
 		/**
@@ -99,6 +100,16 @@ namespace ecstasy {
 		uint64_t getBitflags() const {
 			return bitflags;
 		}
+
+		/// @return @a true if the allocations of this page are being moved to other pages.
+		bool isEvacuating() const {
+			return evacuating;
+		}
+
+		/// @param value @a true if the allocations of this page are being moved to other pages.
+		void setEvacuating(bool value) {
+			evacuating = value;
+		}
 	};
 
 	/**
@@ -109,6 +120,11 @@ namespace ecstasy {
 		uint32_t unitSize;
 		uint32_t align;
 		uint32_t allocationCount = 0;
+		uint32_t peakAllocationCount = 0;
+		uint32_t emptyPages = 0;
+		bool pinned;
+		uint64_t totalAllocations = 0;
+		uint64_t totalFrees = 0;
 		std::vector<std::unique_ptr<MemoryPage>> pages;
 		std::vector<MemoryPage*> freePages;
 
@@ -118,8 +134,10 @@ namespace ecstasy {
 		 *
 		 * @param unitSize The unit size to allocate. Use getMemoryUnitSize()
 		 * @param align The memory alignment to adjust to
+		 * @param pinned Whether the allocations are never relocated, so beginCompaction() must not be called.
 		 */
-		MemoryPageManager(uint32_t unitSize, uint32_t align) : unitSize(unitSize), align(align) {}
+		MemoryPageManager(uint32_t unitSize, uint32_t align, bool pinned = false)
+			: unitSize(unitSize), align(align), pinned(pinned) {}
 		MemoryPageManager(const MemoryPageManager &) = delete;
 		~MemoryPageManager() {}
 
@@ -133,6 +151,24 @@ namespace ecstasy {
 			return pages.size();
 		}
 
+		/// @return The unit size of the allocations
+		uint32_t getUnitSize() const {
+			return unitSize;
+		}
+
+		/// @return The align of the allocations
+		uint32_t getAlign() const {
+			return align;
+		}
+
+		/// @return @a true if the allocations were made with MemoryManager::allocatePinned().
+		bool isPinned() const {
+			return pinned;
+		}
+
+		/// @return Statistics about the memory of this manager.
+		MemoryStats getStats() const;
+
 		/**
 		 * Allocate enough memory for the unit-size.
 		 *
@@ -150,15 +186,49 @@ namespace ecstasy {
 
 		/// Try to reduce the memory footprint if possible.
 		void reduceMemory();
+
+		/**
+		 * Create pages until there are at least count free units.
+		 *
+		 * @param count The number of allocations to prepare for
+		 */
+		void reserve(uint32_t count);
+
+		/**
+		 * Mark sparsely used pages as evacuating, as long as their allocations fit into the free units of the
+		 * remaining pages. Evacuating pages will not be used for new allocations until endCompaction() is called.
+		 *
+		 * @param threshold The maximum share of used units for a page to be evacuated (0 to 1).
+		 * @return The number of allocations in evacuating pages.
+		 */
+		uint32_t beginCompaction(float threshold);
+
+		/**
+		 * @param memory Memory allocated by this manager.
+		 * @return @a true if the memory belongs to an evacuating page.
+		 */
+		bool isEvacuating(void* memory) const;
+
+		/// Stop evacuating pages.
+		void endCompaction();
 	};
 
 	/**
 	 * The default memory manager.
-	 * It creates one MemoryPageManager for each size.
+	 * It creates one MemoryPageManager for each size, with separate ones for pinned allocations.
 	 */
 	class DefaultMemoryManager : public MemoryManager {
 	private:
 		std::map<uint64_t, std::unique_ptr<MemoryPageManager>> managers;
+		uint64_t usedBytes = 0;
+		uint64_t peakUsedBytes = 0;
+		uint64_t totalAllocations = 0;
+		uint64_t totalFrees = 0;
+		float compactionThreshold = 0.25f;
+
+		MemoryPageManager* getOrCreateManager(uint32_t size, uint32_t align, bool pinned);
+		const MemoryPageManager* findManager(uint32_t size, uint32_t align, bool pinned) const;
+		void freeInternal(uint32_t size, uint32_t align, void* memory, bool pinned);
 
 	public:
 		DefaultMemoryManager() {}
@@ -168,27 +238,62 @@ namespace ecstasy {
 		void* allocate(uint32_t size, uint32_t align) override;
 		void free(uint32_t size, uint32_t align, void* memory) override;
 		void reduceMemory() override;
+		void reserve(uint32_t size, uint32_t align, uint32_t count) override;
+		void* allocatePinned(uint32_t size, uint32_t align) override;
+		void freePinned(uint32_t size, uint32_t align, void* memory) override;
+		void reservePinned(uint32_t size, uint32_t align, uint32_t count) override;
 		uint32_t getAllocationCount() const override;
+		MemoryStats getStats() const override;
+		uint32_t beginCompaction() override;
+		bool isEvacuating(uint32_t size, uint32_t align, void* memory) const override;
+		void endCompaction() override;
+
+		/**
+		 * @param threshold The maximum share of used units for a page to be evacuated by a compaction (0 to 1).
+		 */
+		void setCompactionThreshold(float threshold) {
+			compactionThreshold = threshold;
+		}
+
+		/// @return The maximum share of used units for a page to be evacuated by a compaction (0 to 1).
+		float getCompactionThreshold() const {
+			return compactionThreshold;
+		}
 
 		/// @return The number of {@link MemoryPageManager}s currently in use.
 		uint32_t getPageManagerCount() const;
 
+		/// @return The {@link MemoryPageManager}s currently in use, ordered by unit size.
+		std::vector<const MemoryPageManager*> getPageManagers() const;
+
 		/**
 		 * Call MemoryPageManager::getAllocationCount() on the MemoryPageManager used for the specified size.
 		 *
 		 * @param size The size used to allocate memory.
 		 * @param align The align used to allocate memory.
+		 * @param pinned Whether the memory was allocated with allocatePinned().
 		 * @return The number of allocations currently in use for the specified size.
 		 */
-		uint32_t getAllocationCount(uint32_t size, uint32_t align) const;
+		uint32_t getAllocationCount(uint32_t size, uint32_t align, bool pinned = false) const;
 
 		/**
 		 * Call MemoryPageManager::getPageCount() on the MemoryPageManager used for the specified size.
 		 *
 		 * @param size The size used to allocate memory.
 		 * @param align The align used to allocate memory.
+		 * @param pinned Whether the memory was allocated with allocatePinned().
 		 * @return The number of {@link MemoryPage}s currently in use for the specified size.
 		 */
-		uint32_t getPageCount(uint32_t size, uint32_t align) const;
+		uint32_t getPageCount(uint32_t size, uint32_t align, bool pinned = false) const;
+
+		/**
+		 * Call MemoryPageManager::getStats() on the MemoryPageManager used for the specified size.
+		 *
+		 * @param size The size used to allocate memory.
+		 * @param align The align used to allocate memory.
+		 * @param pinned Whether the memory was allocated with allocatePinned().
+		 * @return Statistics about the memory used for the specified size.
+		 */
+		MemoryStats getStats(uint32_t size, uint32_t align, bool pinned = false) const;
 	};
 }
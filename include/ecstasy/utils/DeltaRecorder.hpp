@@ -0,0 +1,103 @@
+#pragma once
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include <ecstasy/core/Types.hpp>
+#include <signal11/Signal.hpp>
+#include <stdint.h>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace ecstasy {
+	class Engine;
+	class Entity;
+	class ComponentBase;
+	class ComponentRegistry;
+
+	/**
+	 * Records the changes of an Engine between frames and writes them as compact binary deltas, which can be applied
+	 * to a copy of the world (e.g. one restored using Engine::loadSnapshot()) for network replication or replays.
+	 *
+	 * A delta contains the entities created and destroyed, the components added and removed and the components
+	 * modified since the last delta. Creations and removals are recorded from the engine signals. Modifications are
+	 * detected using the change ticks of the components (see Entity::getMut()), so nothing is compared and only
+	 * changed components are serialized. Entities created within a frame are written with all of their components.
+	 *
+	 * Components of types which are not registered in the ComponentRegistry are not replicated.
+	 */
+	class DeltaRecorder {
+	private:
+		Engine& engine;
+		const ComponentRegistry& registry;
+		Signal11::ConnectionScope scope;
+		uint32_t lastTick;
+
+		std::vector<uint64_t> created;
+		std::unordered_set<uint64_t> createdIds;
+		std::vector<uint64_t> destroyed;
+		/// The last component event of each entity and type: @a true if added, @a false if removed
+		std::map<uint64_t, std::vector<std::pair<ComponentType, bool>>> componentEvents;
+
+	public:
+		/**
+		 * Start recording the changes of an Engine. Both the engine and the registry must outlive the recorder.
+		 *
+		 * @param engine The Engine to record
+		 * @param registry The component types to replicate
+		 */
+		DeltaRecorder(Engine& engine, const ComponentRegistry& registry);
+		DeltaRecorder(const DeltaRecorder&) = delete;
+
+		/**
+		 * Write the changes since the last call (or since the recorder was created) and start recording the next delta.
+		 * Data is written in the native byte order.
+		 *
+		 * @param stream The stream to write to.
+		 * @return An empty string on success, otherwise an error message.
+		 * @throws std::logic_error when called during Engine::update().
+		 */
+		std::string writeDelta(std::ostream& stream);
+
+		/**
+		 * Apply a delta written by writeDelta() to an Engine containing the same entities as the recorded one did,
+		 * when the delta was started. Created entities keep their ids. Components are added and removed with the
+		 * usual signals and modified components are marked as changed.
+		 *
+		 * @param engine The Engine to apply the delta to
+		 * @param data The delta data
+		 * @param size The size of @a data in bytes
+		 * @param registry The component types. All types in the delta must be registered.
+		 * @return An empty string on success, otherwise an error message. The delta might have been partially applied.
+		 * @throws std::logic_error when called during Engine::update().
+		 */
+		static std::string applyDelta(Engine& engine, const char* data, size_t size, const ComponentRegistry& registry);
+
+	private:
+		void entityAdded(Entity* entity);
+		void entityRemoved(Entity* entity);
+		void componentAdded(Entity* entity, ComponentBase* component);
+		void componentRemoved(Entity* entity, ComponentBase* component);
+		void recordComponentEvent(Entity* entity, ComponentBase* component, bool added);
+		void clear();
+	};
+}
+
+#ifdef USING_ECSTASY
+	using ecstasy::DeltaRecorder;
+#endif
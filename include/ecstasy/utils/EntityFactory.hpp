@@ -15,14 +15,18 @@
  * limitations under the License.
  ******************************************************************************/
 
+#include <ecstasy/core/Types.hpp>
 #include <unordered_map>
 #include <string>
 #include <memory>
+#include <vector>
 
 namespace ecstasy {
 	class Entity;
 	class EntityBlueprint;
+	class ComponentBlueprint;
 	class ComponentFactory;
+	class BlueprintPack;
 
 	/**
 	 * A factory to create {@link Entity entities} from blueprints.
@@ -31,8 +35,31 @@ namespace ecstasy {
 	private:
 		std::unordered_map<std::string, std::unique_ptr<ComponentFactory>> componentFactories;
 		std::unordered_map<std::string, std::shared_ptr<EntityBlueprint>> entities;
+		std::vector<std::shared_ptr<BlueprintPack>> packs;
+
+		struct CompiledComponent {
+			ComponentFactory* factory;
+			ComponentBlueprint* blueprint;
+			std::shared_ptr<const void> data;
+		};
+		struct CompiledBlueprint {
+			std::string name;
+			std::shared_ptr<EntityBlueprint> blueprint;
+			uint32_t first = 0;
+			uint32_t count = 0;
+			bool valid = false;
+			bool hasComponentBits = false;
+			Bits componentBits;
+		};
+		std::vector<CompiledComponent> compiledComponents;
+		std::vector<CompiledBlueprint> compiledBlueprints;
+		std::unordered_map<std::string, BlueprintId> compiledIds;
+		bool needsRecompile = false;
 
 	public:
+		/// Returned by compile() if the blueprint could not be compiled.
+		static const BlueprintId INVALID_ID = 0xFFFFFFFF;
+
 		/// Default constructor
 		EntityFactory();
 		EntityFactory(const EntityFactory&) = delete;
@@ -48,6 +75,8 @@ namespace ecstasy {
 		template <typename T, typename ... Args>
 		void addComponentFactory(const std::string& name, Args && ... args) {
 			componentFactories[name] = std::make_unique<T>();
+			if (!compiledBlueprints.empty())
+				needsRecompile = true;
 		}
 
 		/**
@@ -56,6 +85,19 @@ namespace ecstasy {
 		 */
 		void addEntityBlueprint(const std::string& name, std::shared_ptr<EntityBlueprint> blueprint){
 			entities[name] = blueprint;
+			if (compiledIds.count(name))
+				needsRecompile = true;
+		}
+
+		/**
+		 * Add a pack of blueprints. A blueprint is read from the pack when it is used for the first time.
+		 * Blueprints added using addEntityBlueprint() take precedence, then the packs are searched in the order they
+		 * have been added.
+		 *
+		 * @param pack an opened BlueprintPack
+		 */
+		void addBlueprintPack(std::shared_ptr<BlueprintPack> pack) {
+			packs.push_back(pack);
 		}
 
 		/**
@@ -66,6 +108,42 @@ namespace ecstasy {
 		 * @return @a true on success.
 		 */
 		bool assemble(Entity* entity, const std::string& blueprintname);
+
+		/**
+		 * Resolve the component factories of a blueprint and let them parse the blueprint values, so the blueprint
+		 * can be assembled without looking up strings. Compiling the same blueprint again returns the same id.
+		 * Adding factories or replacing the blueprint later on compiles it again (once, on the next call to compile()
+		 * or assemble()), the id stays valid.
+		 *
+		 * @param blueprintname the name used to identify the EntityBlueprint
+		 * @return The id to pass to assemble() or INVALID_ID if the blueprint or one of its factories is missing.
+		 */
+		BlueprintId compile(const std::string& blueprintname);
+
+		/**
+		 * Add all {@link Component}s of a compiled blueprint to the supplied entity.
+		 *
+		 * @param entity the entity to add the {@link Component}s to.
+		 * @param id the id returned by compile()
+		 * @return @a true on success.
+		 */
+		bool assemble(Entity* entity, BlueprintId id);
+
+		/**
+		 * The component bits of a compiled blueprint. Since the factories decide which components they add,
+		 * these are recorded on the first successful assembly of an Entity without components.
+		 *
+		 * @param id the id returned by compile()
+		 * @return The component bits or @a nullptr if they are not known yet (or the blueprint needs to be compiled again).
+		 */
+		const Bits* getComponentBits(BlueprintId id) const;
+
+	private:
+		std::shared_ptr<EntityBlueprint> findBlueprint(const std::string& blueprintname);
+
+		bool compileBlueprint(CompiledBlueprint& compiled);
+
+		void recompile();
 	};
 }
 
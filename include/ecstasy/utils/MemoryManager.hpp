@@ -18,6 +18,30 @@
 #include <stdint.h>
 
 namespace ecstasy {
+	/// Statistics about the memory of a MemoryManager. Values not supported by a MemoryManager are 0.
+	struct MemoryStats {
+		/// The number of bytes reserved from the system, including unused memory.
+		uint64_t reservedBytes = 0;
+		/// The number of bytes currently handed out. Each allocation counts with its full unit size, i.e. the requested
+		/// size plus bookkeeping data, rounded up to the alignment.
+		uint64_t usedBytes = 0;
+		/// The highest value of usedBytes so far.
+		uint64_t peakUsedBytes = 0;
+		/// The number of bytes, which would be given back to the system by reduceMemory().
+		uint64_t reclaimableBytes = 0;
+		/// The number of allocations currently in use.
+		uint32_t allocationCount = 0;
+		/// The total number of allocations made so far.
+		uint64_t totalAllocations = 0;
+		/// The total number of frees made so far.
+		uint64_t totalFrees = 0;
+
+		/// @return The share of reserved memory, which is not in use (0 to 1).
+		float getFragmentation() const {
+			return reservedBytes ? 1.0f - static_cast<float>(usedBytes) / reservedBytes : 0.0f;
+		}
+	};
+
 	/**
 	 * Memory manager interface. Used to allocate entities, components and helper structures for delayed operations.
 	 */
@@ -45,7 +69,92 @@ namespace ecstasy {
 		/// Try to reduce the memory footprint if possible.
 		virtual void reduceMemory() = 0;
 
+		/**
+		 * Prepare memory for upcoming allocations, so they don't need to request memory from the system.
+		 * Reserved memory, which is not in use, may be released again by reduceMemory().
+		 * The default implementation does nothing.
+		 *
+		 * @param size The size of memory (in bytes) to be allocated
+		 * @param align The align of the memory (in bytes)
+		 * @param count The number of allocations to prepare for
+		 */
+		virtual void reserve(uint32_t size, uint32_t align, uint32_t count) {}
+
+		/**
+		 * Allocate memory, which will never be relocated by a compaction. The Engine uses this for its entities.
+		 * The default implementation calls allocate().
+		 *
+		 * @param size The size of memory (in bytes) to allocate
+		 * @param align The align of the memory (in bytes)
+		 * @return A pointer to the allocated memory.
+		 * @throws std::bad_alloc when the allocation could not be made.
+		 */
+		virtual void* allocatePinned(uint32_t size, uint32_t align) {
+			return allocate(size, align);
+		}
+
+		/**
+		 * Free memory allocated by allocatePinned(). The default implementation calls free().
+		 *
+		 * @param size The <b>same size</b>, which was used to allocatePinned() the memory.
+		 * @param align The align of the memory (in bytes)
+		 * @param memory The memory to be freed.
+		 */
+		virtual void freePinned(uint32_t size, uint32_t align, void* memory) {
+			free(size, align, memory);
+		}
+
+		/**
+		 * Like reserve(), but for upcoming calls to allocatePinned(). The default implementation calls reserve().
+		 *
+		 * @param size The size of memory (in bytes) to be allocated
+		 * @param align The align of the memory (in bytes)
+		 * @param count The number of allocations to prepare for
+		 */
+		virtual void reservePinned(uint32_t size, uint32_t align, uint32_t count) {
+			reserve(size, align, count);
+		}
+
 		/// @return The number of allocations currently in use.
 		virtual uint32_t getAllocationCount() const = 0;
+
+		/**
+		 * Start an incremental compaction (see Engine::compactMemory()). Select sparsely used memory to be evacuated.
+		 * Memory from allocatePinned() must not be selected.
+		 * New allocations must not be served from that memory until endCompaction() is called.
+		 * The default implementation does not support compaction.
+		 *
+		 * @return The number of allocations, which should be relocated.
+		 */
+		virtual uint32_t beginCompaction() {
+			return 0;
+		}
+
+		/**
+		 * Check if an allocation should be relocated during compaction.
+		 *
+		 * @param size The size used to allocate the memory.
+		 * @param align The align used to allocate the memory.
+		 * @param memory The memory to check.
+		 * @return @a true if the memory should be moved to a new allocation and freed.
+		 */
+		virtual bool isEvacuating(uint32_t size, uint32_t align, void* memory) const {
+			return false;
+		}
+
+		/// Finish a compaction started with beginCompaction(). Memory, which could not be evacuated will be reused.
+		virtual void endCompaction() {}
+
+		/**
+		 * Override this to provide more detailed statistics.
+		 * The default implementation only fills MemoryStats::allocationCount.
+		 *
+		 * @return Statistics about the memory managed.
+		 */
+		virtual MemoryStats getStats() const {
+			MemoryStats stats;
+			stats.allocationCount = getAllocationCount();
+			return stats;
+		}
 	};
 }
@@ -0,0 +1,114 @@
+#pragma once
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ecstasy {
+	/**
+	 * Converts a sort key into an unsigned integer, which has the same order as the original key.
+	 * Specializations exist for integral and floating point types.
+	 *
+	 * @tparam K The key type
+	 */
+	template<typename K, typename Enable = void>
+	struct RadixKey;
+
+/// \cond HIDDEN_SYMBOLS
+	template<typename K>
+	struct RadixKey<K, typename std::enable_if<std::is_integral<K>::value && std::is_unsigned<K>::value>::type> {
+		typedef typename std::conditional<(sizeof(K) > 4), uint64_t, uint32_t>::type type;
+		static type get(K key) { return static_cast<type>(key); }
+	};
+
+	template<typename K>
+	struct RadixKey<K, typename std::enable_if<std::is_integral<K>::value && std::is_signed<K>::value>::type> {
+		typedef typename std::conditional<(sizeof(K) > 4), uint64_t, uint32_t>::type type;
+		typedef typename std::conditional<(sizeof(K) > 4), int64_t, int32_t>::type signed_type;
+		static type get(K key) {
+			// Flipping the sign bit moves negative values in front of positive values
+			return static_cast<type>(static_cast<signed_type>(key)) ^ (type(1) << (sizeof(type) * 8 - 1));
+		}
+	};
+
+	template<>
+	struct RadixKey<float> {
+		typedef uint32_t type;
+		static type get(float key) {
+			type bits;
+			memcpy(&bits, &key, sizeof(bits));
+			// Negative values need all bits flipped to reverse their order, positive ones only the sign bit
+			return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+		}
+	};
+
+	template<>
+	struct RadixKey<double> {
+		typedef uint64_t type;
+		static type get(double key) {
+			type bits;
+			memcpy(&bits, &key, sizeof(bits));
+			return (bits & 0x8000000000000000ull) ? ~bits : (bits | 0x8000000000000000ull);
+		}
+	};
+/// \endcond
+
+	/**
+	 * Stable LSD radix sort of key/value pairs using 8 bits per pass. Passes in which all keys share the same
+	 * digit are skipped.
+	 *
+	 * @tparam U An unsigned integer key type (see RadixKey)
+	 * @tparam V The value type
+	 * @param items The items to sort
+	 * @param buffer A temporary buffer. Keep it around between calls to avoid allocations.
+	 */
+	template<typename U, typename V>
+	void radixSort(std::vector<std::pair<U, V>>& items, std::vector<std::pair<U, V>>& buffer) {
+		static_assert(std::is_unsigned<U>::value, "radixSort requires an unsigned key type");
+		const size_t passes = sizeof(U);
+		const size_t size = items.size();
+		if (size < 2)
+			return;
+
+		// Build the histograms of all passes at once
+		size_t counts[passes][256];
+		memset(counts, 0, sizeof(counts));
+		for (auto& item : items) {
+			for (size_t pass = 0; pass < passes; pass++)
+				counts[pass][(item.first >> (pass * 8)) & 0xFF]++;
+		}
+
+		buffer.resize(size);
+		for (size_t pass = 0; pass < passes; pass++) {
+			auto& count = counts[pass];
+			if (count[(items[0].first >> (pass * 8)) & 0xFF] == size)
+				continue;
+
+			size_t offset = 0;
+			for (size_t i = 0; i < 256; i++) {
+				size_t c = count[i];
+				count[i] = offset;
+				offset += c;
+			}
+			for (auto& item : items)
+				buffer[count[(item.first >> (pass * 8)) & 0xFF]++] = item;
+			items.swap(buffer);
+		}
+	}
+}
@@ -0,0 +1,116 @@
+#pragma once
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include <string>
+#include <cstring>
+#include <ostream>
+#include <stddef.h>
+
+namespace ecstasy {
+	/**
+	 * A non-owning view of a character sequence, like std::string_view in C++17.
+	 * The viewed characters must outlive the view.
+	 */
+	class StringView {
+	private:
+		const char* ptr;
+		size_t length;
+
+	public:
+		/// Passed as count to substr() to get the rest of the view.
+		static const size_t npos = static_cast<size_t>(-1);
+
+		/// Creates an empty view
+		StringView() : ptr(""), length(0) {}
+
+		/**
+		 * @param data The first character
+		 * @param length The number of characters
+		 */
+		StringView(const char* data, size_t length) : ptr(data), length(length) {}
+
+		/// @param str A null-terminated string
+		StringView(const char* str) : ptr(str), length(std::strlen(str)) {}
+
+		/// @param str The string to view
+		StringView(const std::string& str) : ptr(str.data()), length(str.size()) {}
+
+		/// @return The first character. The view is not necessarily null-terminated.
+		const char* data() const { return ptr; }
+
+		/// @return The number of characters
+		size_t size() const { return length; }
+
+		/// @return @a true if the view has no characters.
+		bool empty() const { return length == 0; }
+
+		const char* begin() const { return ptr; }
+		const char* end() const { return ptr + length; }
+
+		char operator[](size_t index) const { return ptr[index]; }
+
+		/**
+		 * @param pos The index of the first character
+		 * @param count The maximum number of characters or npos for the rest of the view.
+		 * @return A view of a part of this view.
+		 */
+		StringView substr(size_t pos, size_t count = npos) const {
+			if (pos > length)
+				pos = length;
+			if (count > length - pos)
+				count = length - pos;
+			return StringView(ptr + pos, count);
+		}
+
+		/**
+		 * Compare lexicographically.
+		 *
+		 * @param other The view to compare with
+		 * @return A negative value, 0 or a positive value, like std::string::compare().
+		 */
+		int compare(StringView other) const {
+			int result = std::memcmp(ptr, other.ptr, length < other.length ? length : other.length);
+			if (result != 0)
+				return result;
+			return length < other.length ? -1 : (length > other.length ? 1 : 0);
+		}
+
+		bool operator==(StringView other) const {
+			return length == other.length && std::memcmp(ptr, other.ptr, length) == 0;
+		}
+
+		bool operator!=(StringView other) const {
+			return !(*this == other);
+		}
+
+		bool operator<(StringView other) const {
+			return compare(other) < 0;
+		}
+
+		/// @return A copy of the characters
+		std::string toString() const {
+			return std::string(ptr, length);
+		}
+	};
+
+	inline std::ostream& operator<<(std::ostream& stream, StringView view) {
+		return stream.write(view.data(), view.size());
+	}
+}
+
+#ifdef USING_ECSTASY
+	using ecstasy::StringView;
+#endif
@@ -14,6 +14,7 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  ******************************************************************************/
+#include <ecstasy/utils/StringView.hpp>
 #include <string>
 #include <vector>
 
@@ -28,4 +29,65 @@ namespace ecstasy {
 	 * @return The number of tokens added. the value is negative, if a double-quote has not been closed.
 	 */
 	int parseTokens(const std::string& line, std::vector<std::string>& tokens, char commentChar='#');
+
+	/**
+	 * Like parseTokens(const std::string&, std::vector<std::string>&, char), but without copying the tokens.
+	 * The tokens are views into the line. Only tokens containing escape sequences are unescaped into the buffer,
+	 * which is cleared first. The tokens stay valid as long as the line and the buffer are not modified.
+	 *
+	 * @param line the text to parse (multiline is not supported right now)
+	 * @param tokens the result vector to store the tokens in.
+	 * @param buffer storage for unescaped tokens.
+	 * @param commentChar the character starting a single-line comment. Use '\0' to disable comment support.
+	 * @return The number of tokens added. the value is negative, if a double-quote has not been closed.
+	 */
+	int parseTokens(StringView line, std::vector<StringView>& tokens, std::string& buffer, char commentChar='#');
+
+	/**
+	 * Splits a text into lines and tokenizes them one by one using
+	 * parseTokens(StringView, std::vector<StringView>&, std::string&, char). Line breaks are '\n' or "\r\n".
+	 */
+	class LineTokenizer {
+	private:
+		StringView text;
+		size_t position = 0;
+		int lineNumber = 0;
+		int numTokens = 0;
+		char commentChar;
+		std::vector<StringView> tokens;
+		std::string buffer;
+
+	public:
+		/**
+		 * @param text the text to parse, which must outlive the tokenizer.
+		 * @param commentChar the character starting a single-line comment. Use '\0' to disable comment support.
+		 */
+		explicit LineTokenizer(StringView text, char commentChar='#') : text(text), commentChar(commentChar) {}
+
+		/**
+		 * Tokenize the next line. The tokens of the previous line become invalid.
+		 *
+		 * @return @a false if the end of the text has been reached.
+		 */
+		bool nextLine();
+
+		/// @return The tokens of the current line.
+		const std::vector<StringView>& getTokens() const {
+			return tokens;
+		}
+
+		/// @return The number of tokens in the current line. The value is negative, if a double-quote has not been closed.
+		int getNumTokens() const {
+			return numTokens;
+		}
+
+		/// @return The number of the current line, starting at 1.
+		int getLineNumber() const {
+			return lineNumber;
+		}
+	};
 }
+
+#ifdef USING_ECSTASY
+	using ecstasy::LineTokenizer;
+#endif
@@ -0,0 +1,107 @@
+#pragma once
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <ostream>
+#include <string>
+
+namespace ecstasy {
+	/**
+	 * Records timed events into a fixed-size ring buffer and writes them in the Chrome trace event format,
+	 * which can be viewed in chrome://tracing or Perfetto. Recording does not lock or allocate and may be done from
+	 * multiple threads. When the buffer is full, the oldest events are overwritten. If a thread wraps around the buffer
+	 * while another one is still writing to the same slot, one of the two events is dropped.
+	 *
+	 * Set it on an Engine using Engine::setTraceRecorder() to record system updates, delayed operations,
+	 * family registrations and reduceMemory() calls.
+	 */
+	class TraceRecorder {
+	public:
+		/// Used for id and value if not set.
+		static const uint32_t NONE = 0xFFFFFFFF;
+
+	private:
+		/// A slot of the ring buffer, guarded by its sequence: 0 when empty, odd while being written.
+		struct Event {
+			std::atomic<uint64_t> sequence;
+			std::atomic<const char*> name;
+			std::atomic<const char*> category;
+			std::atomic<uint64_t> start;
+			std::atomic<uint64_t> duration;
+			std::atomic<uint32_t> id;
+			std::atomic<uint32_t> value;
+			std::atomic<uint32_t> thread;
+		};
+
+		std::unique_ptr<Event[]> events;
+		uint64_t mask;
+		std::atomic<uint64_t> head;
+		std::chrono::steady_clock::time_point epoch;
+
+	public:
+		/**
+		 * @param capacity The number of events to keep. Will be rounded up to a power of two.
+		 */
+		explicit TraceRecorder(uint32_t capacity = 65536);
+		TraceRecorder(const TraceRecorder&) = delete;
+
+		/// @return The time in microseconds since this recorder was created.
+		uint64_t now() const {
+			return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - epoch).count();
+		}
+
+		/**
+		 * Record an event.
+		 *
+		 * @param name The name of the event. Must stay valid until the trace has been written (use string literals).
+		 * @param category The category of the event. Must stay valid until the trace has been written.
+		 * @param start The start time in microseconds, see now().
+		 * @param duration The duration in microseconds.
+		 * @param id An id appended to the name (e.g. the SystemType) or NONE.
+		 * @param value A value to show as argument (e.g. the number of operations) or NONE.
+		 */
+		void record(const char* name, const char* category, uint64_t start, uint64_t duration,
+			uint32_t id = NONE, uint32_t value = NONE);
+
+		/// @return The number of events currently stored.
+		uint64_t getEventCount() const;
+
+		/// Remove all events. Must not be called while recording.
+		void clear();
+
+		/**
+		 * Write all stored events as a JSON trace.
+		 *
+		 * @param stream The stream to write to
+		 */
+		void write(std::ostream& stream) const;
+
+		/**
+		 * Write all stored events as a JSON trace to a file.
+		 *
+		 * @param filename The file to write to
+		 * @return @a true on success
+		 */
+		bool save(const std::string& filename) const;
+	};
+}
+
+#ifdef USING_ECSTASY
+	using ecstasy::TraceRecorder;
+#endif
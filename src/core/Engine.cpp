@@ -18,6 +18,14 @@
 #include <ecstasy/core/EntitySystem.hpp>
 #include <ecstasy/utils/EntityFactory.hpp>
 #include <ecstasy/utils/DefaultMemoryManager.hpp>
+#include <ecstasy/utils/ComponentRegistry.hpp>
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <istream>
+#include <ostream>
+#include <unordered_set>
 
 namespace ecstasy {
 	bool compareSystems(std::shared_ptr<EntitySystemBase>& a, std::shared_ptr<EntitySystemBase>& b) {
@@ -81,12 +89,168 @@ namespace ecstasy {
 			entityOperationHandler.removeAll();
 		}
 		else {
+			// Removing from the back keeps the erase cheap, as the entity is found at the end of every list
 			while(!entities.empty()) {
-				removeEntity(entities.front());
+				removeEntity(entities.back());
 			}
 		}
 	}
 
+	namespace {
+		/// The families matching a set of components
+		struct FamilyMatches {
+			const Bits* componentBits;
+			std::vector<std::pair<const Family*, std::vector<Entity*>*>> families;
+		};
+	}
+
+	void Engine::addEntities(const std::vector<Entity*>& newEntities) {
+		for (auto entity : newEntities) {
+			if (entity->uuid != 0) throw std::invalid_argument("Entity already added to an engine");
+		}
+		if (updating || notifying) {
+			for (auto entity : newEntities)
+				addEntity(entity);
+			return;
+		}
+
+		for (auto entity : newEntities)
+			entity->uuid = obtainEntityId();
+		addEntitiesInternal(newEntities);
+	}
+
+	void Engine::addEntitiesInternal(const std::vector<Entity*>& newEntities) {
+		uint64_t traceStart = traceRecorder ? traceRecorder->now() : 0;
+		entities.reserve(entities.size() + newEntities.size());
+		entitiesById.reserve(entitiesById.size() + newEntities.size());
+
+		// Entities with the same components belong to the same families, so each combination is matched only once
+		std::vector<FamilyMatches> matches;
+		std::vector<uint32_t> matchIndices;
+		matchIndices.reserve(newEntities.size());
+		for (auto entity : newEntities) {
+			entities.push_back(entity);
+			entitiesById.emplace(entity->getId(), entity);
+
+			uint32_t index = 0;
+			while (index < matches.size() && *matches[index].componentBits != entity->componentBits)
+				index++;
+			if (index == matches.size()) {
+				matches.push_back(FamilyMatches{ &entity->componentBits, {} });
+				for (auto& entry : entitiesByFamily) {
+					if (entry.first->matches(entity))
+						matches.back().families.emplace_back(entry.first, &entry.second);
+				}
+			}
+			matchIndices.push_back(index);
+
+			for (auto& family : matches[index].families) {
+				family.second->push_back(entity);
+				entity->familyBits.set(family.first->index);
+			}
+			entity->componentOperationHandler = &componentOperationHandler;
+		}
+
+		for (size_t i = 0; i < newEntities.size(); i++) {
+			auto entity = newEntities[i];
+			// Listeners of previous entities might have changed the components of this one already
+			for (auto& family : matches[matchIndices[i]].families) {
+				if (entity->familyBits.get(family.first->index))
+					notifyFamilyListenersAdd(*family.first, entity);
+			}
+
+			notifying = true;
+			countSignal();
+			entityAdded.emit(entity);
+			notifying = false;
+		}
+
+		if (traceRecorder)
+			traceRecorder->record("addEntities", "engine", traceStart, traceRecorder->now() - traceStart,
+				TraceRecorder::NONE, static_cast<uint32_t>(newEntities.size()));
+	}
+
+	void Engine::removeEntities(const std::vector<Entity*>& oldEntities) {
+		if (updating || notifying) {
+			for (auto entity : oldEntities)
+				removeEntity(entity);
+			return;
+		}
+
+		for (auto entity : oldEntities) {
+			if (entity->getId() != 0) {
+				auto it = entitiesById.find(entity->getId());
+				if (it == entitiesById.end() || it->second != entity)
+					throw std::invalid_argument("Entity does not belong to this engine");
+			}
+		}
+
+		uint64_t traceStart = traceRecorder ? traceRecorder->now() : 0;
+		std::vector<Entity*> removed;
+		removed.reserve(oldEntities.size());
+		for (auto entity : oldEntities) {
+			// id == 0 means the entity has not been added to the engine yet
+			if (entity->getId() == 0) {
+				if (entity->engine == this) {
+					entity->~Entity();
+					memoryManager->freePinned(sizeof(Entity), alignof(Entity), entity);
+				}
+			} else if (!entity->scheduledForRemoval) {
+				entity->scheduledForRemoval = true;
+				entitiesById.erase(entity->getId());
+				removed.push_back(entity);
+			}
+		}
+		if (removed.empty())
+			return;
+
+		// Entities queued for removal by listeners are handled by the operation handler, so only match this batch
+		std::unordered_set<Entity*> removedSet(removed.begin(), removed.end());
+		auto isRemoved = [&removedSet](Entity* entity) {
+			return removedSet.count(entity) != 0;
+		};
+		entities.erase(std::remove_if(entities.begin(), entities.end(), isRemoved), entities.end());
+		for (auto& entry : entitiesByFamily) {
+			auto familyIndex = entry.first->index;
+			bool affected = std::any_of(removed.begin(), removed.end(), [familyIndex](Entity* entity) {
+				return entity->familyBits.get(familyIndex);
+			});
+			if (affected) {
+				auto& familyEntities = entry.second;
+				familyEntities.erase(std::remove_if(familyEntities.begin(), familyEntities.end(), isRemoved),
+					familyEntities.end());
+			}
+		}
+
+		for (auto entity : removed) {
+			if (!entity->getFamilyBits().isEmpty()) {
+				for (auto& entry : entitiesByFamily) {
+					auto family = entry.first;
+					if (entity->familyBits.get(family->index)) {
+						entity->familyBits.clear(family->index);
+						notifyFamilyListenersRemove(*family, entity);
+					}
+				}
+			}
+
+			entity->componentOperationHandler = nullptr;
+
+			notifying = true;
+			countSignal();
+			entityRemoved.emit(entity);
+			notifying = false;
+		}
+
+		for (auto entity : removed) {
+			entity->~Entity();
+			memoryManager->freePinned(sizeof(Entity), alignof(Entity), entity);
+		}
+
+		if (traceRecorder)
+			traceRecorder->record("removeEntities", "engine", traceStart, traceRecorder->now() - traceStart,
+				TraceRecorder::NONE, static_cast<uint32_t>(removed.size()));
+	}
+
 	Entity* Engine::getEntity(uint64_t id) const {
 		auto it = entitiesById.find(id);
 		if(it == entitiesById.end())
@@ -149,16 +313,83 @@ namespace ecstasy {
 	}
 
 	void Engine::update(float deltaTime){
+		typedef std::chrono::steady_clock clock;
 		updating = true;
+#ifdef ECSTASY_PROFILING
+		const bool measureAll = true;
+		auto memoryStart = memoryManager->getStats();
+#else
+		const bool measureAll = false;
+#endif
+		// The clock is only read if there is a budget to check or statistics to record
+		clock::time_point frameStart, frameEnd;
+		if (frameBudget > 0 || measureAll) {
+			frameStart = clock::now();
+			frameEnd = frameStart + std::chrono::duration_cast<clock::duration>(std::chrono::duration<float>(frameBudget));
+		}
+		auto recorder = traceRecorder.get();
+		uint64_t frameTraceStart = recorder ? recorder->now() : 0;
 		for(auto system: systems){
-			if (system->checkProcessing())
-				system->update(deltaTime);
-
-			componentOperationHandler.process();
-			entityOperationHandler.process();
+			bool updated = false;
+			if (system->checkProcessing()) {
+				float systemDeltaTime = deltaTime + system->deferredTime;
+				bool deferrable = frameBudget > 0 && system->priorityClass == PriorityClass::Deferrable;
+				bool measure = measureAll || frameBudget > 0 || system->timeBudget > 0;
+				clock::time_point start;
+				if (measure)
+					start = clock::now();
+				if (deferrable && start >= frameEnd) {
+					system->deferredTime = systemDeltaTime;
+				} else {
+					system->deferredTime = 0;
+					system->hasDeadline = deferrable || system->timeBudget > 0;
+					if (system->timeBudget > 0) {
+						system->deadline = start + std::chrono::duration_cast<clock::duration>(std::chrono::duration<float>(system->timeBudget));
+						if (deferrable && frameEnd < system->deadline)
+							system->deadline = frameEnd;
+					} else if (deferrable) {
+						system->deadline = frameEnd;
+					}
+
+#ifdef ECSTASY_PROFILING
+					system->processedEntities = 0;
+					signalEmissions = 0;
+#endif
+					uint64_t traceStart = recorder ? recorder->now() : 0;
+					system->update(systemDeltaTime);
+					system->hasDeadline = false;
+					if (measure)
+						system->lastUpdateTime = std::chrono::duration<float>(clock::now() - start).count();
+					updated = true;
+					if (recorder)
+						recorder->record("system", "system", traceStart, recorder->now() - traceStart, system->type);
+				}
+			}
+			changeTick++;
+
+			uint64_t traceStart = recorder ? recorder->now() : 0;
+			uint32_t operations = componentOperationHandler.process();
+			operations += entityOperationHandler.process();
+			if (recorder && operations)
+				recorder->record("operations", "engine", traceStart, recorder->now() - traceStart, TraceRecorder::NONE, operations);
+#ifdef ECSTASY_PROFILING
+			if (updated)
+				stats.addSystem(system->type, system->lastUpdateTime, system->processedEntities, operations, signalEmissions);
+#else
+			(void)updated;
+			(void)operations;
+#endif
 		}
 
 		updating = false;
+		if (recorder)
+			recorder->record("update", "engine", frameTraceStart, recorder->now() - frameTraceStart);
+#ifdef ECSTASY_PROFILING
+		auto memoryEnd = memoryManager->getStats();
+		stats.addFrame(std::chrono::duration<float>(clock::now() - frameStart).count(),
+			static_cast<uint32_t>(memoryEnd.totalAllocations - memoryStart.totalAllocations),
+			static_cast<uint32_t>(memoryEnd.totalFrees - memoryStart.totalFrees));
+#endif
 	}
 
 	void Engine::updateFamilyMembership(Entity* entity){
@@ -193,15 +424,16 @@ namespace ecstasy {
 		if (entity->getId() == 0) {
 			if (entity->engine == this) {
 				entity->~Entity();
-				memoryManager->free(sizeof(Entity), alignof(Entity), entity);
+				memoryManager->freePinned(sizeof(Entity), alignof(Entity), entity);
 			}
 			return;
 		}
 
-		auto it = std::find(entities.begin(), entities.end(), entity);
-		if(it == entities.end())
+		// Search from the back, since recently added entities are usually removed first (see removeAllEntities())
+		auto it = std::find(entities.rbegin(), entities.rend(), entity);
+		if(it == entities.rend())
 			throw std::invalid_argument("Entity does not belong to this engine");
-		entities.erase(it);
+		entities.erase(std::next(it).base());
 		entitiesById.erase(entitiesById.find(entity->getId()));
 
 		if(!entity->getFamilyBits().isEmpty()){
@@ -210,9 +442,9 @@ namespace ecstasy {
 				auto& familyEntities = it->second;
 
 				if(family->matches(entity)){
-					auto it2 = std::find(familyEntities.begin(), familyEntities.end(), entity);
-					if(it2 != familyEntities.end())
-						familyEntities.erase(it2);
+					auto it2 = std::find(familyEntities.rbegin(), familyEntities.rend(), entity);
+					if(it2 != familyEntities.rend())
+						familyEntities.erase(std::next(it2).base());
 
 					entity->familyBits.clear(family->index);
 					notifyFamilyListenersRemove(*family, entity);
@@ -223,11 +455,12 @@ namespace ecstasy {
 		entity->componentOperationHandler = nullptr;
 
 		notifying = true;
+		countSignal();
 		entityRemoved.emit(entity);
 		notifying = false;
 
 		entity->~Entity();
-		memoryManager->free(sizeof(Entity), alignof(Entity), entity);
+		memoryManager->freePinned(sizeof(Entity), alignof(Entity), entity);
 	}
 
 	void Engine::addEntityInternal(Entity* entity) {
@@ -239,6 +472,7 @@ namespace ecstasy {
 		entity->componentOperationHandler = &componentOperationHandler;
 
 		notifying = true;
+		countSignal();
 		entityAdded.emit(entity);
 		notifying = false;
 	}
@@ -248,6 +482,7 @@ namespace ecstasy {
 		if (it != entityAddedSignals.end()) {
 			auto& signal = it->second;
 			notifying = true;
+			countSignal();
 			signal.emit(entity);
 			notifying = false;
 		}
@@ -258,6 +493,7 @@ namespace ecstasy {
 		if (it != entityRemovedSignals.end()) {
 			auto& signal = it->second;
 			notifying = true;
+			countSignal();
 			signal.emit(entity);
 			notifying = false;
 		}
@@ -268,6 +504,7 @@ namespace ecstasy {
 		if (it != entitiesByFamily.end())
 			return &it->second;
 
+		uint64_t traceStart = traceRecorder ? traceRecorder->now() : 0;
 		auto& familyEntities = entitiesByFamily[&family];
 		for(auto e : entities){
 			if(family.matches(e)) {
@@ -275,14 +512,18 @@ namespace ecstasy {
 				e->familyBits.set(family.index);
 			}
 		}
+		if (traceRecorder)
+			traceRecorder->record("registerFamily", "engine", traceStart, traceRecorder->now() - traceStart,
+				family.index, static_cast<uint32_t>(familyEntities.size()));
 		return& familyEntities;
 	}
 
 	Entity* Engine::createEntity() {
-		auto memory = memoryManager->allocate(sizeof(Entity), alignof(Entity));
+		auto memory = memoryManager->allocatePinned(sizeof(Entity), alignof(Entity));
 		auto entity = new(memory)Entity();
 		entity->engine = this;
 		entity->memoryManager = memoryManager.get();
+		entity->changeTick = &changeTick;
 		return entity;
 	}
 
@@ -293,13 +534,387 @@ namespace ecstasy {
 		auto entity = createEntity();
 		if(!entityFactory->assemble(entity, blueprintname)) {
 			entity->~Entity();
-			memoryManager->free(sizeof(Entity), alignof(Entity), entity);
+			memoryManager->freePinned(sizeof(Entity), alignof(Entity), entity);
 			entity = nullptr;
 		}
 		return entity;
 	}
 
+	Entity* Engine::assembleEntity(BlueprintId id) {
+		if(!entityFactory)
+			return nullptr;
+
+		auto entity = createEntity();
+		if(!entityFactory->assemble(entity, id)) {
+			entity->~Entity();
+			memoryManager->freePinned(sizeof(Entity), alignof(Entity), entity);
+			entity = nullptr;
+		}
+		return entity;
+	}
+
+	std::vector<Entity*> Engine::createEntities(uint32_t count, const std::string& blueprintname) {
+		if (!entityFactory)
+			return std::vector<Entity*>();
+		return createEntities(count, entityFactory->compile(blueprintname));
+	}
+
+	std::vector<Entity*> Engine::createEntities(uint32_t count, BlueprintId id) {
+		std::vector<Entity*> result;
+		if (!entityFactory || count == 0)
+			return result;
+
+		result.reserve(count);
+		memoryManager->reservePinned(sizeof(Entity), alignof(Entity), count);
+		for (uint32_t i = 0; i < count; i++) {
+			auto entity = createEntity();
+			result.push_back(entity);
+			if (!entityFactory->assemble(entity, id)) {
+				for (auto e : result) {
+					e->~Entity();
+					memoryManager->freePinned(sizeof(Entity), alignof(Entity), e);
+				}
+				result.clear();
+				break;
+			}
+			// All entities get the same components, so reserve memory for the remaining ones
+			if (i == 0) {
+				for (auto component : entity->getAll())
+					memoryManager->reserve(component->memorySize, component->memoryAlign, count - 1);
+			}
+		}
+		return result;
+	}
+
+	std::vector<Entity*> Engine::instantiate(const Entity* prototype, uint32_t count) {
+		std::vector<Entity*> result;
+		if (count == 0)
+			return result;
+
+		result.reserve(count);
+		memoryManager->reservePinned(sizeof(Entity), alignof(Entity), count);
+		for (auto component : prototype->getAll())
+			memoryManager->reserve(component->memorySize, component->memoryAlign, count);
+
+		for (uint32_t i = 0; i < count; i++) {
+			auto entity = createEntity();
+			result.push_back(entity);
+			if (!entity->cloneComponents(*prototype)) {
+				// The entities were never added, so listeners must not hear about their components
+				discardEntities(result);
+				result.clear();
+				return result;
+			}
+		}
+		addEntities(result);
+		return result;
+	}
+
+	namespace {
+		const char SNAPSHOT_MAGIC[4] = { 'E', 'C', 'S', 'S' };
+		const uint32_t SNAPSHOT_VERSION = 1;
+		const uint32_t NO_INDEX = 0xFFFFFFFF;
+
+		struct SnapshotHeader {
+			char magic[4];
+			uint32_t version;
+			uint32_t typeCount;
+			uint32_t entityCount;
+			uint64_t nextEntityId;
+		};
+
+		/// Followed by nameLength bytes of the type name
+		struct SnapshotType {
+			uint32_t nameLength;
+			uint32_t componentCount;
+			uint32_t payloadBytes;
+		};
+
+		template<typename T>
+		void appendRaw(std::vector<char>& buffer, const T* values, size_t count) {
+			auto bytes = reinterpret_cast<const char*>(values);
+			buffer.insert(buffer.end(), bytes, bytes + count * sizeof(T));
+		}
+
+		class SnapshotReader {
+		public:
+			const char* position;
+			const char* end;
+
+			SnapshotReader(const char* position, const char* end) : position(position), end(end) {}
+
+			size_t remaining() const {
+				return static_cast<size_t>(end - position);
+			}
+
+			template<typename T>
+			bool read(T* values, size_t count) {
+				if (remaining() / sizeof(T) < count)
+					return false;
+				std::memcpy(values, position, count * sizeof(T));
+				position += count * sizeof(T);
+				return true;
+			}
+
+			template<typename T>
+			bool read(std::vector<T>& values, size_t count) {
+				if (remaining() / sizeof(T) < count)
+					return false;
+				values.resize(count);
+				return read(values.data(), count);
+			}
+		};
+	}
+
+	std::string Engine::saveSnapshot(std::ostream& stream, const ComponentRegistry& registry) const {
+		if (updating || notifying)
+			throw std::logic_error("saveSnapshot() must not be called during update()");
+
+		// Component types are numbered in the order they are first used
+		std::vector<uint32_t> localIndices;
+		std::vector<const ComponentRegistry::Entry*> types;
+		std::vector<std::vector<ComponentBase*>> componentsByLocalType;
+		for (auto entity : entities) {
+			for (auto component : entity->getAll()) {
+				auto type = component->type;
+				if (type >= localIndices.size())
+					localIndices.resize(type + 1, NO_INDEX);
+				if (localIndices[type] == NO_INDEX) {
+					auto entry = registry.get(type);
+					if (!entry)
+						return "Component type " + std::to_string(type) + " has not been registered";
+					localIndices[type] = static_cast<uint32_t>(types.size());
+					types.push_back(entry);
+					componentsByLocalType.emplace_back();
+				}
+				componentsByLocalType[localIndices[type]].push_back(component);
+			}
+		}
+
+		auto words = (types.size() + 31) / 32;
+		std::vector<uint64_t> ids;
+		std::vector<uint32_t> masks(entities.size() * words, 0);
+		ids.reserve(entities.size());
+		for (size_t i = 0; i < entities.size(); i++) {
+			ids.push_back(entities[i]->getId());
+			for (auto component : entities[i]->getAll()) {
+				auto index = localIndices[component->type];
+				masks[i * words + index / 32] |= 1u << (index % 32);
+			}
+		}
+
+		std::vector<std::vector<char>> payloads(types.size());
+		for (size_t i = 0; i < types.size(); i++) {
+			if (types[i]->fields) {
+				for (auto component : componentsByLocalType[i])
+					types[i]->fields->write(types[i]->data(component), payloads[i]);
+			}
+		}
+
+		std::vector<char> buffer;
+		SnapshotHeader header;
+		std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+		header.version = SNAPSHOT_VERSION;
+		header.typeCount = static_cast<uint32_t>(types.size());
+		header.entityCount = static_cast<uint32_t>(entities.size());
+		header.nextEntityId = nextEntityId;
+		appendRaw(buffer, &header, 1);
+		for (size_t i = 0; i < types.size(); i++) {
+			SnapshotType type;
+			type.nameLength = static_cast<uint32_t>(types[i]->name.size());
+			type.componentCount = static_cast<uint32_t>(componentsByLocalType[i].size());
+			type.payloadBytes = static_cast<uint32_t>(payloads[i].size());
+			appendRaw(buffer, &type, 1);
+			appendRaw(buffer, types[i]->name.data(), types[i]->name.size());
+		}
+		appendRaw(buffer, ids.data(), ids.size());
+		appendRaw(buffer, masks.data(), masks.size());
+		for (auto& payload : payloads)
+			appendRaw(buffer, payload.data(), payload.size());
+
+		stream.write(buffer.data(), buffer.size());
+		if (!stream)
+			return "Failed to write the snapshot";
+		return "";
+	}
+
+	std::string Engine::loadSnapshot(const char* data, size_t size, const ComponentRegistry& registry) {
+		if (updating || notifying)
+			throw std::logic_error("loadSnapshot() must not be called during update()");
+
+		SnapshotReader reader(data, data + size);
+		SnapshotHeader header;
+		if (!reader.read(&header, 1) || std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0)
+			return "Not a snapshot";
+		if (header.version != SNAPSHOT_VERSION)
+			return "Unsupported snapshot version " + std::to_string(header.version);
+
+		std::vector<SnapshotType> typeInfos(header.typeCount > reader.remaining() ? 0 : header.typeCount);
+		std::vector<const ComponentRegistry::Entry*> types;
+		for (auto& typeInfo : typeInfos) {
+			if (!reader.read(&typeInfo, 1) || reader.remaining() < typeInfo.nameLength)
+				return "Snapshot is truncated";
+			std::string name(reader.position, typeInfo.nameLength);
+			reader.position += typeInfo.nameLength;
+			auto entry = registry.find(name);
+			if (!entry)
+				return "Component type '" + name + "' has not been registered";
+			// An entity must not get two components of the same type
+			if (std::find(types.begin(), types.end(), entry) != types.end())
+				return "Component type '" + name + "' is listed twice";
+			types.push_back(entry);
+		}
+
+		auto words = (header.typeCount + 31) / 32;
+		std::vector<uint64_t> ids;
+		std::vector<uint32_t> masks;
+		if (types.size() != header.typeCount || !reader.read(ids, header.entityCount)
+			|| !reader.read(masks, static_cast<size_t>(header.entityCount) * words))
+			return "Snapshot is truncated";
+
+		// Validate everything but the payloads before creating anything
+		std::unordered_set<uint64_t> uniqueIds;
+		uniqueIds.reserve(ids.size());
+		auto maxId = nextEntityId;
+		for (auto id : ids) {
+			if (id == 0 || !uniqueIds.insert(id).second)
+				return "Invalid entity id " + std::to_string(id);
+			maxId = std::max(maxId, id + 1);
+		}
+		if (header.typeCount % 32) {
+			auto unusedBits = ~((1u << (header.typeCount % 32)) - 1);
+			for (uint32_t i = 0; i < header.entityCount; i++) {
+				if (masks[i * words + words - 1] & unusedBits)
+					return "Invalid component mask of entity " + std::to_string(ids[i]);
+			}
+		}
+		size_t payloadBytes = 0;
+		for (uint32_t t = 0; t < header.typeCount; t++) {
+			uint32_t count = 0;
+			for (uint32_t i = 0; i < header.entityCount; i++)
+				count += (masks[i * words + t / 32] >> (t % 32)) & 1;
+			if (count != typeInfos[t].componentCount)
+				return "Component count of '" + types[t]->name + "' does not match the entities";
+			payloadBytes += typeInfos[t].payloadBytes;
+		}
+		if (reader.remaining() != payloadBytes)
+			return "Snapshot has an unexpected size";
+
+		memoryManager->reservePinned(sizeof(Entity), alignof(Entity), header.entityCount);
+		std::vector<Entity*> restored;
+		restored.reserve(header.entityCount);
+		for (auto id : ids) {
+			auto entity = createEntity();
+			entity->uuid = id;
+			restored.push_back(entity);
+		}
+
+		std::string error;
+		for (uint32_t t = 0; t < header.typeCount && error.empty(); t++) {
+			auto entry = types[t];
+			SnapshotReader payload(reader.position, reader.position + typeInfos[t].payloadBytes);
+			reader.position = payload.end;
+			memoryManager->reserve(entry->memorySize, entry->memoryAlign, typeInfos[t].componentCount);
+			for (uint32_t i = 0; i < header.entityCount; i++) {
+				if (!((masks[i * words + t / 32] >> (t % 32)) & 1))
+					continue;
+				auto component = entry->create(memoryManager->allocate(entry->memorySize, entry->memoryAlign));
+				restored[i]->attachInternal(component);
+				if (entry->fields && !entry->fields->read(entry->data(component), payload.position, payload.end)) {
+					error = "Component data of '" + entry->name + "' is truncated";
+					break;
+				}
+			}
+			if (error.empty() && payload.remaining())
+				error = "Component data of '" + entry->name + "' has an unexpected size";
+		}
+		if (!error.empty()) {
+			discardEntities(restored);
+			return error;
+		}
+
+		removeAllEntities();
+		nextEntityId = std::max(maxId, header.nextEntityId);
+		addEntitiesInternal(restored);
+		return "";
+	}
+
+	void Engine::discardEntities(const std::vector<Entity*>& newEntities) {
+		for (auto entity : newEntities) {
+			entity->destroyComponentsInternal();
+			entity->uuid = 0;
+			entity->~Entity();
+			memoryManager->freePinned(sizeof(Entity), alignof(Entity), entity);
+		}
+	}
+
+	std::string Engine::loadSnapshot(std::istream& stream, const ComponentRegistry& registry) {
+		std::string data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+		return loadSnapshot(data.data(), data.size(), registry);
+	}
+
+	std::vector<ComponentMemoryStats> Engine::getComponentMemoryStats() const {
+		std::vector<ComponentMemoryStats> result;
+		for (auto entity : entities) {
+			for (auto component : entity->getAll()) {
+				if (component->type >= result.size())
+					result.resize(component->type + 1);
+				auto& stats = result[component->type];
+				stats.count++;
+				stats.bytes += component->memorySize;
+			}
+		}
+		return result;
+	}
+
+	void Engine::reserve(uint32_t entityCount) {
+		if (entityCount <= entities.size())
+			return;
+		memoryManager->reservePinned(sizeof(Entity), alignof(Entity), entityCount - static_cast<uint32_t>(entities.size()));
+		entities.reserve(entityCount);
+		entitiesById.reserve(entityCount);
+	}
+
+	bool Engine::compactMemory(float timeBudget) {
+		typedef std::chrono::steady_clock clock;
+		if (updating || notifying)
+			throw std::logic_error("compactMemory() must not be called during update()");
+
+		uint64_t traceStart = traceRecorder ? traceRecorder->now() : 0;
+		auto deadline = clock::now() + std::chrono::duration_cast<clock::duration>(std::chrono::duration<float>(timeBudget));
+		if (!compacting) {
+			// Entities are referenced by pointer everywhere, so they are allocated pinned and never relocated
+			if (!memoryManager->beginCompaction()) {
+				reduceMemory();
+				return true;
+			}
+			compacting = true;
+			compactionIndex = 0;
+		}
+
+		uint32_t relocated = 0;
+		auto start = compactionIndex;
+		for (; compactionIndex < entities.size(); compactionIndex++) {
+			if (timeBudget > 0 && (compactionIndex & 63) == 0 && compactionIndex != start && clock::now() >= deadline)
+				break;
+			relocated += entities[compactionIndex]->relocateComponents();
+		}
+		if (traceRecorder)
+			traceRecorder->record("compactMemory", "memory", traceStart, traceRecorder->now() - traceStart,
+				TraceRecorder::NONE, relocated);
+
+		if (compactionIndex < entities.size())
+			return false;
+		memoryManager->endCompaction();
+		compacting = false;
+		reduceMemory();
+		return true;
+	}
+
 	void Engine::reduceMemory() {
+		uint64_t traceStart = traceRecorder ? traceRecorder->now() : 0;
 		memoryManager->reduceMemory();
+		if (traceRecorder)
+			traceRecorder->record("reduceMemory", "memory", traceStart, traceRecorder->now() - traceStart);
 	}
 }
\ No newline at end of file
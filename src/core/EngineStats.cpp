@@ -0,0 +1,98 @@
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include <ecstasy/core/EngineStats.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace ecstasy {
+	void RollingStats::add(float value) {
+		if (samples.size() < capacity) {
+			samples.push_back(value);
+		} else if (capacity) {
+			samples[next] = value;
+			next = (next + 1) % capacity;
+		}
+	}
+
+	void RollingStats::clear() {
+		samples.clear();
+		next = 0;
+	}
+
+	float RollingStats::getLast() const {
+		if (samples.empty())
+			return 0;
+		if (samples.size() < capacity || next == 0)
+			return samples.back();
+		return samples[next - 1];
+	}
+
+	float RollingStats::getMin() const {
+		if (samples.empty())
+			return 0;
+		return *std::min_element(samples.begin(), samples.end());
+	}
+
+	float RollingStats::getMax() const {
+		if (samples.empty())
+			return 0;
+		return *std::max_element(samples.begin(), samples.end());
+	}
+
+	float RollingStats::getAvg() const {
+		if (samples.empty())
+			return 0;
+		double sum = 0;
+		for (auto sample : samples)
+			sum += sample;
+		return static_cast<float>(sum / samples.size());
+	}
+
+	float RollingStats::getPercentile(float percentile) const {
+		if (samples.empty())
+			return 0;
+		auto sorted = samples;
+		auto rank = static_cast<size_t>(std::ceil(percentile / 100.0f * sorted.size()));
+		auto index = rank > 0 ? std::min(rank - 1, sorted.size() - 1) : 0;
+		std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+		return sorted[index];
+	}
+
+	void EngineStats::clear() {
+		frameTime.clear();
+		frameAllocations.clear();
+		frameFrees.clear();
+		systemsByType.clear();
+	}
+
+	void EngineStats::addFrame(float time, uint32_t allocations, uint32_t frees) {
+		frameTime.add(time);
+		frameAllocations.add(static_cast<float>(allocations));
+		frameFrees.add(static_cast<float>(frees));
+	}
+
+	void EngineStats::addSystem(SystemType type, float time, uint32_t entities, uint32_t operations, uint32_t signals) {
+		if (type >= systemsByType.size())
+			systemsByType.resize(type + 1);
+		auto& stats = systemsByType[type];
+		if (!stats)
+			stats.reset(new SystemStats(capacity));
+		stats->time.add(time);
+		stats->entities.add(static_cast<float>(entities));
+		stats->operations.add(static_cast<float>(operations));
+		stats->signals.add(static_cast<float>(signals));
+	}
+}
@@ -18,6 +18,13 @@
 #include <ecstasy/core/Engine.hpp>
 
 namespace ecstasy {
+	namespace {
+		/// The memory of a component starts at its topmost class, which does not need to start with ComponentBase
+		void* getMemory(ComponentBase* component) {
+			return dynamic_cast<void*>(component);
+		}
+	}
+
 	void Entity::removeAll() {
 		if (componentOperationHandler != nullptr && componentOperationHandler->isActive())
 			componentOperationHandler->removeAll(this);
@@ -39,9 +46,11 @@ namespace ecstasy {
 
 		componentsByType[type] = component;
 		components.push_back(component);
+		component->changeTick = *changeTick;
 
 		componentBits.set(type);
 
+		engine->countSignal();
 		engine->componentAdded.emit(this, component);
 	}
 
@@ -53,14 +62,93 @@ namespace ecstasy {
 			components.erase(std::remove(components.begin(), components.end(), component), components.end());
 			componentBits.clear(type);
 
+			engine->countSignal();
 			engine->componentRemoved.emit(this, component);
 
+			auto size = component->memorySize;
+			auto align = component->memoryAlign;
+			auto memory = getMemory(component);
 			component->~ComponentBase();
-			memoryManager->free(component->memorySize, component->memoryAlign, component);
+			memoryManager->free(size, align, memory);
 		}
 		return component;
 	}
 
+	uint32_t Entity::relocateComponents() {
+		uint32_t relocated = 0;
+		for (auto& component : components) {
+			auto size = component->memorySize;
+			auto align = component->memoryAlign;
+			auto oldMemory = getMemory(component);
+			if (!memoryManager->isEvacuating(size, align, oldMemory))
+				continue;
+
+			auto memory = memoryManager->allocate(size, align);
+			auto newComponent = component->relocate(memory);
+			if (!newComponent) {
+				memoryManager->free(size, align, memory);
+				continue;
+			}
+			auto oldComponent = component;
+			component = newComponent;
+			componentsByType[newComponent->type] = newComponent;
+			oldComponent->~ComponentBase();
+			memoryManager->free(size, align, oldMemory);
+			relocated++;
+
+			engine->countSignal();
+			engine->componentRelocated.emit(this, newComponent);
+		}
+		return relocated;
+	}
+
+	bool Entity::cloneComponents(const Entity& prototype) {
+		components.reserve(prototype.components.size());
+		if (componentsByType.size() < prototype.componentsByType.size())
+			componentsByType.resize(prototype.componentsByType.size());
+
+		for (auto component : prototype.components) {
+			auto size = component->memorySize;
+			auto align = component->memoryAlign;
+			auto memory = memoryManager->allocate(size, align);
+			auto clone = component->clone(memory);
+			if (!clone) {
+				memoryManager->free(size, align, memory);
+				return false;
+			}
+			attachInternal(clone);
+		}
+		return true;
+	}
+
+	void Entity::attachInternal(ComponentBase* component) {
+		auto type = component->type;
+		if (type >= componentsByType.size())
+			componentsByType.resize(type + 1);
+		component->changeTick = *changeTick;
+		components.push_back(component);
+		componentsByType[type] = component;
+		componentBits.set(type);
+	}
+
+	void Entity::markChangedInternal(ComponentBase* component) {
+		component->changeTick = *changeTick;
+	}
+
+	void Entity::destroyComponentsInternal() {
+		// No signals, the entity has never been visible to the engine
+		for (auto component : components) {
+			auto size = component->memorySize;
+			auto align = component->memoryAlign;
+			auto memory = getMemory(component);
+			component->~ComponentBase();
+			memoryManager->free(size, align, memory);
+		}
+		components.clear();
+		componentsByType.clear();
+		componentBits.clear();
+	}
+
 	void Entity::removeAllInternal() {
 		while (!components.empty())
 			removeInternal(components.front()->type);
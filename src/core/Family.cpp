@@ -26,7 +26,7 @@ namespace ecstasy {
 		ss << prefix << bits->getStringId() << ";";
 	}
 
-	static std::string getFamilyHash(Bits* all, Bits* one, Bits* exclude) {
+	static std::string getFamilyHash(Bits* all, Bits* one, Bits* exclude, Bits* changed) {
 		std::ostringstream ss;
 		if (!all->isEmpty())
 			addBitsString(ss, "a:", all);
@@ -34,6 +34,8 @@ namespace ecstasy {
 			addBitsString(ss, "o:", one);
 		if (!exclude->isEmpty())
 			addBitsString(ss, "e:", exclude);
+		if (!changed->isEmpty())
+			addBitsString(ss, "c:", changed);
 		return ss.str();
 	}
 
@@ -41,34 +43,44 @@ namespace ecstasy {
 		delete m_all;
 		delete m_one;
 		delete m_exclude;
+		delete m_changed;
 	}
 
 	FamilyBuilder& FamilyBuilder::reset () {
 		m_all->clear();
 		m_one->clear();
 		m_exclude->clear();
+		m_changed->clear();
 		return* this;
 	}
 
 	const Family& FamilyBuilder::get () {
-		auto hash = getFamilyHash(m_all, m_one, m_exclude);
+		auto hash = getFamilyHash(m_all, m_one, m_exclude, m_changed);
 		auto it = families.find(hash);
 		if(it != families.end())
 			return *it->second.get();
-		auto family = new Family(m_all, m_one, m_exclude);
+		auto family = new Family(m_all, m_one, m_exclude, m_changed);
 		families.emplace(hash, std::shared_ptr<Family>(family));
 		m_all = new Bits();
 		m_one = new Bits();
 		m_exclude = new Bits();
+		m_changed = new Bits();
 		return *family;
 	}
 
 	FamilyBuilder Family::builder;
 
+	Family::Family(Bits* all, Bits* one, Bits* exclude, Bits* changed)
+		: m_all(all), m_one(one), m_exclude(exclude), m_changed(changed), index(getUniqueTypeId<FamilyType>()) {
+		for (int32_t i = changed->nextSetBit(0); i >= 0; i = changed->nextSetBit(i + 1))
+			changedTypes.emplace_back(static_cast<uint32_t>(i));
+	}
+
 	Family::~Family() {
 		delete m_all;
 		delete m_one;
 		delete m_exclude;
+		delete m_changed;
 	}
 
 	bool Family::matches(Entity* entity) const {
@@ -85,4 +97,14 @@ namespace ecstasy {
 
 		return true;
 	}
+
+	bool Family::changedSince(Entity* entity, uint32_t tick) const {
+		if (changedTypes.empty())
+			return true;
+		for (auto type : changedTypes) {
+			if (entity->hasChangedSince(type, tick))
+				return true;
+		}
+		return false;
+	}
 }
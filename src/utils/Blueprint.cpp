@@ -14,53 +14,123 @@
  * limitations under the License.
  ******************************************************************************/
 #include <ecstasy/utils/Blueprint.hpp>
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
 
 namespace ecstasy {
+	namespace {
+		struct KeyRegistry {
+			std::mutex mutex;
+			std::unordered_map<std::string, BlueprintKey> keys;
+			// A deque never moves its elements, so the names can be returned by reference
+			std::deque<std::string> names;
+		};
+
+		KeyRegistry& getKeyRegistry() {
+			static KeyRegistry registry;
+			return registry;
+		}
+	}
+
+	const BlueprintKey ComponentBlueprint::INVALID_KEY;
+
+	BlueprintKey ComponentBlueprint::getKey(const std::string& name) {
+		auto& registry = getKeyRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		auto it = registry.keys.find(name);
+		if (it != registry.keys.end())
+			return it->second;
+		auto key = static_cast<BlueprintKey>(registry.names.size());
+		registry.names.push_back(name);
+		registry.keys.emplace(name, key);
+		return key;
+	}
+
+	BlueprintKey ComponentBlueprint::findKey(const std::string& name) {
+		auto& registry = getKeyRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		auto it = registry.keys.find(name);
+		return it == registry.keys.end() ? INVALID_KEY : it->second;
+	}
+
+	const std::string& ComponentBlueprint::getKeyName(BlueprintKey key) {
+		auto& registry = getKeyRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		return registry.names.at(key);
+	}
+
+	ComponentBlueprint::Value& ComponentBlueprint::insert(BlueprintKey key) {
+		auto it = std::lower_bound(values.begin(), values.end(), key,
+			[](const Value& value, BlueprintKey key) { return value.key < key; });
+		if (it == values.end() || it->key != key) {
+			it = values.insert(it, Value());
+			it->key = key;
+			it->keyName = &getKeyName(key);
+		}
+		return *it;
+	}
+
 	void ComponentBlueprint::set(const std::string& key, const std::string& value) {
-		values[key] = value;
+		set(getKey(key), value);
 	}
 
-	bool ComponentBlueprint::getBool(const std::string& key, bool defaultValue) const {
-		auto it = values.find(key);
-		if(it != values.end()) {
-			if(it->second == "true")
-				return true;
-			if(it->second == "false")
-				return false;
-			return defaultValue;
+	void ComponentBlueprint::set(BlueprintKey key, const std::string& text) {
+		auto& value = insert(key);
+		value.text = text;
+		value.flags = 0;
+		value.intValue = 0;
+		value.floatValue = 0;
+		try {
+			value.intValue = std::stoi(text);
+			value.flags |= HAS_INT;
+		} catch(...) {}
+		try {
+			value.floatValue = std::stof(text);
+			value.flags |= HAS_FLOAT;
+		} catch(...) {}
+		if(text == "true")
+			value.flags |= HAS_BOOL | BOOL_VALUE;
+		else if(text == "false")
+			value.flags |= HAS_BOOL;
+	}
+
+	const ComponentBlueprint::Value* ComponentBlueprint::find(BlueprintKey key) const {
+		auto it = std::lower_bound(values.begin(), values.end(), key,
+			[](const Value& value, BlueprintKey key) { return value.key < key; });
+		if (it != values.end() && it->key == key)
+			return &*it;
+		return nullptr;
+	}
+
+	const ComponentBlueprint::Value* ComponentBlueprint::findByName(const std::string& key) const {
+		// Compare the names stored with the values, so no lock on the key registry is needed.
+		for (auto& value : values) {
+			if (*value.keyName == key)
+				return &value;
 		}
-		return defaultValue;
+		return nullptr;
+	}
+
+	bool ComponentBlueprint::getBool(const std::string& key, bool defaultValue) const {
+		auto value = findByName(key);
+		return value ? value->getBool(defaultValue) : defaultValue;
 	}
 
 	int ComponentBlueprint::getInt(const std::string& key, int defaultValue) const {
-		auto it = values.find(key);
-		if(it != values.end()) {
-			try {
-				return std::stoi(it->second);
-			} catch(...) {
-				return defaultValue;
-			}
-		}
-		return defaultValue;
+		auto value = findByName(key);
+		return value ? value->getInt(defaultValue) : defaultValue;
 	}
 
 	float ComponentBlueprint::getFloat(const std::string& key, float defaultValue) const {
-		auto it = values.find(key);
-		if(it != values.end()) {
-			try {
-				return std::stof(it->second);
-			} catch(...) {
-				return defaultValue;
-			}
-		}
-		return defaultValue;
+		auto value = findByName(key);
+		return value ? value->getFloat(defaultValue) : defaultValue;
 	}
 
 	const std::string& ComponentBlueprint::getString(const std::string& key, const std::string& defaultValue) const {
-		auto it = values.find(key);
-		if(it != values.end())
-			return it->second;
-		return defaultValue;
+		auto value = findByName(key);
+		return value ? value->text : defaultValue;
 	}
 
 	void EntityBlueprint::add(std::shared_ptr<ComponentBlueprint> blueprint) {
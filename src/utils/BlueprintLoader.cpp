@@ -0,0 +1,127 @@
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include <ecstasy/utils/BlueprintLoader.hpp>
+#include <ecstasy/utils/BlueprintParser.hpp>
+#include <ecstasy/utils/EntityFactory.hpp>
+#include <ecstasy/utils/Tokenizer.hpp>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <thread>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <dirent.h>
+#endif
+
+namespace ecstasy {
+	static std::string joinPath(const std::string& directory, const std::string& filename) {
+		if (directory.empty() || directory.back() == '/' || directory.back() == '\\')
+			return directory + filename;
+		return directory + "/" + filename;
+	}
+
+	static bool endsWith(const std::string& str, const std::string& suffix) {
+		return str.size() > suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+	}
+
+	std::string BlueprintLoader::addDirectory(const std::string& directory, const std::string& extension) {
+		std::vector<std::string> filenames;
+#ifdef _WIN32
+		_finddata_t data;
+		auto handle = _findfirst(joinPath(directory, "*" + extension).c_str(), &data);
+		if (handle == -1)
+			return "Can't open directory " + directory;
+		do {
+			if (!(data.attrib & _A_SUBDIR) && endsWith(data.name, extension))
+				filenames.push_back(data.name);
+		} while (_findnext(handle, &data) == 0);
+		_findclose(handle);
+#else
+		auto dir = opendir(directory.c_str());
+		if (!dir)
+			return "Can't open directory " + directory;
+		while (auto entry = readdir(dir)) {
+			std::string name = entry->d_name;
+			if (entry->d_type != DT_DIR && endsWith(name, extension))
+				filenames.push_back(name);
+		}
+		closedir(dir);
+#endif
+
+		// The order of directory entries is not specified
+		std::sort(filenames.begin(), filenames.end());
+		for (auto& filename : filenames)
+			addFile(filename.substr(0, filename.size() - extension.size()), joinPath(directory, filename));
+		return "";
+	}
+
+	std::string BlueprintLoader::addManifest(const std::string& filename) {
+		std::ifstream file(filename, std::ios::binary);
+		if (!file.is_open())
+			return "Can't open file " + filename;
+		std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+		auto separator = filename.find_last_of("/\\");
+		auto directory = separator == std::string::npos ? std::string() : filename.substr(0, separator + 1);
+		LineTokenizer tokenizer(text);
+		while (tokenizer.nextLine()) {
+			auto numTokens = tokenizer.getNumTokens();
+			if (numTokens == 0)
+				continue;
+			if (numTokens != 2) {
+				return filename + ": Line " + std::to_string(tokenizer.getLineNumber())
+					+ ": expected a blueprint name and a filename";
+			}
+			auto& tokens = tokenizer.getTokens();
+			addFile(tokens[0].toString(), joinPath(directory, tokens[1].toString()));
+		}
+		return "";
+	}
+
+	std::string BlueprintLoader::load(EntityFactory& factory) {
+		std::vector<std::shared_ptr<EntityBlueprint>> blueprints(files.size());
+		std::vector<std::string> errors(files.size());
+		std::atomic<size_t> nextFile(0);
+		auto work = [&]() {
+			for (auto i = nextFile++; i < files.size(); i = nextFile++)
+				errors[i] = parseBlueprint(files[i].second, blueprints[i]);
+		};
+
+		size_t numThreads = threadCount ? threadCount : std::thread::hardware_concurrency();
+		numThreads = std::max<size_t>(1, std::min(numThreads, files.size()));
+		std::vector<std::thread> threads;
+		threads.reserve(numThreads - 1);
+		for (size_t i = 1; i < numThreads; i++)
+			threads.emplace_back(work);
+		work();
+		for (auto& thread : threads)
+			thread.join();
+
+		// The factory is not thread-safe, so the blueprints get added in one go afterwards
+		std::string result;
+		for (size_t i = 0; i < files.size(); i++) {
+			if (errors[i].empty())
+				factory.addEntityBlueprint(files[i].first, blueprints[i]);
+			else
+				result += files[i].second + ": " + errors[i] + "\n";
+		}
+		files.clear();
+		return result;
+	}
+}
@@ -0,0 +1,308 @@
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include <ecstasy/utils/BlueprintPack.hpp>
+#include <ecstasy/utils/Blueprint.hpp>
+#include <ecstasy/utils/BlueprintParser.hpp>
+#include <unordered_map>
+#include <vector>
+#include <fstream>
+#include <cstring>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace ecstasy {
+	const uint32_t BlueprintPack::NOT_FOUND;
+
+	static const char PACK_MAGIC[4] = { 'E', 'C', 'B', 'P' };
+	static const uint32_t PACK_VERSION = 1;
+
+	std::string BlueprintPack::open(const std::string& filename) {
+		close();
+#ifdef _WIN32
+		std::ifstream file(filename, std::ios::binary | std::ios::ate);
+		if (!file.is_open())
+			return "Can't open file " + filename;
+		auto fileSize = file.tellg();
+		if (fileSize <= 0)
+			return "Can't read file " + filename;
+		size = static_cast<size_t>(fileSize);
+		auto buffer = new char[size];
+		file.seekg(0);
+		if (!file.read(buffer, size)) {
+			delete[] buffer;
+			size = 0;
+			return "Can't read file " + filename;
+		}
+		data = buffer;
+		mapped = false;
+#else
+		int fd = ::open(filename.c_str(), O_RDONLY);
+		if (fd < 0)
+			return "Can't open file " + filename;
+		struct stat info;
+		if (fstat(fd, &info) != 0 || info.st_size == 0) {
+			::close(fd);
+			return "Can't read file " + filename;
+		}
+		size = static_cast<size_t>(info.st_size);
+		void* memory = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		if (memory == MAP_FAILED) {
+			size = 0;
+			return "Can't map file " + filename;
+		}
+		data = static_cast<const char*>(memory);
+		mapped = true;
+#endif
+
+		if (size < sizeof(Header) || std::memcmp(data, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0) {
+			close();
+			return "Not a blueprint pack: " + filename;
+		}
+		auto fileHeader = reinterpret_cast<const Header*>(data);
+		if (fileHeader->version != PACK_VERSION) {
+			close();
+			return "Unsupported blueprint pack version in " + filename;
+		}
+
+		uint64_t expectedSize = sizeof(Header)
+			+ uint64_t(fileHeader->stringCount) * sizeof(StringEntry)
+			+ uint64_t(fileHeader->blueprintCount) * sizeof(BlueprintEntry)
+			+ uint64_t(fileHeader->componentCount) * sizeof(ComponentEntry)
+			+ uint64_t(fileHeader->valueCount) * sizeof(ValueEntry)
+			+ fileHeader->stringBytes;
+		if (expectedSize > size) {
+			close();
+			return "Blueprint pack is truncated: " + filename;
+		}
+
+		header = fileHeader;
+		auto position = data + sizeof(Header);
+		strings = reinterpret_cast<const StringEntry*>(position);
+		position += header->stringCount * sizeof(StringEntry);
+		blueprints = reinterpret_cast<const BlueprintEntry*>(position);
+		position += header->blueprintCount * sizeof(BlueprintEntry);
+		components = reinterpret_cast<const ComponentEntry*>(position);
+		position += header->componentCount * sizeof(ComponentEntry);
+		values = reinterpret_cast<const ValueEntry*>(position);
+		position += header->valueCount * sizeof(ValueEntry);
+		stringData = position;
+		return "";
+	}
+
+	void BlueprintPack::close() {
+		if (data) {
+#ifdef _WIN32
+			delete[] data;
+#else
+			if (mapped)
+				munmap(const_cast<char*>(data), size);
+#endif
+		}
+		data = nullptr;
+		size = 0;
+		mapped = false;
+		header = nullptr;
+		strings = nullptr;
+		blueprints = nullptr;
+		components = nullptr;
+		values = nullptr;
+		stringData = nullptr;
+	}
+
+	bool BlueprintPack::getString(uint32_t index, StringView& result) const {
+		if (index >= header->stringCount)
+			return false;
+		auto& entry = strings[index];
+		if (entry.offset > header->stringBytes || entry.length > header->stringBytes - entry.offset)
+			return false;
+		result = StringView(stringData + entry.offset, entry.length);
+		return true;
+	}
+
+	StringView BlueprintPack::getBlueprintName(uint32_t index) const {
+		StringView name;
+		if (index < getBlueprintCount())
+			getString(blueprints[index].name, name);
+		return name;
+	}
+
+	uint32_t BlueprintPack::find(StringView name) const {
+		// The blueprints are sorted by name
+		uint32_t low = 0;
+		uint32_t high = getBlueprintCount();
+		while (low < high) {
+			uint32_t middle = low + (high - low) / 2;
+			int result = getBlueprintName(middle).compare(name);
+			if (result == 0)
+				return middle;
+			if (result < 0)
+				low = middle + 1;
+			else
+				high = middle;
+		}
+		return NOT_FOUND;
+	}
+
+	std::shared_ptr<EntityBlueprint> BlueprintPack::getBlueprint(uint32_t index) const {
+		if (index >= getBlueprintCount())
+			return nullptr;
+
+		auto& entry = blueprints[index];
+		if (entry.firstComponent > header->componentCount
+			|| entry.componentCount > header->componentCount - entry.firstComponent)
+			return nullptr;
+
+		auto result = std::make_shared<EntityBlueprint>();
+		auto componentsEnd = entry.firstComponent + entry.componentCount;
+		for (auto i = entry.firstComponent; i < componentsEnd; i++) {
+			auto& component = components[i];
+			StringView name;
+			if (!getString(component.name, name) || component.firstValue > header->valueCount
+				|| component.valueCount > header->valueCount - component.firstValue)
+				return nullptr;
+
+			auto componentBlueprint = std::make_shared<ComponentBlueprint>(name.toString());
+			auto valuesEnd = component.firstValue + component.valueCount;
+			for (auto j = component.firstValue; j < valuesEnd; j++) {
+				StringView key, text;
+				if (!getString(values[j].key, key) || !getString(values[j].text, text))
+					return nullptr;
+				// The values have been parsed when the pack was written
+				auto& value = componentBlueprint->insert(ComponentBlueprint::getKey(key.toString()));
+				value.text = text.toString();
+				value.flags = values[j].flags;
+				value.intValue = values[j].intValue;
+				value.floatValue = values[j].floatValue;
+			}
+			result->add(componentBlueprint);
+		}
+		return result;
+	}
+
+	namespace {
+		class StringTable {
+		public:
+			std::unordered_map<std::string, uint32_t> indices;
+			std::vector<const std::string*> strings;
+			uint32_t bytes = 0;
+
+			uint32_t add(const std::string& str) {
+				auto it = indices.find(str);
+				if (it != indices.end())
+					return it->second;
+				auto index = static_cast<uint32_t>(strings.size());
+				auto inserted = indices.emplace(str, index).first;
+				strings.push_back(&inserted->first);
+				bytes += static_cast<uint32_t>(str.size());
+				return index;
+			}
+		};
+
+		template<typename T>
+		void writeEntries(std::ostream& stream, const std::vector<T>& entries) {
+			if (!entries.empty())
+				stream.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(T));
+		}
+	}
+
+	std::string BlueprintPack::write(std::ostream& stream,
+		const std::map<std::string, std::shared_ptr<EntityBlueprint>>& blueprints) {
+		StringTable table;
+		std::vector<BlueprintEntry> blueprintEntries;
+		std::vector<ComponentEntry> componentEntries;
+		std::vector<ValueEntry> valueEntries;
+		blueprintEntries.reserve(blueprints.size());
+
+		// std::map is sorted by name, which is what find() relies on
+		for (auto& blueprint : blueprints) {
+			if (!blueprint.second)
+				return "Blueprint " + blueprint.first + " is empty";
+			BlueprintEntry entry;
+			entry.name = table.add(blueprint.first);
+			entry.firstComponent = static_cast<uint32_t>(componentEntries.size());
+			entry.componentCount = static_cast<uint32_t>(blueprint.second->components.size());
+			blueprintEntries.push_back(entry);
+
+			for (auto& component : blueprint.second->components) {
+				ComponentEntry componentEntry;
+				componentEntry.name = table.add(component->name);
+				componentEntry.firstValue = static_cast<uint32_t>(valueEntries.size());
+				componentEntry.valueCount = static_cast<uint32_t>(component->values.size());
+				componentEntries.push_back(componentEntry);
+
+				for (auto& value : component->values) {
+					ValueEntry valueEntry;
+					valueEntry.key = table.add(ComponentBlueprint::getKeyName(value.key));
+					valueEntry.text = table.add(value.text);
+					valueEntry.flags = value.flags;
+					valueEntry.intValue = value.intValue;
+					valueEntry.floatValue = value.floatValue;
+					valueEntries.push_back(valueEntry);
+				}
+			}
+		}
+
+		std::vector<StringEntry> stringEntries;
+		stringEntries.reserve(table.strings.size());
+		uint32_t offset = 0;
+		for (auto str : table.strings) {
+			stringEntries.push_back({ offset, static_cast<uint32_t>(str->size()) });
+			offset += static_cast<uint32_t>(str->size());
+		}
+
+		Header fileHeader;
+		std::memcpy(fileHeader.magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+		fileHeader.version = PACK_VERSION;
+		fileHeader.stringCount = static_cast<uint32_t>(stringEntries.size());
+		fileHeader.stringBytes = table.bytes;
+		fileHeader.blueprintCount = static_cast<uint32_t>(blueprintEntries.size());
+		fileHeader.componentCount = static_cast<uint32_t>(componentEntries.size());
+		fileHeader.valueCount = static_cast<uint32_t>(valueEntries.size());
+
+		stream.write(reinterpret_cast<const char*>(&fileHeader), sizeof(Header));
+		writeEntries(stream, stringEntries);
+		writeEntries(stream, blueprintEntries);
+		writeEntries(stream, componentEntries);
+		writeEntries(stream, valueEntries);
+		for (auto str : table.strings)
+			stream.write(str->data(), str->size());
+
+		if (!stream)
+			return "Failed to write blueprint pack";
+		return "";
+	}
+
+	std::string convertBlueprints(const std::map<std::string, std::string>& files, const std::string& filename) {
+		std::map<std::string, std::shared_ptr<EntityBlueprint>> blueprints;
+		for (auto& file : files) {
+			std::shared_ptr<EntityBlueprint> blueprint;
+			auto error = parseBlueprint(file.second, blueprint);
+			if (!error.empty())
+				return file.second + ": " + error;
+			blueprints[file.first] = blueprint;
+		}
+
+		std::ofstream stream(filename, std::ios::binary);
+		if (!stream.is_open())
+			return "Can't open file " + filename;
+		return BlueprintPack::write(stream, blueprints);
+	}
+}
@@ -17,44 +17,56 @@
 #include <ecstasy/utils/BlueprintParser.hpp>
 #include <ecstasy/utils/Tokenizer.hpp>
 #include <fstream>
+#include <iterator>
 
 namespace ecstasy {
 	std::string parseBlueprint(const std::string& filename, std::shared_ptr<EntityBlueprint>& result) {
-		std::ifstream file(filename);
+		std::ifstream file(filename, std::ios::binary | std::ios::ate);
 		if(!file.is_open())
 			return "Can't open file " + filename;
-		return parseBlueprint(file, result);
+		auto size = file.tellg();
+		file.seekg(0);
+		// Directories can be opened on some platforms, but report a bogus size and fail on the first read
+		if(size < 0 || (size > 0 && file.peek() == std::ifstream::traits_type::eof()))
+			return "Can't read file " + filename;
+		std::string text(static_cast<size_t>(size), '\0');
+		if(!file.read(&text[0], text.size()))
+			return "Can't read file " + filename;
+		return parseBlueprintText(text, result);
 	}
 
 	std::string parseBlueprint(std::istream& stream, std::shared_ptr<EntityBlueprint>& result) {
+		std::string text((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+		return parseBlueprintText(text, result);
+	}
+
+	std::string parseBlueprintText(StringView text, std::shared_ptr<EntityBlueprint>& result) {
 		result = std::make_shared<EntityBlueprint>();
 
 		std::shared_ptr<ComponentBlueprint> lastComponent;
-		std::vector<std::string> tokens;
-		std::string line;
-		for(int lineNum=1; std::getline(stream, line); lineNum++) {
-			// parse tokens
-			tokens.clear();
-			int numTokens = parseTokens(line, tokens);
+		LineTokenizer tokenizer(text);
+		while(tokenizer.nextLine()) {
+			auto lineNum = tokenizer.getLineNumber();
+			auto numTokens = tokenizer.getNumTokens();
+			auto& tokens = tokenizer.getTokens();
 			if(numTokens < 0)
 				return "Line " + std::to_string(lineNum) + ": quote has not been closed";
 			if(numTokens > 0) {
-				std::string& command = tokens[0];
+				auto command = tokens[0];
 				if(command == "add") {
 					if(numTokens != 2)
 						return "Line " + std::to_string(lineNum) + ": expected exactly one argument to 'add'";
 					if(lastComponent)
 						result->add(lastComponent);
-					std::string& name = tokens[1];
-					lastComponent = std::make_shared<ComponentBlueprint>(name);
+					lastComponent = std::make_shared<ComponentBlueprint>(tokens[1].toString());
 				} else if(command == "set") {
 					if(numTokens != 3)
 						return "Line " + std::to_string(lineNum) + ": expected exactly two arguments to 'set'";
 					if(!lastComponent)
 						return "Line " + std::to_string(lineNum) + ": 'add' must be called before 'set'";
-					lastComponent->set(tokens[1], tokens[2]);
+					lastComponent->set(tokens[1].toString(), tokens[2].toString());
 				} else {
-					return "Line " + std::to_string(lineNum) + ": unknown command '" + command + "'";
+					return "Line " + std::to_string(lineNum) + ": unknown command '" + command.toString() + "'";
 				}
 			}
 		}
@@ -0,0 +1,161 @@
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include <ecstasy/utils/ComponentFields.hpp>
+#include <cstring>
+
+namespace ecstasy {
+	namespace {
+		template<typename F>
+		F& fieldAt(void* component, size_t offset) {
+			return *reinterpret_cast<F*>(static_cast<char*>(component) + offset);
+		}
+
+		template<typename F>
+		const F& fieldAt(const void* component, size_t offset) {
+			return *reinterpret_cast<const F*>(static_cast<const char*>(component) + offset);
+		}
+
+		template<typename F>
+		void writeRaw(std::vector<char>& buffer, const F& value) {
+			auto bytes = reinterpret_cast<const char*>(&value);
+			buffer.insert(buffer.end(), bytes, bytes + sizeof(F));
+		}
+
+		template<typename F>
+		bool readRaw(F& value, const char*& position, const char* end) {
+			if (static_cast<size_t>(end - position) < sizeof(F))
+				return false;
+			std::memcpy(&value, position, sizeof(F));
+			position += sizeof(F);
+			return true;
+		}
+
+		bool isNameSeparator(char c) {
+			return c == ',' || c == ' ' || c == '\t' || c == '\n' || c == '\r';
+		}
+	}
+
+	void ComponentFields::addFields(const char* names, std::initializer_list<FieldType> types,
+		std::initializer_list<size_t> offsets) {
+		auto type = types.begin();
+		auto offset = offsets.begin();
+		fields.reserve(types.size());
+		for (auto c = names; *c && type != types.end();) {
+			while (isNameSeparator(*c))
+				c++;
+			auto start = c;
+			while (*c && !isNameSeparator(*c))
+				c++;
+			if (c == start)
+				break;
+			Field field;
+			field.name.assign(start, c);
+			field.key = ComponentBlueprint::getKey(field.name);
+			field.type = *type++;
+			field.offset = *offset++;
+			fields.push_back(field);
+		}
+	}
+
+	void ComponentFields::parse(Values& values, const ComponentBlueprint& blueprint) const {
+		values.clear();
+		for (uint32_t i = 0; i < fields.size(); i++) {
+			auto value = blueprint.find(fields[i].key);
+			if (value)
+				values.push_back({ i, *value });
+		}
+	}
+
+	void ComponentFields::apply(void* component, const Values& values) const {
+		for (auto& fieldValue : values) {
+			auto& field = fields[fieldValue.field];
+			auto& value = fieldValue.value;
+			switch (field.type) {
+			case FieldType::BOOL:
+				if (value.flags & ComponentBlueprint::HAS_BOOL)
+					fieldAt<bool>(component, field.offset) = (value.flags & ComponentBlueprint::BOOL_VALUE) != 0;
+				break;
+			case FieldType::INT:
+				if (value.flags & ComponentBlueprint::HAS_INT)
+					fieldAt<int>(component, field.offset) = value.intValue;
+				break;
+			case FieldType::FLOAT:
+				if (value.flags & ComponentBlueprint::HAS_FLOAT)
+					fieldAt<float>(component, field.offset) = value.floatValue;
+				break;
+			case FieldType::STRING:
+				fieldAt<std::string>(component, field.offset) = value.text;
+				break;
+			}
+		}
+	}
+
+	void ComponentFields::write(const void* component, std::vector<char>& buffer) const {
+		for (auto& field : fields) {
+			switch (field.type) {
+			case FieldType::BOOL:
+				writeRaw<uint8_t>(buffer, fieldAt<bool>(component, field.offset) ? 1 : 0);
+				break;
+			case FieldType::INT:
+				writeRaw<int32_t>(buffer, fieldAt<int>(component, field.offset));
+				break;
+			case FieldType::FLOAT:
+				writeRaw<float>(buffer, fieldAt<float>(component, field.offset));
+				break;
+			case FieldType::STRING: {
+				auto& text = fieldAt<std::string>(component, field.offset);
+				writeRaw<uint32_t>(buffer, static_cast<uint32_t>(text.size()));
+				buffer.insert(buffer.end(), text.begin(), text.end());
+				break;
+			}
+			}
+		}
+	}
+
+	bool ComponentFields::read(void* component, const char*& position, const char* end) const {
+		for (auto& field : fields) {
+			switch (field.type) {
+			case FieldType::BOOL: {
+				uint8_t value;
+				if (!readRaw(value, position, end))
+					return false;
+				fieldAt<bool>(component, field.offset) = value != 0;
+				break;
+			}
+			case FieldType::INT: {
+				int32_t value;
+				if (!readRaw(value, position, end))
+					return false;
+				fieldAt<int>(component, field.offset) = value;
+				break;
+			}
+			case FieldType::FLOAT:
+				if (!readRaw(fieldAt<float>(component, field.offset), position, end))
+					return false;
+				break;
+			case FieldType::STRING: {
+				uint32_t length;
+				if (!readRaw(length, position, end) || static_cast<size_t>(end - position) < length)
+					return false;
+				fieldAt<std::string>(component, field.offset).assign(position, length);
+				position += length;
+				break;
+			}
+			}
+		}
+		return true;
+	}
+}
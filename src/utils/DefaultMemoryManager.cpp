@@ -15,6 +15,7 @@
  ******************************************************************************/
 #include <ecstasy/utils/DefaultMemoryManager.hpp>
 #include <algorithm>
+#include <stdexcept>
 
 namespace ecstasy {
 	static const uint32_t MEMORY_META_SIZE = sizeof(uint16_t);
@@ -26,6 +27,11 @@ namespace ecstasy {
 		return (size / align) * align + align;
 	}
 
+	// Pinned allocations get their own size class, marked by a bit no valid align uses
+	static uint64_t getManagerKey(uint32_t unitSize, uint32_t align, bool pinned) {
+		return static_cast<uint64_t>(unitSize) << 32 | align | (pinned ? 0x80000000u : 0u);
+	}
+
 	int getFirstSetBit(uint64_t bits) {
 		static const char multiplyDeBruijnBitPosition[64] = {
 			0, 1, 2, 56, 3, 32, 57, 46, 29, 4, 20, 33, 7, 58, 11, 47,
@@ -104,10 +110,16 @@ namespace ecstasy {
 		if(freePages.empty()) {
 			pages.emplace_back(std::make_unique<MemoryPage>(static_cast<uint16_t>(pages.size()), unitSize, align));
 			freePages.push_back(pages.back().get());
+			emptyPages++;
 		}
 		auto page = freePages.back();
+		if(page->getFreeUnits() == 64)
+			emptyPages--;
 		void *result = page->allocate();
 		allocationCount++;
+		totalAllocations++;
+		if(allocationCount > peakAllocationCount)
+			peakAllocationCount = allocationCount;
 		if(!page->getFreeUnits())
 			freePages.pop_back();
 		return result;
@@ -120,8 +132,11 @@ namespace ecstasy {
 			if(owningPage->owns(memory)) {
 				owningPage->free(memory);
 				allocationCount--;
-				if(owningPage->getFreeUnits() == 1)
+				totalFrees++;
+				if(owningPage->getFreeUnits() == 1 && !owningPage->isEvacuating())
 					freePages.push_back(owningPage);
+				else if(owningPage->getFreeUnits() == 64)
+					emptyPages++;
 				return;
 			}
 		}
@@ -130,12 +145,13 @@ namespace ecstasy {
 
 	void MemoryPageManager::reduceMemory() {
 		uint16_t removed = 0;
+		auto isEmpty = [](const MemoryPage* page) {
+			return page->getFreeUnits() == 64;
+		};
+		freePages.erase(std::remove_if(freePages.begin(), freePages.end(), isEmpty), freePages.end());
 		for (auto it = pages.cbegin(); it != pages.cend();) {
 			auto page = it->get();
-			if(page->getFreeUnits() == 64) {
-				auto freeIt = std::find(freePages.begin(), freePages.end(), page);
-				if (freeIt != freePages.end())
-					freePages.erase(freeIt);
+			if(isEmpty(page)) {
 				it = pages.erase(it);
 				removed++;
 			} else {
@@ -143,30 +159,151 @@ namespace ecstasy {
 				++it;
 			}
 		}
+		emptyPages = 0;
 	}
 
-	void* DefaultMemoryManager::allocate(uint32_t size, uint32_t align) {
-		size = getMemoryUnitSize(size, align);
-		uint64_t key = static_cast<uint64_t>(size) << 32 | align;
+	void MemoryPageManager::reserve(uint32_t count) {
+		uint32_t freeUnits = 0;
+		for (auto page : freePages)
+			freeUnits += page->getFreeUnits();
+		if (freeUnits >= count)
+			return;
+		uint32_t newPages = (count - freeUnits + 63) / 64;
+		pages.reserve(pages.size() + newPages);
+		std::vector<MemoryPage*> reserved;
+		reserved.reserve(newPages);
+		for (uint32_t i = 0; i < newPages; i++) {
+			pages.emplace_back(std::make_unique<MemoryPage>(static_cast<uint16_t>(pages.size()), unitSize, align));
+			reserved.push_back(pages.back().get());
+		}
+		emptyPages += newPages;
+		// Pages are taken from the back, so partially used pages are filled first
+		freePages.insert(freePages.begin(), reserved.rbegin(), reserved.rend());
+	}
+
+	uint32_t MemoryPageManager::beginCompaction(float threshold) {
+		auto maxUsedUnits = static_cast<uint32_t>(threshold * 64);
+		std::vector<MemoryPage*> candidates;
+		uint32_t capacity = 0;
+		for (auto& page : pages) {
+			uint32_t usedUnits = 64 - page->getFreeUnits();
+			if (usedUnits > 0 && usedUnits <= maxUsedUnits)
+				candidates.push_back(page.get());
+			else
+				capacity += page->getFreeUnits();
+		}
+		if (candidates.empty())
+			return 0;
+
+		// Keep the densest candidates as targets until the allocations of the remaining ones fit into the free units
+		std::sort(candidates.begin(), candidates.end(), [](const MemoryPage* a, const MemoryPage* b) {
+			return a->getFreeUnits() < b->getFreeUnits();
+		});
+		uint32_t evacuated = 0;
+		for (auto page : candidates)
+			evacuated += 64 - page->getFreeUnits();
+		size_t kept = 0;
+		for (; kept < candidates.size() && evacuated > capacity; kept++) {
+			evacuated -= 64 - candidates[kept]->getFreeUnits();
+			capacity += candidates[kept]->getFreeUnits();
+		}
+		for (size_t i = kept; i < candidates.size(); i++)
+			candidates[i]->setEvacuating(true);
+		if (evacuated) {
+			freePages.erase(std::remove_if(freePages.begin(), freePages.end(), [](const MemoryPage* page) {
+				return page->isEvacuating();
+			}), freePages.end());
+		}
+		return evacuated;
+	}
+
+	bool MemoryPageManager::isEvacuating(void* memory) const {
+		uint16_t *metaData = reinterpret_cast<uint16_t *>(reinterpret_cast<char *>(memory) + unitSize - MEMORY_META_SIZE);
+		return *metaData < pages.size() && pages[*metaData]->isEvacuating();
+	}
+
+	void MemoryPageManager::endCompaction() {
+		for (auto& page : pages) {
+			if (page->isEvacuating()) {
+				page->setEvacuating(false);
+				if (page->getFreeUnits())
+					freePages.push_back(page.get());
+			}
+		}
+	}
+
+	MemoryStats MemoryPageManager::getStats() const {
+		uint64_t pageSize = unitSize * 64 + align;
+		MemoryStats stats;
+		stats.reservedBytes = pages.size() * pageSize;
+		stats.usedBytes = static_cast<uint64_t>(allocationCount) * unitSize;
+		stats.peakUsedBytes = static_cast<uint64_t>(peakAllocationCount) * unitSize;
+		stats.reclaimableBytes = emptyPages * pageSize;
+		stats.allocationCount = allocationCount;
+		stats.totalAllocations = totalAllocations;
+		stats.totalFrees = totalFrees;
+		return stats;
+	}
+
+	MemoryPageManager* DefaultMemoryManager::getOrCreateManager(uint32_t size, uint32_t align, bool pinned) {
+		auto unitSize = getMemoryUnitSize(size, align);
+		auto key = getManagerKey(unitSize, align, pinned);
 		auto it = managers.find(key);
-		MemoryPageManager *manager;
 		if(it != managers.end())
-			manager = it->second.get();
-		else
-			manager = managers.emplace(key, std::make_unique<MemoryPageManager>(size, align)).first->second.get();
-		return manager->allocate();
+			return it->second.get();
+		return managers.emplace(key, std::make_unique<MemoryPageManager>(unitSize, align, pinned)).first->second.get();
+	}
+
+	const MemoryPageManager* DefaultMemoryManager::findManager(uint32_t size, uint32_t align, bool pinned) const {
+		auto it = managers.find(getManagerKey(getMemoryUnitSize(size, align), align, pinned));
+		return it == managers.end() ? nullptr : it->second.get();
+	}
+
+	void* DefaultMemoryManager::allocate(uint32_t size, uint32_t align) {
+		auto manager = getOrCreateManager(size, align, false);
+		auto result = manager->allocate();
+		totalAllocations++;
+		// Same definition as MemoryPageManager::getStats()
+		usedBytes += manager->getUnitSize();
+		if(usedBytes > peakUsedBytes)
+			peakUsedBytes = usedBytes;
+		return result;
+	}
+
+	void* DefaultMemoryManager::allocatePinned(uint32_t size, uint32_t align) {
+		auto manager = getOrCreateManager(size, align, true);
+		auto result = manager->allocate();
+		totalAllocations++;
+		usedBytes += manager->getUnitSize();
+		if(usedBytes > peakUsedBytes)
+			peakUsedBytes = usedBytes;
+		return result;
+	}
+
+	void DefaultMemoryManager::reserve(uint32_t size, uint32_t align, uint32_t count) {
+		getOrCreateManager(size, align, false)->reserve(count);
+	}
+
+	void DefaultMemoryManager::reservePinned(uint32_t size, uint32_t align, uint32_t count) {
+		getOrCreateManager(size, align, true)->reserve(count);
 	}
 
 	void DefaultMemoryManager::free(uint32_t size, uint32_t align, void* memory) {
-		size = getMemoryUnitSize(size, align);
-		uint64_t key = static_cast<uint64_t>(size) << 32 | align;
-		auto it = managers.find(key);
+		freeInternal(size, align, memory, false);
+	}
+
+	void DefaultMemoryManager::freePinned(uint32_t size, uint32_t align, void* memory) {
+		freeInternal(size, align, memory, true);
+	}
+
+	void DefaultMemoryManager::freeInternal(uint32_t size, uint32_t align, void* memory, bool pinned) {
+		auto it = managers.find(getManagerKey(getMemoryUnitSize(size, align), align, pinned));
 		if(it == managers.end())
 			throw std::invalid_argument("Trying to free memory which does not belong to this memory manager");
-		else {
-			auto manager = it->second.get();
-			manager->free(memory);
-		}
+		auto manager = it->second.get();
+		manager->free(memory);
+		totalFrees++;
+		usedBytes -= manager->getUnitSize();
 	}
 
 	void DefaultMemoryManager::reduceMemory() {
@@ -188,25 +325,64 @@ namespace ecstasy {
 		return count;
 	}
 
+	MemoryStats DefaultMemoryManager::getStats() const {
+		MemoryStats stats;
+		for(auto& kv: managers) {
+			auto managerStats = kv.second->getStats();
+			stats.reservedBytes += managerStats.reservedBytes;
+			stats.reclaimableBytes += managerStats.reclaimableBytes;
+			stats.allocationCount += managerStats.allocationCount;
+		}
+		stats.usedBytes = usedBytes;
+		stats.peakUsedBytes = peakUsedBytes;
+		stats.totalAllocations = totalAllocations;
+		stats.totalFrees = totalFrees;
+		return stats;
+	}
+
+	uint32_t DefaultMemoryManager::beginCompaction() {
+		uint32_t evacuated = 0;
+		for(auto& kv: managers) {
+			if (!kv.second->isPinned())
+				evacuated += kv.second->beginCompaction(compactionThreshold);
+		}
+		return evacuated;
+	}
+
+	bool DefaultMemoryManager::isEvacuating(uint32_t size, uint32_t align, void* memory) const {
+		auto manager = findManager(size, align, false);
+		return manager && manager->isEvacuating(memory);
+	}
+
+	void DefaultMemoryManager::endCompaction() {
+		for(auto& kv: managers)
+			kv.second->endCompaction();
+	}
+
 	uint32_t DefaultMemoryManager::getPageManagerCount() const {
 		return managers.size();
 	}
 
-	uint32_t DefaultMemoryManager::getAllocationCount(uint32_t size, uint32_t align) const {
-		size = getMemoryUnitSize(size, align);
-		uint64_t key = static_cast<uint64_t>(size) << 32 | align;
-		auto it = managers.find(key);
-		if(it == managers.end())
-			return 0;
-		return it->second.get()->getAllocationCount();
+	std::vector<const MemoryPageManager*> DefaultMemoryManager::getPageManagers() const {
+		std::vector<const MemoryPageManager*> result;
+		result.reserve(managers.size());
+		for(auto& kv: managers)
+			result.push_back(kv.second.get());
+		return result;
 	}
 
-	uint32_t DefaultMemoryManager::getPageCount(uint32_t size, uint32_t align) const {
-		size = getMemoryUnitSize(size, align);
-		uint64_t key = static_cast<uint64_t>(size) << 32 | align;
-		auto it = managers.find(key);
-		if(it == managers.end())
-			return 0;
-		return it->second.get()->getPageCount();
+	uint32_t DefaultMemoryManager::getAllocationCount(uint32_t size, uint32_t align, bool pinned) const {
+		auto manager = findManager(size, align, pinned);
+		return manager ? manager->getAllocationCount() : 0;
+	}
+
+	uint32_t DefaultMemoryManager::getPageCount(uint32_t size, uint32_t align, bool pinned) const {
+		auto manager = findManager(size, align, pinned);
+		return manager ? manager->getPageCount() : 0;
+	}
+
+	MemoryStats DefaultMemoryManager::getStats(uint32_t size, uint32_t align, bool pinned) const {
+		auto manager = findManager(size, align, pinned);
+		return manager ? manager->getStats() : MemoryStats();
 	}
 }
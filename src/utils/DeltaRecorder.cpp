@@ -0,0 +1,378 @@
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include <ecstasy/utils/DeltaRecorder.hpp>
+#include <ecstasy/utils/ComponentRegistry.hpp>
+#include <ecstasy/core/Engine.hpp>
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+
+namespace ecstasy {
+	namespace {
+		const char DELTA_MAGIC[4] = { 'E', 'C', 'S', 'D' };
+		const uint32_t DELTA_VERSION = 1;
+		const uint32_t NO_INDEX = 0xFFFFFFFF;
+
+		struct DeltaHeader {
+			char magic[4];
+			uint32_t version;
+			uint32_t typeCount;
+			uint32_t destroyedCount;
+			uint32_t createdCount;
+			uint32_t removedCount;
+			uint32_t addedCount;
+			uint32_t modifiedCount;
+		};
+
+		template<typename T>
+		void appendRaw(std::vector<char>& buffer, const T& value) {
+			auto bytes = reinterpret_cast<const char*>(&value);
+			buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+		}
+
+		class DeltaReader {
+		public:
+			const char* position;
+			const char* end;
+
+			DeltaReader(const char* position, const char* end) : position(position), end(end) {}
+
+			template<typename T>
+			bool read(T& value) {
+				if (static_cast<size_t>(end - position) < sizeof(T))
+					return false;
+				std::memcpy(&value, position, sizeof(T));
+				position += sizeof(T);
+				return true;
+			}
+		};
+
+		/// Collects the component types used in a delta and the records referring to them
+		class DeltaWriter {
+		public:
+			const ComponentRegistry& registry;
+			std::vector<uint32_t> localIndices;
+			std::vector<const ComponentRegistry::Entry*> types;
+			std::vector<char> body;
+
+			explicit DeltaWriter(const ComponentRegistry& registry) : registry(registry) {}
+
+			/// @return The index of the type within the delta or NO_INDEX if it is not registered.
+			uint32_t getLocalIndex(ComponentType type) {
+				if (type >= localIndices.size())
+					localIndices.resize(type + 1, NO_INDEX);
+				if (localIndices[type] == NO_INDEX) {
+					auto entry = registry.get(type);
+					if (!entry)
+						return NO_INDEX;
+					localIndices[type] = static_cast<uint32_t>(types.size());
+					types.push_back(entry);
+				}
+				return localIndices[type];
+			}
+
+			void writeComponent(std::vector<char>& buffer, ComponentBase* component, uint32_t localIndex) {
+				appendRaw(buffer, localIndex);
+				if (types[localIndex]->fields)
+					types[localIndex]->fields->write(types[localIndex]->data(component), buffer);
+			}
+		};
+
+		ComponentBase* findComponent(const Entity* entity, ComponentType type) {
+			for (auto component : entity->getAll()) {
+				if (component->type == type)
+					return component;
+			}
+			return nullptr;
+		}
+	}
+
+	DeltaRecorder::DeltaRecorder(Engine& engine, const ComponentRegistry& registry)
+		: engine(engine), registry(registry), lastTick(engine.changeTick) {
+		// Changes made from now on get a newer tick, see writeDelta()
+		engine.changeTick++;
+		scope += engine.entityAdded.connect(this, &DeltaRecorder::entityAdded);
+		scope += engine.entityRemoved.connect(this, &DeltaRecorder::entityRemoved);
+		scope += engine.componentAdded.connect(this, &DeltaRecorder::componentAdded);
+		scope += engine.componentRemoved.connect(this, &DeltaRecorder::componentRemoved);
+	}
+
+	void DeltaRecorder::entityAdded(Entity* entity) {
+		if (createdIds.insert(entity->getId()).second)
+			created.push_back(entity->getId());
+		componentEvents.erase(entity->getId());
+	}
+
+	void DeltaRecorder::entityRemoved(Entity* entity) {
+		// Entities created and destroyed within the same delta are not written at all
+		if (!createdIds.erase(entity->getId()))
+			destroyed.push_back(entity->getId());
+		componentEvents.erase(entity->getId());
+	}
+
+	void DeltaRecorder::componentAdded(Entity* entity, ComponentBase* component) {
+		recordComponentEvent(entity, component, true);
+	}
+
+	void DeltaRecorder::componentRemoved(Entity* entity, ComponentBase* component) {
+		recordComponentEvent(entity, component, false);
+	}
+
+	void DeltaRecorder::recordComponentEvent(Entity* entity, ComponentBase* component, bool added) {
+		// Components of new entities are written along with the entity
+		if (!entity->isValid() || entity->isScheduledForRemoval() || createdIds.count(entity->getId()))
+			return;
+		auto& events = componentEvents[entity->getId()];
+		for (auto& event : events) {
+			if (event.first == component->type) {
+				event.second = added;
+				return;
+			}
+		}
+		events.emplace_back(component->type, added);
+	}
+
+	void DeltaRecorder::clear() {
+		created.clear();
+		createdIds.clear();
+		destroyed.clear();
+		componentEvents.clear();
+	}
+
+	std::string DeltaRecorder::writeDelta(std::ostream& stream) {
+		if (engine.updating || engine.notifying)
+			throw std::logic_error("writeDelta() must not be called during update()");
+
+		DeltaWriter writer(registry);
+		DeltaHeader header;
+		std::memcpy(header.magic, DELTA_MAGIC, sizeof(DELTA_MAGIC));
+		header.version = DELTA_VERSION;
+		header.destroyedCount = static_cast<uint32_t>(destroyed.size());
+		header.createdCount = 0;
+		header.removedCount = 0;
+		header.addedCount = 0;
+		header.modifiedCount = 0;
+
+		for (auto id : destroyed)
+			appendRaw(writer.body, id);
+
+		for (auto id : created) {
+			auto entity = createdIds.count(id) ? engine.getEntity(id) : nullptr;
+			if (!entity)
+				continue;
+			header.createdCount++;
+			appendRaw(writer.body, id);
+			auto countPosition = writer.body.size();
+			uint32_t count = 0;
+			appendRaw(writer.body, count);
+			for (auto component : entity->getAll()) {
+				auto localIndex = writer.getLocalIndex(component->type);
+				if (localIndex != NO_INDEX) {
+					writer.writeComponent(writer.body, component, localIndex);
+					count++;
+				}
+			}
+			std::memcpy(&writer.body[countPosition], &count, sizeof(count));
+		}
+
+		// Removed components are written before the added ones
+		std::vector<char> added;
+		for (auto& entry : componentEvents) {
+			auto entity = engine.getEntity(entry.first);
+			if (!entity)
+				continue;
+			for (auto& event : entry.second) {
+				auto localIndex = writer.getLocalIndex(event.first);
+				if (localIndex == NO_INDEX)
+					continue;
+				auto component = findComponent(entity, event.first);
+				if (event.second && component) {
+					header.addedCount++;
+					appendRaw(added, entry.first);
+					writer.writeComponent(added, component, localIndex);
+				} else if (!event.second && !component) {
+					header.removedCount++;
+					appendRaw(writer.body, entry.first);
+					appendRaw(writer.body, localIndex);
+				}
+			}
+		}
+		writer.body.insert(writer.body.end(), added.begin(), added.end());
+
+		// Everything with a tick newer than the one of the last delta has been modified since
+		auto since = lastTick;
+		for (auto entity : *engine.getEntities()) {
+			if (createdIds.count(entity->getId()))
+				continue;
+			auto events = componentEvents.find(entity->getId());
+			for (auto component : entity->getAll()) {
+				if (static_cast<int32_t>(component->getChangeTick() - since) <= 0)
+					continue;
+				if (events != componentEvents.end() && std::any_of(events->second.begin(), events->second.end(),
+					[component](const std::pair<ComponentType, bool>& event) { return event.first == component->type; }))
+					continue;
+				auto localIndex = writer.getLocalIndex(component->type);
+				if (localIndex == NO_INDEX)
+					continue;
+				header.modifiedCount++;
+				appendRaw(writer.body, entity->getId());
+				writer.writeComponent(writer.body, component, localIndex);
+			}
+		}
+		lastTick = engine.changeTick;
+		engine.changeTick++;
+		clear();
+
+		header.typeCount = static_cast<uint32_t>(writer.types.size());
+		std::vector<char> buffer;
+		appendRaw(buffer, header);
+		for (auto type : writer.types) {
+			appendRaw(buffer, static_cast<uint32_t>(type->name.size()));
+			buffer.insert(buffer.end(), type->name.begin(), type->name.end());
+		}
+		stream.write(buffer.data(), buffer.size());
+		stream.write(writer.body.data(), writer.body.size());
+		if (!stream)
+			return "Failed to write the delta";
+		return "";
+	}
+
+	std::string DeltaRecorder::applyDelta(Engine& engine, const char* data, size_t size,
+		const ComponentRegistry& registry) {
+		if (engine.updating || engine.notifying)
+			throw std::logic_error("applyDelta() must not be called during update()");
+
+		DeltaReader reader(data, data + size);
+		DeltaHeader header;
+		if (!reader.read(header) || std::memcmp(header.magic, DELTA_MAGIC, sizeof(DELTA_MAGIC)) != 0)
+			return "Not a delta";
+		if (header.version != DELTA_VERSION)
+			return "Unsupported delta version " + std::to_string(header.version);
+
+		std::vector<const ComponentRegistry::Entry*> types;
+		for (uint32_t i = 0; i < header.typeCount; i++) {
+			uint32_t nameLength;
+			if (!reader.read(nameLength) || static_cast<size_t>(reader.end - reader.position) < nameLength)
+				return "Delta is truncated";
+			std::string name(reader.position, nameLength);
+			reader.position += nameLength;
+			auto entry = registry.find(name);
+			if (!entry)
+				return "Component type '" + name + "' has not been registered";
+			if (std::find(types.begin(), types.end(), entry) != types.end())
+				return "Component type '" + name + "' is listed twice";
+			types.push_back(entry);
+		}
+		auto memoryManager = engine.memoryManager.get();
+
+		for (uint32_t i = 0; i < header.destroyedCount; i++) {
+			uint64_t id;
+			if (!reader.read(id))
+				return "Delta is truncated";
+			auto entity = engine.getEntity(id);
+			if (entity)
+				engine.removeEntity(entity);
+		}
+
+		std::string error;
+		std::vector<Entity*> created;
+		std::unordered_set<uint64_t> createdIds;
+		auto nextEntityId = engine.nextEntityId;
+		for (uint32_t i = 0; i < header.createdCount && error.empty(); i++) {
+			uint64_t id;
+			uint32_t count;
+			if (!reader.read(id) || !reader.read(count)) {
+				error = "Delta is truncated";
+				break;
+			}
+			if (id == 0 || engine.getEntity(id) || !createdIds.insert(id).second) {
+				error = "Invalid entity id " + std::to_string(id);
+				break;
+			}
+			nextEntityId = std::max(nextEntityId, id + 1);
+			auto entity = engine.createEntity();
+			entity->uuid = id;
+			created.push_back(entity);
+			for (uint32_t j = 0; j < count; j++) {
+				uint32_t localIndex;
+				if (!reader.read(localIndex) || localIndex >= types.size()) {
+					error = "Delta is truncated";
+					break;
+				}
+				auto entry = types[localIndex];
+				if (entity->getComponent(entry->type)) {
+					error = "Component type '" + entry->name + "' is listed twice for entity " + std::to_string(id);
+					break;
+				}
+				auto component = entry->create(memoryManager->allocate(entry->memorySize, entry->memoryAlign));
+				entity->attachInternal(component);
+				if (entry->fields && !entry->fields->read(entry->data(component), reader.position, reader.end)) {
+					error = "Component data of '" + entry->name + "' is truncated";
+					break;
+				}
+			}
+		}
+		if (!error.empty()) {
+			engine.discardEntities(created);
+			return error;
+		}
+		engine.nextEntityId = nextEntityId;
+		engine.addEntitiesInternal(created);
+
+		for (uint32_t i = 0; i < header.removedCount; i++) {
+			uint64_t id;
+			uint32_t localIndex;
+			if (!reader.read(id) || !reader.read(localIndex) || localIndex >= types.size())
+				return "Delta is truncated";
+			auto entity = engine.getEntity(id);
+			auto type = types[localIndex]->type;
+			if (entity && entity->getComponent(type))
+				entity->removeInternal(type);
+		}
+
+		auto setCount = header.addedCount + header.modifiedCount;
+		for (uint32_t i = 0; i < setCount; i++) {
+			uint64_t id;
+			uint32_t localIndex;
+			if (!reader.read(id) || !reader.read(localIndex) || localIndex >= types.size())
+				return "Delta is truncated";
+			auto entity = engine.getEntity(id);
+			if (!entity)
+				return "Unknown entity id " + std::to_string(id);
+			auto entry = types[localIndex];
+			auto component = entity->getComponent(entry->type);
+			if (component) {
+				if (entry->fields && !entry->fields->read(entry->data(component), reader.position, reader.end))
+					return "Component data of '" + entry->name + "' is truncated";
+				entity->markChangedInternal(component);
+			} else {
+				auto memory = memoryManager->allocate(entry->memorySize, entry->memoryAlign);
+				component = entry->create(memory);
+				if (entry->fields && !entry->fields->read(entry->data(component), reader.position, reader.end)) {
+					component->~ComponentBase();
+					memoryManager->free(entry->memorySize, entry->memoryAlign, memory);
+					return "Component data of '" + entry->name + "' is truncated";
+				}
+				entity->addInternal(component);
+			}
+		}
+
+		if (reader.position != reader.end)
+			return "Delta has an unexpected size";
+		return "";
+	}
+}
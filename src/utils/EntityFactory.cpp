@@ -16,16 +16,35 @@
 #include <ecstasy/utils/ComponentFactory.hpp>
 #include <ecstasy/utils/EntityFactory.hpp>
 #include <ecstasy/utils/Blueprint.hpp>
+#include <ecstasy/utils/BlueprintPack.hpp>
 
 namespace ecstasy {
+	const BlueprintId EntityFactory::INVALID_ID;
+
 	EntityFactory::EntityFactory() {}
 
-	bool EntityFactory::assemble(Entity* entity, const std::string& blueprintname) {
+	std::shared_ptr<EntityBlueprint> EntityFactory::findBlueprint(const std::string& blueprintname) {
 		auto it = entities.find(blueprintname);
+		if (it != entities.end())
+			return it->second;
+
+		for (auto& pack : packs) {
+			auto index = pack->find(blueprintname);
+			if (index != BlueprintPack::NOT_FOUND) {
+				auto blueprint = pack->getBlueprint(index);
+				if (blueprint)
+					entities.emplace(blueprintname, blueprint);
+				return blueprint;
+			}
+		}
+		return nullptr;
+	}
+
+	bool EntityFactory::assemble(Entity* entity, const std::string& blueprintname) {
+		auto blueprint = findBlueprint(blueprintname);
 		bool success = false;
-		if(it != entities.end()) {
+		if(blueprint) {
 			success = true;
-			auto blueprint = it->second;
 			for(auto& componentBlueprint: blueprint->components) {
 				auto factoryIt = componentFactories.find(componentBlueprint->name);
 				if(factoryIt == componentFactories.end()
@@ -36,4 +55,87 @@ namespace ecstasy {
 		}
 		return success;
 	}
+
+	BlueprintId EntityFactory::compile(const std::string& blueprintname) {
+		if (needsRecompile)
+			recompile();
+		auto idIt = compiledIds.find(blueprintname);
+		if (idIt != compiledIds.end())
+			return idIt->second;
+
+		CompiledBlueprint compiled;
+		compiled.name = blueprintname;
+		if (!compileBlueprint(compiled))
+			return INVALID_ID;
+
+		auto id = static_cast<BlueprintId>(compiledBlueprints.size());
+		compiledBlueprints.push_back(std::move(compiled));
+		compiledIds.emplace(blueprintname, id);
+		return id;
+	}
+
+	bool EntityFactory::compileBlueprint(CompiledBlueprint& compiled) {
+		auto first = static_cast<uint32_t>(compiledComponents.size());
+		compiled.first = first;
+		compiled.count = 0;
+		compiled.valid = false;
+		compiled.hasComponentBits = false;
+		compiled.componentBits.clear();
+
+		compiled.blueprint = findBlueprint(compiled.name);
+		if (!compiled.blueprint)
+			return false;
+
+		for (auto& componentBlueprint : compiled.blueprint->components) {
+			auto factoryIt = componentFactories.find(componentBlueprint->name);
+			if (factoryIt == componentFactories.end()) {
+				compiledComponents.resize(first);
+				return false;
+			}
+			auto factory = factoryIt->second.get();
+			compiledComponents.push_back({ factory, componentBlueprint.get(), factory->compile(*componentBlueprint) });
+		}
+		compiled.count = static_cast<uint32_t>(compiledComponents.size()) - first;
+		compiled.valid = true;
+		return true;
+	}
+
+	void EntityFactory::recompile() {
+		needsRecompile = false;
+		compiledComponents.clear();
+		for (auto& compiled : compiledBlueprints)
+			compileBlueprint(compiled);
+	}
+
+	bool EntityFactory::assemble(Entity* entity, BlueprintId id) {
+		if (id >= compiledBlueprints.size())
+			return false;
+		if (needsRecompile)
+			recompile();
+
+		auto& compiled = compiledBlueprints[id];
+		if (!compiled.valid)
+			return false;
+
+		bool recordBits = !compiled.hasComponentBits && entity->getAll().empty();
+		bool success = true;
+		auto end = compiled.first + compiled.count;
+		for (auto i = compiled.first; i < end; i++) {
+			auto& component = compiledComponents[i];
+			if (!component.factory->assembleCompiled(entity, *component.blueprint, component.data.get()))
+				success = false;
+		}
+
+		if (success && recordBits) {
+			compiled.componentBits |= entity->getComponentBits();
+			compiled.hasComponentBits = true;
+		}
+		return success;
+	}
+
+	const Bits* EntityFactory::getComponentBits(BlueprintId id) const {
+		if (id >= compiledBlueprints.size() || needsRecompile || !compiledBlueprints[id].hasComponentBits)
+			return nullptr;
+		return &compiledBlueprints[id].componentBits;
+	}
 }
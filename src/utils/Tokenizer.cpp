@@ -13,8 +13,8 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  ******************************************************************************/
-#include <string>
-#include <vector>
+#include <ecstasy/utils/Tokenizer.hpp>
+#include <cctype>
 
 namespace ecstasy {
 	char parseEscapeToken(char c) {
@@ -27,59 +27,86 @@ namespace ecstasy {
 		return c;
 	}
 
-	int parseTokens(const std::string& line, std::vector<std::string>& tokens, char commentChar) {
+	static bool isSpace(char c) {
+		return isspace(static_cast<unsigned char>(c)) != 0;
+	}
+
+	static StringView unescapeToken(StringView token, std::string& buffer) {
+		auto start = buffer.size();
+		for(size_t i = 0; i < token.size(); i++) {
+			if(token[i] != '\\')
+				buffer += token[i];
+			else if(++i < token.size())
+				buffer += parseEscapeToken(token[i]);
+		}
+		return StringView(buffer.data() + start, buffer.size() - start);
+	}
+
+	int parseTokens(StringView line, std::vector<StringView>& tokens, std::string& buffer, char commentChar) {
+		// Unescaped tokens are never longer than the line, so the buffer does not reallocate below
+		buffer.clear();
+		buffer.reserve(line.size());
+
 		int numTokens = 0;
-		bool charactersFound = false;
-		bool isEscape = false;
-		bool isQuote = false;
-		std::string token;
-		token.reserve(line.length());
-		for(char c: line) {
-			if(isEscape) {
-				token += parseEscapeToken(c);
-				isEscape = false;
-			} else if(isQuote) {
-				if(c == '\\')
-					isEscape = true;
-				else if(c != '\"')
-					token += c;
-				else {
-					isQuote = false;
-					numTokens++;
-					tokens.push_back(token);
-					token.clear();
-				}
-			} else if(isspace(c)) {
-				// Skip white-spaces at the beginning
-				if(!charactersFound)
-					continue;
-				if(isQuote)
-					token += c;
-				else if(!token.empty()) {
-					numTokens++;
-					tokens.push_back(token);
-					token.clear();
-				}
+		auto data = line.data();
+		auto size = line.size();
+		size_t i = 0;
+		while(i < size) {
+			char c = data[i];
+			if(isSpace(c)) {
+				i++;
 			} else if(c == '\"') {
-				if(!token.empty()) {
-					numTokens++;
-					tokens.push_back(token);
-					token.clear();
+				auto start = ++i;
+				bool hasEscapes = false;
+				while(i < size && data[i] != '\"') {
+					if(data[i] == '\\') {
+						hasEscapes = true;
+						i++;
+					}
+					i++;
 				}
-				isQuote = true;
+				auto end = i < size ? i : size;
+				StringView token(data + start, end - start);
+				tokens.push_back(hasEscapes ? unescapeToken(token, buffer) : token);
+				numTokens++;
+				if(i >= size)
+					return -numTokens;
+				i++;
 			} else if(c == commentChar) {
 				// Start of a comment, so skip the rest of the line
 				break;
 			} else {
-				charactersFound = true;
-				token += c;
+				auto start = i;
+				while(i < size && !isSpace(data[i]) && data[i] != '\"' && data[i] != commentChar)
+					i++;
+				tokens.emplace_back(data + start, i - start);
+				numTokens++;
 			}
 		}
+		return numTokens;
+	}
 
-		if(isQuote || !token.empty()) {
-			numTokens++;
-			tokens.push_back(token);
-		}
-		return isQuote ? -numTokens : numTokens;
+	int parseTokens(const std::string& line, std::vector<std::string>& tokens, char commentChar) {
+		std::vector<StringView> views;
+		std::string buffer;
+		int numTokens = parseTokens(StringView(line), views, buffer, commentChar);
+		for(auto view: views)
+			tokens.push_back(view.toString());
+		return numTokens;
+	}
+
+	bool LineTokenizer::nextLine() {
+		tokens.clear();
+		numTokens = 0;
+		if(position >= text.size())
+			return false;
+
+		auto end = position;
+		while(end < text.size() && text[end] != '\n')
+			end++;
+		lineNumber++;
+		numTokens = parseTokens(text.substr(position, end - position), tokens, buffer, commentChar);
+		position = end + 1;
+		return true;
 	}
 }
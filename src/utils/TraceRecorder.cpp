@@ -0,0 +1,145 @@
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include <ecstasy/utils/TraceRecorder.hpp>
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+namespace ecstasy {
+	const uint32_t TraceRecorder::NONE;
+
+	static uint32_t getThreadNumber() {
+		static std::atomic<uint32_t> nextThreadNumber(1);
+		thread_local uint32_t threadNumber = nextThreadNumber++;
+		return threadNumber;
+	}
+
+	static void writeEscaped(std::ostream& stream, const char* text) {
+		for (; *text; text++) {
+			if (*text == '"' || *text == '\\')
+				stream << '\\';
+			stream << *text;
+		}
+	}
+
+	TraceRecorder::TraceRecorder(uint32_t capacity)
+		: head(0), epoch(std::chrono::steady_clock::now()) {
+		uint64_t size = 1;
+		while (size < capacity)
+			size <<= 1;
+		mask = size - 1;
+		events.reset(new Event[size]);
+		clear();
+	}
+
+	void TraceRecorder::record(const char* name, const char* category, uint64_t start, uint64_t duration,
+		uint32_t id, uint32_t value) {
+		auto index = head.fetch_add(1, std::memory_order_relaxed);
+		auto& event = events[index & mask];
+		// Claim the slot by making its sequence odd. Give up if another writer is busy with it or a newer event is there.
+		uint64_t sequence = (index + 1) * 2;
+		auto current = event.sequence.load(std::memory_order_relaxed);
+		do {
+			if ((current & 1) || current >= sequence)
+				return;
+		} while (!event.sequence.compare_exchange_weak(current, sequence - 1, std::memory_order_relaxed));
+		std::atomic_thread_fence(std::memory_order_release);
+		event.name.store(name, std::memory_order_relaxed);
+		event.category.store(category, std::memory_order_relaxed);
+		event.start.store(start, std::memory_order_relaxed);
+		event.duration.store(duration, std::memory_order_relaxed);
+		event.id.store(id, std::memory_order_relaxed);
+		event.value.store(value, std::memory_order_relaxed);
+		event.thread.store(getThreadNumber(), std::memory_order_relaxed);
+		event.sequence.store(sequence, std::memory_order_release);
+	}
+
+	uint64_t TraceRecorder::getEventCount() const {
+		return std::min(head.load(std::memory_order_acquire), mask + 1);
+	}
+
+	void TraceRecorder::clear() {
+		for (uint64_t i = 0; i <= mask; i++)
+			events[i].sequence.store(0, std::memory_order_relaxed);
+		head.store(0, std::memory_order_release);
+	}
+
+	void TraceRecorder::write(std::ostream& stream) const {
+		struct Copy {
+			uint64_t sequence;
+			const char* name;
+			const char* category;
+			uint64_t start;
+			uint64_t duration;
+			uint32_t id;
+			uint32_t value;
+			uint32_t thread;
+		};
+		std::vector<Copy> copies;
+		copies.reserve(static_cast<size_t>(getEventCount()));
+		for (uint64_t i = 0; i <= mask; i++) {
+			auto& event = events[i];
+			auto sequence = event.sequence.load(std::memory_order_acquire);
+			// Skip empty events and those being written
+			if (!sequence || (sequence & 1))
+				continue;
+			Copy copy = {
+				sequence,
+				event.name.load(std::memory_order_relaxed),
+				event.category.load(std::memory_order_relaxed),
+				event.start.load(std::memory_order_relaxed),
+				event.duration.load(std::memory_order_relaxed),
+				event.id.load(std::memory_order_relaxed),
+				event.value.load(std::memory_order_relaxed),
+				event.thread.load(std::memory_order_relaxed)
+			};
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (event.sequence.load(std::memory_order_relaxed) == sequence)
+				copies.push_back(copy);
+		}
+		std::sort(copies.begin(), copies.end(), [](const Copy& a, const Copy& b) {
+			return a.sequence < b.sequence;
+		});
+
+		stream << "{\"traceEvents\":[";
+		bool first = true;
+		for (auto& copy : copies) {
+			if (!first)
+				stream << ",";
+			first = false;
+			stream << "\n{\"name\":\"";
+			writeEscaped(stream, copy.name);
+			if (copy.id != NONE)
+				stream << " " << copy.id;
+			stream << "\",\"cat\":\"";
+			writeEscaped(stream, copy.category);
+			stream << "\",\"ph\":\"X\",\"ts\":" << copy.start << ",\"dur\":" << copy.duration
+				<< ",\"pid\":1,\"tid\":" << copy.thread;
+			if (copy.value != NONE)
+				stream << ",\"args\":{\"value\":" << copy.value << "}";
+			stream << "}";
+		}
+		stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	}
+
+	bool TraceRecorder::save(const std::string& filename) const {
+		std::ofstream file(filename);
+		if (!file.is_open())
+			return false;
+		write(file);
+		return file.good();
+	}
+}
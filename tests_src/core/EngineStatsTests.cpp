@@ -0,0 +1,102 @@
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include "../TestBase.hpp"
+#include <ecstasy/systems/IteratingSystem.hpp>
+
+#define NS_TEST_CASE(name) TEST_CASE("EngineStats: " name)
+namespace EngineStatsTests {
+	const float deltaTime = 0.16f;
+
+	struct ComponentA : public Component<ComponentA> {};
+	struct ComponentB : public Component<ComponentB> {};
+
+	class AddComponentSystem : public IteratingSystem<AddComponentSystem> {
+	public:
+		AddComponentSystem() : IteratingSystem(Family::all<ComponentA>().get()) {}
+
+		void processEntity(Entity* entity, float deltaTime) override {
+			if (!entity->has<ComponentB>())
+				entity->emplace<ComponentB>();
+		}
+	};
+
+	NS_TEST_CASE("rollingStats") {
+		ecstasy::RollingStats stats(4);
+		REQUIRE(0 == stats.getSampleCount());
+		REQUIRE(0 == stats.getAvg());
+		REQUIRE(0 == stats.getP99());
+
+		stats.add(5);
+		stats.add(1);
+		stats.add(3);
+		REQUIRE(3 == stats.getSampleCount());
+		REQUIRE(3 == stats.getLast());
+		REQUIRE(1 == stats.getMin());
+		REQUIRE(5 == stats.getMax());
+		REQUIRE(3 == stats.getAvg());
+		REQUIRE(3 == stats.getPercentile(50));
+		REQUIRE(5 == stats.getP99());
+
+		// The oldest samples get replaced
+		stats.add(7);
+		stats.add(9);
+		REQUIRE(4 == stats.getSampleCount());
+		REQUIRE(9 == stats.getLast());
+		REQUIRE(1 == stats.getMin());
+		REQUIRE(9 == stats.getMax());
+		stats.add(2);
+		REQUIRE(2 == stats.getLast());
+		REQUIRE(2 == stats.getMin());
+		REQUIRE(9 == stats.getP99());
+		REQUIRE(2 == stats.getPercentile(0));
+	}
+
+	NS_TEST_CASE("systemStats") {
+		TEST_MEMORY_LEAK_START
+		Engine engine;
+		engine.emplaceSystem<AddComponentSystem>();
+
+		for (int i = 0; i < 5; i++) {
+			auto entity = engine.createEntity();
+			entity->emplace<ComponentA>();
+			engine.addEntity(entity);
+		}
+
+		engine.update(deltaTime);
+		engine.update(deltaTime);
+
+		auto& stats = engine.getStats();
+		auto systemStats = stats.getSystemStats<AddComponentSystem>();
+		if (ecstasy::EngineStats::isEnabled()) {
+			REQUIRE(2 == stats.getFrameTime().getSampleCount());
+			REQUIRE(systemStats);
+			REQUIRE(2 == systemStats->time.getSampleCount());
+			REQUIRE(5 == systemStats->entities.getLast());
+			REQUIRE(5 == systemStats->operations.getMax());
+			REQUIRE(0 == systemStats->operations.getLast());
+			// One componentAdded signal per delayed operation
+			REQUIRE(5 == systemStats->signals.getMax());
+			// The components added in the first frame
+			REQUIRE(5 <= stats.getFrameAllocations().getMax());
+			REQUIRE(0 == stats.getFrameAllocations().getLast());
+		} else {
+			REQUIRE(0 == stats.getFrameTime().getSampleCount());
+			REQUIRE(0 == stats.getFrameAllocations().getSampleCount());
+			REQUIRE(!systemStats);
+		}
+		TEST_MEMORY_LEAK_END
+	}
+}
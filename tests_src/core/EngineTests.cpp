@@ -15,6 +15,9 @@
  ******************************************************************************/
 #include "../TestBase.hpp"
 #include<limits>
+#include <thread>
+#include <ecstasy/systems/IteratingSystem.hpp>
+#include <ecstasy/systems/IteratingSystemFor.hpp>
 
 #define NS_TEST_CASE(name) TEST_CASE("Engine: " name)
 namespace EngineTests {
@@ -776,4 +779,488 @@ namespace EngineTests {
 		REQUIRE(memoryManager->getAllocationCount() == 0);
 		TEST_MEMORY_LEAK_END
 	}
+
+	class SlowSystem : public EntitySystem<SlowSystem> {
+	public:
+		SlowSystem() : EntitySystem(0) {}
+
+		void update(float deltaTime) override {
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+	};
+
+	class DeferrableSystem : public EntitySystem<DeferrableSystem> {
+	public:
+		std::vector<float> deltaTimes;
+
+		DeferrableSystem() : EntitySystem(1) {
+			setPriorityClass(ecstasy::PriorityClass::Deferrable);
+		}
+
+		void update(float deltaTime) override {
+			deltaTimes.push_back(deltaTime);
+		}
+	};
+
+	class ResumableSystem : public IteratingSystem<ResumableSystem> {
+	public:
+		int numUpdates = 0;
+
+		ResumableSystem() : IteratingSystem(Family::all<ComponentA>().get()) {
+			setResumable(true);
+		}
+
+		void processEntity(Entity* entity, float deltaTime) override {
+			++numUpdates;
+			if (slow)
+				std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+
+		bool slow = false;
+	};
+
+	NS_TEST_CASE("frameBudget") {
+		TEST_MEMORY_LEAK_START
+		Engine engine;
+		auto slowSystem = engine.emplaceSystem<SlowSystem>();
+		auto deferrableSystem = engine.emplaceSystem<DeferrableSystem>();
+
+		// Without a budget, update times are not measured (unless profiling)
+		engine.update(deltaTime);
+		REQUIRE(1 == deferrableSystem->deltaTimes.size());
+#ifndef ECSTASY_PROFILING
+		REQUIRE(0 == slowSystem->getLastUpdateTime());
+#endif
+
+		// The slow system exhausts the budget, so the deferrable system has to wait
+		engine.setFrameBudget(0.001f);
+		engine.update(deltaTime);
+		engine.update(deltaTime);
+		REQUIRE(1 == deferrableSystem->deltaTimes.size());
+		REQUIRE(slowSystem->getLastUpdateTime() >= 0.002f);
+
+		// The skipped time is passed on when the system runs again
+		engine.setFrameBudget(0);
+		engine.update(deltaTime);
+		REQUIRE(2 == deferrableSystem->deltaTimes.size());
+		REQUIRE(deferrableSystem->deltaTimes.back() == Approx(deltaTime * 3));
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("resumableIteratingSystem") {
+		TEST_MEMORY_LEAK_START
+		Engine engine;
+		auto system = engine.emplaceSystem<ResumableSystem>();
+
+		for (int i = 0; i < 40; i++) {
+			auto entity = engine.createEntity();
+			entity->emplace<ComponentA>();
+			engine.addEntity(entity);
+		}
+
+		// With an exhausted budget, the system processes 16 entities per update
+		system->slow = true;
+		system->setTimeBudget(0.0001f);
+		engine.update(deltaTime);
+		REQUIRE(16 == system->numUpdates);
+		engine.update(deltaTime);
+		REQUIRE(32 == system->numUpdates);
+		engine.update(deltaTime);
+		REQUIRE(40 == system->numUpdates);
+
+		system->slow = false;
+		system->setTimeBudget(0);
+		engine.update(deltaTime);
+		REQUIRE(80 == system->numUpdates);
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("componentMemoryStats") {
+		TEST_MEMORY_LEAK_START
+		Engine engine;
+		REQUIRE(engine.getComponentMemoryStats().empty());
+
+		for (int i = 0; i < 3; i++) {
+			auto entity = engine.createEntity();
+			entity->emplace<ComponentA>();
+			if (i == 0)
+				entity->emplace<ComponentB>();
+			engine.addEntity(entity);
+		}
+
+		auto stats = engine.getComponentMemoryStats();
+		auto typeA = getComponentType<ComponentA>();
+		auto typeB = getComponentType<ComponentB>();
+		auto typeC = getComponentType<ComponentC>();
+		REQUIRE(stats.size() > std::max(typeA, typeB));
+		REQUIRE(3 == stats[typeA].count);
+		REQUIRE((3 * sizeof(ComponentA)) == stats[typeA].bytes);
+		REQUIRE(1 == stats[typeB].count);
+		REQUIRE((typeC >= stats.size() || stats[typeC].count == 0));
+		TEST_MEMORY_LEAK_END
+	}
+
+	struct ValueComponent : public Component<ValueComponent> {
+		int value;
+		explicit ValueComponent(int value) : value(value) {}
+	};
+
+	class CompactDuringUpdateSystem : public EntitySystem<CompactDuringUpdateSystem> {
+	public:
+		void update(float deltaTime) override {
+			getEngine()->compactMemory();
+		}
+	};
+
+	struct PinnedComponent : public Component<PinnedComponent> {
+		PinnedComponent() {}
+		PinnedComponent(const PinnedComponent&) = delete;
+	};
+
+	class ValueSystem : public IteratingSystemFor<ValueSystem, ValueComponent> {
+	public:
+		int sum = 0;
+
+		void processEntity(Entity* entity, ValueComponent& component, float deltaTime) {
+			sum += component.value;
+		}
+	};
+
+	NS_TEST_CASE("compactMemory") {
+		TEST_MEMORY_LEAK_START
+		auto memoryManager = std::make_shared<ecstasy::DefaultMemoryManager>();
+		Engine engine(memoryManager);
+		auto system = engine.emplaceSystem<ValueSystem>();
+
+		std::vector<Entity*> entities;
+		for (int i = 0; i < 2560; i++) {
+			auto entity = engine.createEntity();
+			entity->emplace<ValueComponent>(i);
+			engine.addEntity(entity);
+			entities.push_back(entity);
+		}
+		entities[0]->emplace<PinnedComponent>();
+
+		// Keep every 16th entity
+		int expectedSum = 0;
+		for (int i = 0; i < 2560; i++) {
+			if (i % 16 == 0)
+				expectedSum += i;
+			else
+				engine.removeEntity(entities[i]);
+		}
+		auto size = sizeof(ValueComponent);
+		auto align = alignof(ValueComponent);
+		REQUIRE(40 == memoryManager->getPageCount(size, align));
+
+		int relocated = 0;
+		Signal11::ConnectionScope scope;
+		scope += engine.componentRelocated.connect([&](Entity* entity, ComponentBase* component) {
+			REQUIRE(entity->get<ValueComponent>() == component);
+			relocated++;
+		});
+
+		int calls = 1;
+		while (!engine.compactMemory(0.000001f))
+			calls++;
+		REQUIRE(calls > 1);
+		// 160 components fit into 3 pages, one page may be kept by the pinned component
+		REQUIRE(memoryManager->getPageCount(size, align) <= 4);
+		REQUIRE(relocated > 0);
+
+		system->sum = 0;
+		engine.update(deltaTime);
+		REQUIRE(expectedSum == system->sum);
+		for (int i = 0; i < 2560; i += 16)
+			REQUIRE(i == entities[i]->get<ValueComponent>()->value);
+		REQUIRE(entities[0]->has<PinnedComponent>());
+
+		// Nothing left to do
+		REQUIRE(engine.compactMemory());
+
+		bool exceptionCaught = false;
+		try {
+			engine.emplaceSystem<CompactDuringUpdateSystem>();
+			engine.update(deltaTime);
+		} catch (std::logic_error&) {
+			exceptionCaught = true;
+		}
+		REQUIRE(exceptionCaught);
+		TEST_MEMORY_LEAK_END
+	}
+
+	struct EntitySizedComponent : public Component<EntitySizedComponent> {
+		int value;
+		char padding[sizeof(Entity) - sizeof(ComponentBase) - sizeof(int)];
+		explicit EntitySizedComponent(int value) : value(value) {}
+	};
+
+	NS_TEST_CASE("compactMemoryEntitySized") {
+		TEST_MEMORY_LEAK_START
+		auto memoryManager = std::make_shared<ecstasy::DefaultMemoryManager>();
+		Engine engine(memoryManager);
+		std::vector<Entity*> entities;
+		for (int i = 0; i < 640; i++) {
+			auto entity = engine.createEntity();
+			entity->emplace<EntitySizedComponent>(i);
+			engine.addEntity(entity);
+			entities.push_back(entity);
+		}
+		for (int i = 0; i < 640; i++) {
+			if (i % 16 != 0)
+				engine.removeEntity(entities[i]);
+		}
+
+		// Components of the same size class as entities are compacted, entities stay in place
+		auto size = sizeof(EntitySizedComponent);
+		auto align = alignof(EntitySizedComponent);
+		REQUIRE(sizeof(Entity) == size);
+		REQUIRE(alignof(Entity) == align);
+		REQUIRE(10 == memoryManager->getPageCount(size, align));
+		REQUIRE(10 == memoryManager->getPageCount(sizeof(Entity), alignof(Entity), true));
+		REQUIRE(engine.compactMemory());
+		REQUIRE(1 == memoryManager->getPageCount(size, align));
+		REQUIRE(10 == memoryManager->getPageCount(sizeof(Entity), alignof(Entity), true));
+		for (int i = 0; i < 640; i += 16)
+			REQUIRE(i == entities[i]->get<EntitySizedComponent>()->value);
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("reserve") {
+		TEST_MEMORY_LEAK_START
+		auto memoryManager = std::make_shared<ecstasy::DefaultMemoryManager>();
+		Engine engine(memoryManager);
+		engine.reserve(200);
+		engine.reserveComponents<ComponentA>(200);
+		REQUIRE(4 == memoryManager->getPageCount(sizeof(Entity), alignof(Entity), true));
+		REQUIRE(4 == memoryManager->getPageCount(sizeof(ComponentA), alignof(ComponentA)));
+		REQUIRE(0 == memoryManager->getAllocationCount());
+
+		for (int i = 0; i < 200; i++) {
+			auto entity = engine.createEntity();
+			entity->emplace<ComponentA>();
+			engine.addEntity(entity);
+		}
+		REQUIRE(4 == memoryManager->getPageCount(sizeof(Entity), alignof(Entity), true));
+		REQUIRE(4 == memoryManager->getPageCount(sizeof(ComponentA), alignof(ComponentA)));
+
+		// Reserving less than available does nothing
+		engine.reserve(100);
+		REQUIRE(4 == memoryManager->getPageCount(sizeof(Entity), alignof(Entity), true));
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("bulkAddAndRemoveEntities") {
+		TEST_MEMORY_LEAK_START
+		Engine engine;
+		EntityListenerMock listenerA;
+		EntityListenerMock listenerAB;
+		EntityListenerMock listenerAll;
+
+		auto &familyA = Family::all<ComponentA>().get();
+		auto &familyAB = Family::all<ComponentA, ComponentB>().get();
+		auto familyAEntities = engine.getEntitiesFor(familyA);
+		auto familyABEntities = engine.getEntitiesFor(familyAB);
+
+		engine.getEntityAddedSignal(familyA).connect(&listenerA, &EntityListenerMock::entityAdded);
+		engine.getEntityRemovedSignal(familyA).connect(&listenerA, &EntityListenerMock::entityRemoved);
+		engine.getEntityAddedSignal(familyAB).connect(&listenerAB, &EntityListenerMock::entityAdded);
+		engine.getEntityRemovedSignal(familyAB).connect(&listenerAB, &EntityListenerMock::entityRemoved);
+		engine.entityAdded.connect(&listenerAll, &EntityListenerMock::entityAdded);
+		engine.entityRemoved.connect(&listenerAll, &EntityListenerMock::entityRemoved);
+
+		auto entitiesA = engine.createEntities<ComponentA>(100);
+		auto entitiesAB = engine.createEntities<ComponentA, ComponentB>(50);
+		REQUIRE(100 == entitiesA.size());
+		REQUIRE(50 == entitiesAB.size());
+		REQUIRE(entitiesAB.front()->has<ComponentB>());
+		REQUIRE(0 == listenerAll.addedCount);
+
+		auto single = engine.createEntity();
+		engine.addEntity(single);
+		entitiesA.push_back(engine.createEntity());
+		entitiesA.back()->emplace<ComponentC>();
+		entitiesA.insert(entitiesA.end(), entitiesAB.begin(), entitiesAB.end());
+		engine.addEntities(entitiesA);
+
+		REQUIRE(152 == engine.getEntities()->size());
+		REQUIRE(150 == familyAEntities->size());
+		REQUIRE(50 == familyABEntities->size());
+		REQUIRE(150 == listenerA.addedCount);
+		REQUIRE(50 == listenerAB.addedCount);
+		REQUIRE(152 == listenerAll.addedCount);
+		for (auto entity : entitiesA) {
+			REQUIRE(entity->isValid());
+			REQUIRE(entity == engine.getEntity(entity->getId()));
+		}
+		REQUIRE_THROWS_AS(engine.addEntities(entitiesAB), std::invalid_argument);
+
+		// Components of entities added in bulk still update the families
+		entitiesAB.front()->remove<ComponentB>();
+		REQUIRE(49 == familyABEntities->size());
+		REQUIRE(1 == listenerAB.removedCount);
+
+		std::vector<Entity*> toRemove(entitiesA.begin() + 50, entitiesA.end());
+		engine.removeEntities(toRemove);
+		REQUIRE(51 == engine.getEntities()->size());
+		REQUIRE(50 == familyAEntities->size());
+		REQUIRE(0 == familyABEntities->size());
+		REQUIRE(100 == listenerA.removedCount);
+		REQUIRE(50 == listenerAB.removedCount);
+		REQUIRE(101 == listenerAll.removedCount);
+		REQUIRE(single == engine.getEntity(single->getId()));
+		REQUIRE(!engine.getEntity(toRemove.front()->getId()));
+
+		std::vector<Entity*> foreign = { single };
+		Engine otherEngine;
+		REQUIRE_THROWS_AS(otherEngine.removeEntities(foreign), std::invalid_argument);
+
+		// Entities, which have not been added yet, are destroyed
+		auto notAdded = engine.createEntities<ComponentB>(10);
+		engine.removeEntities(notAdded);
+		REQUIRE(51 == engine.getEntities()->size());
+
+		REQUIRE(engine.createEntities(10, "missingFactory").empty());
+		engine.removeAllEntities();
+		REQUIRE(0 == engine.getMemoryManager()->getAllocationCount());
+		TEST_MEMORY_LEAK_END
+	}
+
+	class BulkSpawnSystem : public EntitySystem<BulkSpawnSystem> {
+	public:
+		std::vector<Entity*> pending;
+		bool remove = false;
+		size_t familySize = 0;
+
+		void update(float deltaTime) override {
+			if (remove)
+				getEngine()->removeEntities(pending);
+			else
+				getEngine()->addEntities(pending);
+			// The operations are delayed until the update has finished
+			familySize = getEngine()->getEntitiesFor(Family::all<ComponentA>().get())->size();
+		}
+	};
+
+	NS_TEST_CASE("bulkEntitiesDuringUpdate") {
+		TEST_MEMORY_LEAK_START
+		Engine engine;
+		auto system = engine.emplaceSystem<BulkSpawnSystem>();
+		auto familyAEntities = engine.getEntitiesFor(Family::all<ComponentA>().get());
+		system->pending = engine.createEntities<ComponentA>(20);
+
+		engine.update(deltaTime);
+		REQUIRE(0 == system->familySize);
+		REQUIRE(20 == familyAEntities->size());
+		REQUIRE(20 == engine.getEntities()->size());
+
+		system->remove = true;
+		engine.update(deltaTime);
+		REQUIRE(20 == system->familySize);
+		REQUIRE(0 == familyAEntities->size());
+		REQUIRE(0 == engine.getEntities()->size());
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("bulkRemoveKeepsQueuedRemovals") {
+		TEST_MEMORY_LEAK_START
+		Engine engine;
+		// Queued operations are processed after each system update
+		engine.emplaceSystem<CounterSystem>();
+		auto familyAEntities = engine.getEntitiesFor(Family::all<ComponentA>().get());
+		auto entities = engine.createEntities<ComponentA>(3);
+		engine.addEntities(entities);
+
+		// Removing an entity from a listener only queues the removal
+		auto queued = entities[0];
+		auto connection = engine.entityAdded.connect([&](Entity*) { engine.removeEntity(queued); });
+		engine.addEntity(engine.createEntity());
+		connection.disconnect();
+		REQUIRE(queued->isScheduledForRemoval());
+
+		engine.removeEntities({ entities[1] });
+		REQUIRE(3 == engine.getEntities()->size());
+		REQUIRE(2 == familyAEntities->size());
+
+		engine.update(deltaTime);
+		REQUIRE(2 == engine.getEntities()->size());
+		REQUIRE(1 == familyAEntities->size());
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("removeAllEntitiesOrder") {
+		TEST_MEMORY_LEAK_START
+		Engine engine;
+		auto &family = Family::all<ComponentA>().get();
+		auto familyEntities = engine.getEntitiesFor(family);
+		auto entities = engine.createEntities<ComponentA>(4);
+		engine.addEntities(entities);
+
+		// Entities are removed one by one from the back, listeners see the remaining ones
+		std::vector<Entity*> removed;
+		auto familyConnection = engine.getEntityRemovedSignal(family).connect([&](Entity* entity) {
+			REQUIRE((entities.size() - removed.size() - 1 == familyEntities->size()));
+			REQUIRE(std::find(familyEntities->begin(), familyEntities->end(), entity) == familyEntities->end());
+			REQUIRE((entities.size() - removed.size() - 1 == engine.getEntities()->size()));
+		});
+		auto connection = engine.entityRemoved.connect([&](Entity* entity) {
+			REQUIRE(!engine.getEntity(entity->getId()));
+			removed.push_back(entity);
+			for (size_t i = 0; i < engine.getEntities()->size(); i++)
+				REQUIRE((*engine.getEntities())[i] == entities[i]);
+		});
+		engine.removeAllEntities();
+		connection.disconnect();
+		familyConnection.disconnect();
+		REQUIRE(std::equal(removed.begin(), removed.end(), entities.rbegin()));
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("instantiate") {
+		TEST_MEMORY_LEAK_START
+		Engine engine;
+		EntityListenerMock listener;
+		auto &family = Family::all<ComponentA, ValueComponent>().get();
+		auto familyEntities = engine.getEntitiesFor(family);
+		engine.getEntityAddedSignal(family).connect(&listener, &EntityListenerMock::entityAdded);
+
+		auto prototype = engine.createEntity();
+		prototype->emplace<ComponentA>();
+		prototype->emplace<ValueComponent>(42);
+
+		auto clones = engine.instantiate(prototype, 100);
+		REQUIRE(100 == clones.size());
+		REQUIRE(100 == familyEntities->size());
+		REQUIRE(100 == listener.addedCount);
+		REQUIRE(100 == engine.getEntities()->size());
+		for (auto clone : clones) {
+			REQUIRE(clone->isValid());
+			REQUIRE((clone->getComponentBits() == prototype->getComponentBits()));
+			REQUIRE(clone->has<ComponentA>());
+			REQUIRE(42 == clone->get<ValueComponent>()->value);
+			REQUIRE(clone->get<ValueComponent>() != prototype->get<ValueComponent>());
+		}
+
+		// Clones are independent from the prototype
+		clones.front()->getMut<ValueComponent>()->value = 1;
+		REQUIRE(42 == prototype->get<ValueComponent>()->value);
+		clones.back()->remove<ComponentA>();
+		REQUIRE(99 == familyEntities->size());
+		REQUIRE(prototype->has<ComponentA>());
+
+		// Components, which are not copy constructible, can't be cloned
+		prototype->emplace<PinnedComponent>();
+		int componentSignals = 0;
+		Signal11::ConnectionScope scope;
+		scope += engine.componentAdded.connect([&](Entity* entity, ComponentBase* component) { componentSignals++; });
+		scope += engine.componentRemoved.connect([&](Entity* entity, ComponentBase* component) { componentSignals++; });
+		REQUIRE(engine.instantiate(prototype, 10).empty());
+		REQUIRE(100 == engine.getEntities()->size());
+		REQUIRE(0 == componentSignals);
+
+		engine.removeEntity(prototype);
+		engine.removeAllEntities();
+		REQUIRE(0 == engine.getMemoryManager()->getAllocationCount());
+		TEST_MEMORY_LEAK_END
+	}
 }
@@ -52,9 +52,13 @@ namespace FamilyTests {
 		auto &family8 = Family::all<ComponentA, ComponentB>().one<ComponentC, ComponentD>()
 			.exclude<ComponentE, ComponentF>().get();
 		auto &family9 = Family::all().get();
+		auto &family11 = Family::changed<ComponentA>().get();
+		auto &family12 = Family::all<ComponentA>().changed<ComponentA>().get();
 		auto &family10 = Family::all().get();
 
 		REQUIRE(family1 == family2);
+		REQUIRE(family11 == family12);
+		REQUIRE(family11 != family1);
 		REQUIRE(family2 == family1);
 		REQUIRE(family3 == family4);
 		REQUIRE(family4 == family3);
@@ -0,0 +1,240 @@
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include "../TestBase.hpp"
+#include <ecstasy/utils/ComponentRegistry.hpp>
+#include <sstream>
+
+#define NS_TEST_CASE(name) TEST_CASE("Snapshot: " name)
+namespace SnapshotTests {
+	struct PositionComponent : public Component<PositionComponent> {
+		float x = 0;
+		float y = 0;
+	};
+	ECS_COMPONENT_FIELDS(PositionComponent, x, y)
+
+	struct UnitComponent : public Component<UnitComponent> {
+		int health = 100;
+		std::string name;
+	};
+	ECS_COMPONENT_FIELDS(UnitComponent, health, name)
+
+	struct TagComponent : public Component<TagComponent> {};
+
+	struct Extra {
+		double padding[3] = { 0, 0, 0 };
+		virtual ~Extra() {}
+	};
+
+	// ComponentBase is not at the start of this component
+	struct VelocityComponent : public Extra, public Component<VelocityComponent> {
+		float x = 0;
+		float y = 0;
+	};
+	ECS_COMPONENT_FIELDS(VelocityComponent, x, y)
+	struct UnregisteredComponent : public Component<UnregisteredComponent> {};
+
+	void registerComponents(ComponentRegistry& registry) {
+		REQUIRE(registry.add<PositionComponent>("Position"));
+		REQUIRE(registry.add<UnitComponent>("Unit"));
+		REQUIRE(registry.add<TagComponent>("Tag"));
+	}
+
+	std::string saveWorld(Engine& engine, const ComponentRegistry& registry) {
+		std::ostringstream stream;
+		REQUIRE(engine.saveSnapshot(stream, registry).empty());
+		return stream.str();
+	}
+
+	NS_TEST_CASE("registry") {
+		ComponentRegistry registry;
+		registerComponents(registry);
+		REQUIRE(!registry.add<PositionComponent>("Position2"));
+		REQUIRE(!registry.add<UnregisteredComponent>("Unit"));
+
+		auto entry = registry.find("Unit");
+		REQUIRE(entry);
+		REQUIRE(entry == registry.get(getComponentType<UnitComponent>()));
+		REQUIRE(entry->fields == &ecstasy::getComponentFields<UnitComponent>());
+		REQUIRE(!registry.find("Tag")->fields);
+		REQUIRE(!registry.find("Unregistered"));
+		REQUIRE(!registry.get(getComponentType<UnregisteredComponent>()));
+	}
+
+	NS_TEST_CASE("save_and_load") {
+		TEST_MEMORY_LEAK_START
+		ComponentRegistry registry;
+		registerComponents(registry);
+
+		std::string data;
+		std::vector<uint64_t> ids;
+		{
+			Engine engine;
+			for (int i = 0; i < 20; i++) {
+				auto entity = engine.createEntity();
+				auto position = entity->emplace<PositionComponent>();
+				position->x = static_cast<float>(i);
+				position->y = -static_cast<float>(i);
+				if (i % 2 == 0) {
+					auto unit = entity->emplace<UnitComponent>();
+					unit->health = i * 10;
+					unit->name = "unit " + std::to_string(i);
+				}
+				if (i % 3 == 0)
+					entity->emplace<TagComponent>();
+				engine.addEntity(entity);
+			}
+			// Leave gaps in the ids
+			engine.removeEntity((*engine.getEntities())[5]);
+			engine.removeEntity((*engine.getEntities())[0]);
+			for (auto entity : *engine.getEntities())
+				ids.push_back(entity->getId());
+			data = saveWorld(engine, registry);
+		}
+
+		Engine engine;
+		auto units = engine.getEntitiesFor(Family::all<UnitComponent>().get());
+		auto tagged = engine.getEntitiesFor(Family::all<PositionComponent, TagComponent>().get());
+		int added = 0;
+		engine.entityAdded.connect([&](Entity*) { added++; });
+		int componentsAdded = 0;
+		engine.componentAdded.connect([&](Entity*, ComponentBase*) { componentsAdded++; });
+
+		// Existing entities get replaced
+		engine.addEntity(engine.createEntity());
+		std::istringstream stream(data);
+		REQUIRE(engine.loadSnapshot(stream, registry).empty());
+		REQUIRE(18 == engine.getEntities()->size());
+		REQUIRE((18 == added - 1));
+		REQUIRE(0 == componentsAdded);
+		REQUIRE(9 == units->size());
+		REQUIRE(6 == tagged->size());
+
+		for (auto id : ids) {
+			auto entity = engine.getEntity(id);
+			REQUIRE(entity);
+			auto i = static_cast<int>(entity->get<PositionComponent>()->x);
+			REQUIRE((-i == entity->get<PositionComponent>()->y));
+			REQUIRE((i % 2 == 0) == entity->has<UnitComponent>());
+			REQUIRE((i % 3 == 0) == entity->has<TagComponent>());
+			if (i % 2 == 0) {
+				REQUIRE((i * 10 == entity->get<UnitComponent>()->health));
+				REQUIRE(entity->get<UnitComponent>()->name == "unit " + std::to_string(i));
+			}
+		}
+
+		// New entities don't reuse the restored ids
+		auto entity = engine.createEntity();
+		engine.addEntity(entity);
+		REQUIRE(entity->getId() > ids.back());
+
+		// Saving the restored world gives the same snapshot, apart from the added entity
+		engine.removeEntity(entity);
+		REQUIRE(saveWorld(engine, registry).size() == data.size());
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("multiple_inheritance") {
+		TEST_MEMORY_LEAK_START
+		ComponentRegistry registry;
+		REQUIRE(registry.add<VelocityComponent>("Velocity"));
+
+		std::string data;
+		uint64_t id;
+		{
+			Engine engine;
+			auto entity = engine.createEntity();
+			auto velocity = entity->emplace<VelocityComponent>();
+			velocity->x = 1.5f;
+			velocity->y = 2.5f;
+			engine.addEntity(entity);
+			id = entity->getId();
+			data = saveWorld(engine, registry);
+		}
+
+		Engine engine;
+		std::istringstream stream(data);
+		REQUIRE(engine.loadSnapshot(stream, registry).empty());
+		auto velocity = engine.getEntity(id)->get<VelocityComponent>();
+		REQUIRE(velocity);
+		REQUIRE(static_cast<void*>(velocity) != static_cast<ComponentBase*>(velocity));
+		REQUIRE(velocity->x == 1.5f);
+		REQUIRE(velocity->y == 2.5f);
+		REQUIRE(velocity->padding[0] == 0);
+		REQUIRE(velocity->padding[2] == 0);
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("errors") {
+		TEST_MEMORY_LEAK_START
+		ComponentRegistry registry;
+		registerComponents(registry);
+
+		Engine engine;
+		auto entity = engine.createEntity();
+		entity->emplace<PositionComponent>();
+		entity->emplace<UnitComponent>()->name = "name";
+		engine.addEntity(entity);
+		auto data = saveWorld(engine, registry);
+
+		ComponentRegistry shortRegistry;
+		shortRegistry.add<PositionComponent>("Posi");
+		shortRegistry.add<UnitComponent>("Unit");
+		auto duplicate = saveWorld(engine, shortRegistry);
+		duplicate.replace(duplicate.find("Posi"), 4, "Unit");
+
+		entity = engine.createEntity();
+		entity->emplace<UnregisteredComponent>();
+		engine.addEntity(entity);
+		std::ostringstream stream;
+		REQUIRE(!engine.saveSnapshot(stream, registry).empty());
+
+		// Failed loads leave the world untouched
+		auto untagged = engine.getEntitiesFor(Family::all<PositionComponent>().exclude<TagComponent>().get());
+		REQUIRE(1 == untagged->size());
+		REQUIRE(engine.loadSnapshot("garbage", 7, registry) == "Not a snapshot");
+		REQUIRE(!engine.loadSnapshot(data.data(), data.size() - 1, registry).empty());
+		REQUIRE(!engine.loadSnapshot(data.data(), data.size() - 20, registry).empty());
+		auto longer = data + "x";
+		REQUIRE(!engine.loadSnapshot(longer.data(), longer.size(), registry).empty());
+		REQUIRE(2 == engine.getEntities()->size());
+		REQUIRE(engine.loadSnapshot(duplicate.data(), duplicate.size(), shortRegistry)
+			== "Component type 'Unit' is listed twice");
+		REQUIRE(2 == engine.getEntities()->size());
+
+		ComponentRegistry partialRegistry;
+		partialRegistry.add<PositionComponent>("Position");
+		REQUIRE(engine.loadSnapshot(data.data(), data.size(), partialRegistry)
+			== "Component type 'Unit' has not been registered");
+		REQUIRE(2 == engine.getEntities()->size());
+
+		// A string length pointing past the payload
+		auto corrupt = data;
+		auto namePosition = corrupt.find("name");
+		REQUIRE(namePosition != std::string::npos);
+		corrupt[namePosition - 4] = 100;
+		REQUIRE(engine.loadSnapshot(corrupt.data(), corrupt.size(), registry)
+			== "Component data of 'Unit' is truncated");
+		REQUIRE(2 == engine.getEntities()->size());
+		REQUIRE(1 == untagged->size());
+		REQUIRE((*untagged)[0] == (*engine.getEntities())[0]);
+
+		REQUIRE(engine.loadSnapshot(data.data(), data.size(), registry).empty());
+		REQUIRE(1 == engine.getEntities()->size());
+		REQUIRE(1 == untagged->size());
+		REQUIRE((*engine.getEntities())[0]->get<UnitComponent>()->name == "name");
+		TEST_MEMORY_LEAK_END
+	}
+}
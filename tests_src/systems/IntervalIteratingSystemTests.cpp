@@ -15,6 +15,7 @@
  ******************************************************************************/
 #include "../TestBase.hpp"
 #include <ecstasy/systems/IntervalIteratingSystem.hpp>
+#include <thread>
 
 #define NS_TEST_CASE(name) TEST_CASE("IntervalIteratingSystem: " name)
 namespace IntervalIteratingSystemTests {
@@ -36,6 +37,47 @@ namespace IntervalIteratingSystemTests {
 		}
 	};
 
+	class SlowIntervalIteratingSystemSpy : public IntervalIteratingSystem<SlowIntervalIteratingSystemSpy> {
+	public:
+		SlowIntervalIteratingSystemSpy ()
+			: IntervalIteratingSystem(Family::all<IntervalComponentSpy>().get(), deltaTime * 2.0f) {
+		}
+
+	protected:
+		void processEntity (Entity* entity) override {
+			entity->get<IntervalComponentSpy>()->numUpdates++;
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	};
+
+	class StaticIntervalIteratingSystemSpy : public StaticIntervalIteratingSystem<StaticIntervalIteratingSystemSpy> {
+	public:
+		StaticIntervalIteratingSystemSpy ()
+			: StaticIntervalIteratingSystem(Family::all<IntervalComponentSpy>().get(), deltaTime * 2.0f) {
+		}
+
+		void processEntity (Entity* entity) {
+			entity->get<IntervalComponentSpy>()->numUpdates++;
+		}
+	};
+
+	class ChangedIntervalIteratingSystem : public IntervalIteratingSystem<ChangedIntervalIteratingSystem> {
+	public:
+		bool modify = false;
+		int processed = 0;
+
+		ChangedIntervalIteratingSystem ()
+			: IntervalIteratingSystem(Family::changed<IntervalComponentSpy>().get(), deltaTime * 2.0f) {
+		}
+
+	protected:
+		void processEntity (Entity* entity) override {
+			processed++;
+			if (modify)
+				entity->getMut<IntervalComponentSpy>()->numUpdates++;
+		}
+	};
+
 	NS_TEST_CASE("intervalIteratingSystem") {
 		TEST_MEMORY_LEAK_START
 		Engine engine;
@@ -58,4 +100,147 @@ namespace IntervalIteratingSystemTests {
 		}
 		TEST_MEMORY_LEAK_END
 	}
+
+	NS_TEST_CASE("staticIntervalIteratingSystem") {
+		TEST_MEMORY_LEAK_START
+		Engine engine;
+		auto entities = engine.getEntitiesFor(Family::all<IntervalComponentSpy>().get());
+
+		engine.emplaceSystem<StaticIntervalIteratingSystemSpy>();
+
+		for (int i = 0; i < 10; ++i) {
+			auto entity = engine.createEntity();
+			entity->emplace<IntervalComponentSpy>();
+			engine.addEntity(entity);
+		}
+
+		for (int i = 1; i <= 10; ++i) {
+			engine.update(deltaTime);
+
+			for (auto e : *entities) {
+				REQUIRE((i / 2) == e->get<IntervalComponentSpy>()->numUpdates);
+			}
+		}
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("staggeredIntervalIteratingSystem") {
+		TEST_MEMORY_LEAK_START
+		Engine engine;
+		auto entities = engine.getEntitiesFor(Family::all<IntervalComponentSpy>().get());
+
+		auto system = engine.emplaceSystem<IntervalIteratingSystemSpy>();
+		system->setStaggered(true);
+		REQUIRE(system->isStaggered());
+
+		for (int i = 0; i < 10; ++i) {
+			auto entity = engine.createEntity();
+			entity->emplace<IntervalComponentSpy>();
+			engine.addEntity(entity);
+		}
+
+		for (int i = 1; i <= 10; ++i) {
+			engine.update(deltaTime);
+
+			// Half of the entities get processed each frame
+			int total = 0;
+			for (auto e : *entities) {
+				int updates = e->get<IntervalComponentSpy>()->numUpdates;
+				REQUIRE(updates >= (i / 2));
+				REQUIRE(updates <= ((i + 1) / 2));
+				total += updates;
+			}
+			REQUIRE((i * 5) == total);
+		}
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("staggeredTimeBudget") {
+		TEST_MEMORY_LEAK_START
+		Engine engine;
+		auto entities = engine.getEntitiesFor(Family::all<IntervalComponentSpy>().get());
+
+		// Each entity takes longer than the budget
+		auto system = engine.emplaceSystem<SlowIntervalIteratingSystemSpy>();
+		system->setStaggered(true);
+		system->setTimeBudget(0.0001f);
+
+		for (int i = 0; i < 10; ++i) {
+			auto entity = engine.createEntity();
+			entity->emplace<IntervalComponentSpy>();
+			engine.addEntity(entity);
+		}
+
+		// With an exhausted budget, only one entity gets processed per frame
+		for (int i = 1; i <= 10; ++i) {
+			engine.update(deltaTime);
+			int total = 0;
+			for (auto e : *entities)
+				total += e->get<IntervalComponentSpy>()->numUpdates;
+			REQUIRE(i == total);
+		}
+		for (auto e : *entities)
+			REQUIRE(1 == e->get<IntervalComponentSpy>()->numUpdates);
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("changedFamily") {
+		TEST_MEMORY_LEAK_START
+		Engine engine;
+		auto system = engine.emplaceSystem<ChangedIntervalIteratingSystem>();
+		system->modify = true;
+
+		std::vector<Entity*> entities;
+		for (int i = 0; i < 4; ++i) {
+			auto entity = engine.createEntity();
+			entity->emplace<IntervalComponentSpy>();
+			engine.addEntity(entity);
+			entities.push_back(entity);
+		}
+
+		// New entities are processed once, the changes made by the system itself are not seen again
+		engine.update(deltaTime);
+		engine.update(deltaTime);
+		REQUIRE(4 == system->processed);
+		engine.update(deltaTime);
+		engine.update(deltaTime);
+		REQUIRE(4 == system->processed);
+
+		entities[2]->getMut<IntervalComponentSpy>();
+		engine.update(deltaTime);
+		engine.update(deltaTime);
+		REQUIRE(5 == system->processed);
+		REQUIRE(2 == entities[2]->get<IntervalComponentSpy>()->numUpdates);
+		REQUIRE(1 == entities[3]->get<IntervalComponentSpy>()->numUpdates);
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("staggeredChangedFamily") {
+		TEST_MEMORY_LEAK_START
+		Engine engine;
+		auto system = engine.emplaceSystem<ChangedIntervalIteratingSystem>();
+		system->setStaggered(true);
+
+		std::vector<Entity*> entities;
+		for (int i = 0; i < 4; ++i) {
+			auto entity = engine.createEntity();
+			entity->emplace<IntervalComponentSpy>();
+			engine.addEntity(entity);
+			entities.push_back(entity);
+		}
+
+		// Each cycle only processes the entities changed since the previous cycle started
+		engine.update(deltaTime);
+		engine.update(deltaTime);
+		REQUIRE(4 == system->processed);
+		engine.update(deltaTime);
+		engine.update(deltaTime);
+		REQUIRE(4 == system->processed);
+
+		entities[1]->getMut<IntervalComponentSpy>();
+		engine.update(deltaTime);
+		engine.update(deltaTime);
+		REQUIRE(5 == system->processed);
+		TEST_MEMORY_LEAK_END
+	}
 }
@@ -32,6 +32,23 @@ namespace IntervalSystemTests {
 		}
 	};
 
+	class BatchedIntervalSystemSpy : public IntervalSystem<BatchedIntervalSystemSpy> {
+	public:
+		int numUpdates = 0;
+		std::vector<uint32_t> batches;
+
+		BatchedIntervalSystemSpy() : IntervalSystem(deltaTime) {}
+
+	protected:
+		void updateInterval () override {
+			++numUpdates;
+		}
+
+		void updateIntervals(uint32_t steps) override {
+			batches.push_back(steps);
+		}
+	};
+
 	NS_TEST_CASE("intervalSystem") {
 		TEST_MEMORY_LEAK_START
 		Engine engine;
@@ -43,4 +60,36 @@ namespace IntervalSystemTests {
 		}
 		TEST_MEMORY_LEAK_END
 	}
+
+	NS_TEST_CASE("maxStepsPerFrame") {
+		TEST_MEMORY_LEAK_START
+		Engine engine;
+		auto intervalSystemSpy = engine.emplaceSystem<IntervalSystemSpy>();
+		intervalSystemSpy->setMaxStepsPerFrame(3);
+		REQUIRE(3 == intervalSystemSpy->getMaxStepsPerFrame());
+
+		// A hitch of 10 intervals only processes 3, the rest is dropped
+		engine.update(deltaTime * 20.5f);
+		REQUIRE(3 == intervalSystemSpy->numUpdates);
+		REQUIRE(intervalSystemSpy->getAlpha() == Approx(0.25f));
+
+		engine.update(deltaTime * 2.5f);
+		REQUIRE(4 == intervalSystemSpy->numUpdates);
+		REQUIRE(intervalSystemSpy->getAlpha() == Approx(0.5f));
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("batchedIntervals") {
+		TEST_MEMORY_LEAK_START
+		Engine engine;
+		auto system = engine.emplaceSystem<BatchedIntervalSystemSpy>();
+
+		engine.update(deltaTime * 0.5f);
+		engine.update(deltaTime * 3.75f);
+		engine.update(deltaTime);
+		REQUIRE(0 == system->numUpdates);
+		REQUIRE(std::vector<uint32_t>({ 4, 1 }) == system->batches);
+		REQUIRE(system->getAlpha() == Approx(0.25f));
+		TEST_MEMORY_LEAK_END
+	}
 }
@@ -0,0 +1,95 @@
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include "../TestBase.hpp"
+#include <ecstasy/systems/IteratingSystemFor.hpp>
+
+#define NS_TEST_CASE(name) TEST_CASE("IteratingSystemFor: " name)
+namespace IteratingSystemForTests {
+	const float deltaTime = 0.5f;
+
+	struct PositionComponent : public Component<PositionComponent> {
+		float x = 0;
+	};
+
+	struct VelocityComponent : public Component<VelocityComponent> {
+		float x;
+		VelocityComponent(float x) : x(x) {}
+	};
+
+	class MovementSystem : public IteratingSystemFor<MovementSystem, PositionComponent, VelocityComponent> {
+	public:
+		int numUpdates = 0;
+
+		void processEntity(Entity* entity, PositionComponent& position, VelocityComponent& velocity, float deltaTime) {
+			REQUIRE(entity->get<PositionComponent>() == &position);
+			REQUIRE(entity->get<VelocityComponent>() == &velocity);
+			position.x += velocity.x * deltaTime;
+			++numUpdates;
+		}
+	};
+
+	class RemovalSystem : public IteratingSystemFor<RemovalSystem, VelocityComponent> {
+	public:
+		void processEntity(Entity* entity, VelocityComponent& velocity, float deltaTime) {
+			if (velocity.x < 0)
+				entity->remove<VelocityComponent>();
+		}
+	};
+
+	NS_TEST_CASE("typedComponents") {
+		TEST_MEMORY_LEAK_START
+		Engine engine;
+
+		auto a = engine.createEntity();
+		a->emplace<PositionComponent>();
+		a->emplace<VelocityComponent>(2.0f);
+		engine.addEntity(a);
+
+		auto system = engine.emplaceSystem<MovementSystem>();
+		engine.emplaceSystem<RemovalSystem>();
+		REQUIRE(1 == system->getEntityCount());
+
+		auto b = engine.createEntity();
+		b->emplace<PositionComponent>();
+		b->emplace<VelocityComponent>(-1.0f);
+		engine.addEntity(b);
+
+		auto c = engine.createEntity();
+		c->emplace<PositionComponent>();
+		engine.addEntity(c);
+		REQUIRE(2 == system->getEntityCount());
+
+		engine.update(deltaTime);
+		REQUIRE(2 == system->numUpdates);
+		REQUIRE(1.0f == a->get<PositionComponent>()->x);
+		REQUIRE(-0.5f == b->get<PositionComponent>()->x);
+		REQUIRE(1 == system->getEntityCount());
+
+		// Replacing a component must update the cached pointer
+		a->emplace<VelocityComponent>(4.0f);
+		c->emplace<VelocityComponent>(1.0f);
+		engine.update(deltaTime);
+		REQUIRE(4 == system->numUpdates);
+		REQUIRE(3.0f == a->get<PositionComponent>()->x);
+		REQUIRE(0.5f == c->get<PositionComponent>()->x);
+
+		engine.removeEntity(a);
+		engine.update(deltaTime);
+		REQUIRE(5 == system->numUpdates);
+		REQUIRE(1.0f == c->get<PositionComponent>()->x);
+		TEST_MEMORY_LEAK_END
+	}
+}
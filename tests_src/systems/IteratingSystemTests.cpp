@@ -39,12 +39,44 @@ namespace IteratingSystemTests {
 		int updates = 0;
 	};
 
+	class StaticIteratingSystemSpy : public StaticIteratingSystem<StaticIteratingSystemSpy> {
+	public:
+		StaticIteratingSystemSpy() : StaticIteratingSystem(Family::all<SpyComponent>().get()) {}
+
+		void processEntity(Entity* entity, float deltaTime) {
+			entity->get<SpyComponent>()->updates++;
+		}
+	};
+
 	struct IndexComponent : public Component<IndexComponent> {
 		int index;
 
 		IndexComponent(int index=0) : index(index) {}
 	};
 
+	class ChangedIndexSystem : public IteratingSystem<ChangedIndexSystem> {
+	public:
+		std::vector<int> processed;
+
+		ChangedIndexSystem() : IteratingSystem(Family::changed<IndexComponent>().get(), 1) {}
+
+		void processEntity(Entity* entity, float deltaTime) override {
+			processed.push_back(entity->get<IndexComponent>()->index);
+		}
+	};
+
+	class ModifyIndexSystem : public IteratingSystem<ModifyIndexSystem> {
+	public:
+		int modulo = 0;
+
+		ModifyIndexSystem() : IteratingSystem(Family::all<IndexComponent>().get(), 0) {}
+
+		void processEntity(Entity* entity, float deltaTime) override {
+			if (modulo && entity->get<IndexComponent>()->index % modulo == 0)
+				entity->getMut<IndexComponent>();
+		}
+	};
+
 	class IteratingComponentRemovalSystem : public IteratingSystem<IteratingComponentRemovalSystem> {
 	public:
 		IteratingComponentRemovalSystem ()
@@ -174,4 +206,65 @@ namespace IteratingSystemTests {
 		}
 		TEST_MEMORY_LEAK_END
 	}
+
+	NS_TEST_CASE("changedComponents") {
+		TEST_MEMORY_LEAK_START
+		Engine engine;
+		auto modifySystem = engine.emplaceSystem<ModifyIndexSystem>();
+		auto changedSystem = engine.emplaceSystem<ChangedIndexSystem>();
+
+		std::vector<Entity*> entities;
+		for (int i = 0; i < 6; ++i) {
+			auto e = engine.createEntity();
+			e->emplace<IndexComponent>(i);
+			engine.addEntity(e);
+			entities.push_back(e);
+		}
+
+		// Newly added components count as changed
+		engine.update(deltaTime);
+		REQUIRE(6 == changedSystem->processed.size());
+
+		changedSystem->processed.clear();
+		engine.update(deltaTime);
+		REQUIRE(changedSystem->processed.empty());
+
+		// Changes made by an earlier system in the same frame
+		modifySystem->modulo = 3;
+		engine.update(deltaTime);
+		REQUIRE(std::vector<int>({ 0, 3 }) == changedSystem->processed);
+
+		// Changes made outside of update
+		modifySystem->modulo = 0;
+		changedSystem->processed.clear();
+		entities[4]->getMut<IndexComponent>();
+		entities[5]->get<IndexComponent>();
+		engine.update(deltaTime);
+		REQUIRE(std::vector<int>({ 4 }) == changedSystem->processed);
+
+		// A component replaced by a new instance is changed
+		changedSystem->processed.clear();
+		entities[1]->emplace<IndexComponent>(7);
+		engine.update(deltaTime);
+		REQUIRE(std::vector<int>({ 7 }) == changedSystem->processed);
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("staticIteratingSystem") {
+		TEST_MEMORY_LEAK_START
+		Engine engine;
+		engine.emplaceSystem<StaticIteratingSystemSpy>();
+
+		auto a = engine.createEntity();
+		a->emplace<SpyComponent>();
+		engine.addEntity(a);
+		auto b = engine.createEntity();
+		b->emplace<ComponentA>();
+		engine.addEntity(b);
+
+		engine.update(deltaTime);
+		engine.update(deltaTime);
+		REQUIRE(2 == a->get<SpyComponent>()->updates);
+		TEST_MEMORY_LEAK_END
+	}
 }
@@ -0,0 +1,152 @@
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include "../TestBase.hpp"
+#include <ecstasy/systems/RadixSortedIteratingSystem.hpp>
+#include <deque>
+
+#define NS_TEST_CASE(name) TEST_CASE("RadixSortedIteratingSystem: " name)
+namespace RadixSortedIteratingSystemTests {
+	struct OrderComponent : public Component<OrderComponent> {
+		std::string name;
+		float depth;
+		OrderComponent(std::string name, float depth) : name(name), depth(depth) {}
+	};
+
+	struct DepthKey {
+		float operator () (Entity* entity) {
+			return entity->get<OrderComponent>()->depth;
+		}
+	};
+
+	class RadixSortedIteratingSystemMock : public RadixSortedIteratingSystem<RadixSortedIteratingSystemMock, DepthKey> {
+	public:
+		std::deque<std::string> expectedNames;
+
+		RadixSortedIteratingSystemMock(const Family& family = Family::all<OrderComponent>().get())
+			: RadixSortedIteratingSystem(family, DepthKey()) {}
+
+		void update(float deltaTime) override {
+			RadixSortedIteratingSystem::update(deltaTime);
+			REQUIRE(expectedNames.empty());
+		}
+
+		void processEntity(Entity* entity, float deltaTime) override {
+			auto component = entity->get<OrderComponent>();
+			REQUIRE(component);
+			REQUIRE(!expectedNames.empty());
+			REQUIRE(expectedNames.front() == component->name);
+			expectedNames.pop_front();
+		}
+	};
+
+	Entity* createOrderEntity(std::string name, float depth, Engine &engine) {
+		auto e = engine.createEntity();
+		e->emplace<OrderComponent>(name, depth);
+		return e;
+	}
+
+	NS_TEST_CASE("radixKeys") {
+		REQUIRE(ecstasy::RadixKey<int>::get(-5) < ecstasy::RadixKey<int>::get(-1));
+		REQUIRE(ecstasy::RadixKey<int>::get(-1) < ecstasy::RadixKey<int>::get(0));
+		REQUIRE(ecstasy::RadixKey<int>::get(0) < ecstasy::RadixKey<int>::get(3));
+		REQUIRE(ecstasy::RadixKey<int64_t>::get(-10000000000ll) < ecstasy::RadixKey<int64_t>::get(10));
+		REQUIRE(ecstasy::RadixKey<uint16_t>::get(2) < ecstasy::RadixKey<uint16_t>::get(60000));
+		REQUIRE(ecstasy::RadixKey<float>::get(-2.5f) < ecstasy::RadixKey<float>::get(-1.0f));
+		REQUIRE(ecstasy::RadixKey<float>::get(-1.0f) < ecstasy::RadixKey<float>::get(0.0f));
+		REQUIRE(ecstasy::RadixKey<float>::get(0.0f) < ecstasy::RadixKey<float>::get(0.5f));
+		REQUIRE(ecstasy::RadixKey<double>::get(-0.5) < ecstasy::RadixKey<double>::get(1e20));
+	}
+
+	NS_TEST_CASE("radixSort") {
+		std::vector<std::pair<uint32_t, int>> items;
+		std::vector<std::pair<uint32_t, int>> buffer;
+		for (int i = 0; i < 1000; i++)
+			items.emplace_back(ecstasy::RadixKey<int>::get((i * 7919) % 1000 - 500), i);
+		ecstasy::radixSort(items, buffer);
+		for (size_t i = 1; i < items.size(); i++)
+			REQUIRE(items[i - 1].first <= items[i].first);
+	}
+
+	NS_TEST_CASE("entityOrder") {
+		TEST_MEMORY_LEAK_START
+		Engine engine;
+		auto system = engine.emplaceSystem<RadixSortedIteratingSystemMock>();
+
+		auto a = createOrderEntity("A", -1.5f, engine);
+		auto b = createOrderEntity("B", 0.0f, engine);
+		auto c = createOrderEntity("C", 3.25f, engine);
+		auto d = createOrderEntity("D", 2.0f, engine);
+
+		engine.addEntity(c);
+		engine.addEntity(b);
+		engine.addEntity(a);
+		system->expectedNames = { "A", "B", "C" };
+		engine.update(0);
+
+		engine.addEntity(d);
+		system->expectedNames = { "A", "B", "D", "C" };
+		engine.update(0);
+
+		engine.removeEntity(b);
+		system->expectedNames = { "A", "D", "C" };
+		engine.update(0);
+
+		// Re-adding an entity before the removal has been compacted
+		d->remove<OrderComponent>();
+		d->emplace<OrderComponent>("D", -2.0f);
+		system->expectedNames = { "D", "A", "C" };
+		engine.update(0);
+
+		a->get<OrderComponent>()->depth = 10.0f;
+		c->get<OrderComponent>()->depth = -10.0f;
+		system->forceSort();
+		system->expectedNames = { "C", "D", "A" };
+		engine.update(0);
+		REQUIRE(system->getEntities()->size() == 3);
+
+		// Adding an entity extracts the keys of all entities again
+		a->get<OrderComponent>()->depth = -20.0f;
+		engine.addEntity(createOrderEntity("E", 0.0f, engine));
+		system->expectedNames = { "A", "C", "D", "E" };
+		engine.update(0);
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("changedFamily") {
+		TEST_MEMORY_LEAK_START
+		Engine engine;
+		auto system = engine.emplaceSystem<RadixSortedIteratingSystemMock>(Family::changed<OrderComponent>().get());
+
+		auto a = createOrderEntity("A", 1.0f, engine);
+		auto b = createOrderEntity("B", 2.0f, engine);
+		auto c = createOrderEntity("C", 3.0f, engine);
+		engine.addEntity(c);
+		engine.addEntity(a);
+		engine.addEntity(b);
+		system->expectedNames = { "A", "B", "C" };
+		engine.update(0);
+
+		// Only changed entities are processed, in sorted order
+		engine.update(0);
+		c->getMut<OrderComponent>();
+		b->getMut<OrderComponent>();
+		system->expectedNames = { "B", "C" };
+		engine.update(0);
+		engine.update(0);
+		REQUIRE(3 == system->getEntities()->size());
+		TEST_MEMORY_LEAK_END
+	}
+}
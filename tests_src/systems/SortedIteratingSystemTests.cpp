@@ -57,7 +57,9 @@ namespace SortedIteratingSystemTests {
 	public:
 		std::deque<std::string> expectedNames;
 
-		SortedIteratingSystemMock(const Family &family) : SortedIteratingSystem(family, Less()) {}
+		SortedIteratingSystemMock(const Family &family, SortMode mode = SortMode::Full) : SortedIteratingSystem(family, Less()) {
+			setSortMode(mode);
+		}
 
 		void update(float deltaTime) override {
 			SortedIteratingSystem::update(deltaTime);
@@ -73,6 +75,17 @@ namespace SortedIteratingSystemTests {
 		}
 	};
 
+	class StaticSortedIteratingSystemMock : public StaticSortedIteratingSystem<StaticSortedIteratingSystemMock, Less> {
+	public:
+		std::vector<std::string> names;
+
+		StaticSortedIteratingSystemMock() : StaticSortedIteratingSystem(Family::all<OrderComponent>().get(), Less()) {}
+
+		void processEntity(Entity* entity, float deltaTime) {
+			names.push_back(entity->get<OrderComponent>()->name);
+		}
+	};
+
 	class IteratingComponentRemovalSystem : public SortedIteratingSystem<IteratingComponentRemovalSystem, Less> {
 	public:
 		IteratingComponentRemovalSystem()
@@ -242,4 +255,108 @@ class IteratingRemovalSystem : public SortedIteratingSystem<IteratingRemovalSyst
 		engine.update(0);
 		TEST_MEMORY_LEAK_END
 	}
+
+	NS_TEST_CASE("incrementalEntityOrder") {
+		TEST_MEMORY_LEAK_START
+		Engine engine;
+
+		auto &family = Family::all<OrderComponent>().get();
+		auto system = engine.emplaceSystem<SortedIteratingSystemMock>(family, SortMode::Incremental);
+		REQUIRE(system->getSortMode() == SortMode::Incremental);
+
+		auto a = createOrderEntity("A", 0, engine);
+		auto b = createOrderEntity("B", 2, engine);
+		auto c = createOrderEntity("C", 4, engine);
+		auto d = createOrderEntity("D", 1, engine);
+		auto e = createOrderEntity("E", 3, engine);
+
+		engine.addEntity(c);
+		engine.addEntity(a);
+		engine.addEntity(b);
+		system->expectedNames = { "A", "B", "C" };
+		engine.update(0);
+
+		// Merge a batch of new entities into the sorted list
+		engine.addEntity(e);
+		engine.addEntity(d);
+		system->expectedNames = { "A", "D", "B", "E", "C" };
+		engine.update(0);
+
+		// Removed entities get compacted out of the list
+		engine.removeEntity(b);
+		d->remove<OrderComponent>();
+		system->expectedNames = { "A", "E", "C" };
+		engine.update(0);
+
+		// Re-adding a removed entity before the next update
+		auto f = createOrderEntity("F", 5, engine);
+		engine.addEntity(f);
+		engine.removeEntity(a);
+		f->remove<OrderComponent>();
+		f->emplace<OrderComponent>("F", -1);
+		system->expectedNames = { "F", "E", "C" };
+		engine.update(0);
+
+		// Nearly sorted and completely reversed orders
+		e->get<OrderComponent>()->zLayer = 10;
+		system->forceSort();
+		system->expectedNames = { "F", "C", "E" };
+		engine.update(0);
+
+		for (int i = 0; i < 20; i++)
+			engine.addEntity(createOrderEntity(std::to_string(i), 100 + i, engine));
+		for (auto entity : *system->getEntities())
+			entity->get<OrderComponent>()->zLayer = -entity->get<OrderComponent>()->zLayer;
+		system->forceSort();
+		for (int i = 19; i >= 0; i--)
+			system->expectedNames.push_back(std::to_string(i));
+		system->expectedNames.push_back("E");
+		system->expectedNames.push_back("C");
+		system->expectedNames.push_back("F");
+		engine.update(0);
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("changedFamily") {
+		TEST_MEMORY_LEAK_START
+		Engine engine;
+		auto system = engine.emplaceSystem<SortedIteratingSystemMock>(Family::changed<OrderComponent>().get());
+
+		auto a = engine.createEntity();
+		a->emplace<OrderComponent>("A", 0);
+		auto b = engine.createEntity();
+		b->emplace<OrderComponent>("B", 1);
+		auto c = engine.createEntity();
+		c->emplace<OrderComponent>("C", 2);
+		engine.addEntity(c);
+		engine.addEntity(a);
+		engine.addEntity(b);
+
+		system->expectedNames = { "A", "B", "C" };
+		engine.update(deltaTime);
+
+		// Only changed entities are processed, in sorted order
+		engine.update(deltaTime);
+		c->getMut<OrderComponent>();
+		a->getMut<OrderComponent>();
+		system->expectedNames = { "A", "C" };
+		engine.update(deltaTime);
+		engine.update(deltaTime);
+
+		engine.removeAllEntities();
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("staticEntityOrder") {
+		TEST_MEMORY_LEAK_START
+		Engine engine;
+		auto system = engine.emplaceSystem<StaticSortedIteratingSystemMock>();
+
+		engine.addEntity(createOrderEntity("C", 2, engine));
+		engine.addEntity(createOrderEntity("A", 0, engine));
+		engine.addEntity(createOrderEntity("B", 1, engine));
+		engine.update(0);
+		REQUIRE(std::vector<std::string>({ "A", "B", "C" }) == system->names);
+		TEST_MEMORY_LEAK_END
+	}
 }
@@ -0,0 +1,90 @@
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include "../TestBase.hpp"
+#include <ecstasy/utils/BlueprintLoader.hpp>
+#include <ecstasy/utils/ComponentFactory.hpp>
+#include <ecstasy/utils/EntityFactory.hpp>
+
+#define NS_TEST_CASE(name) TEST_CASE("BlueprintLoader: " name)
+namespace BlueprintLoaderTests {
+	struct MarkerComponent : public Component<MarkerComponent> {};
+
+	std::shared_ptr<EntityFactory> createFactory() {
+		auto factory = std::make_shared<EntityFactory>();
+		factory->addComponentFactory<SimpleComponentFactory<MarkerComponent>>("Position");
+		factory->addComponentFactory<SimpleComponentFactory<MarkerComponent>>("Render");
+		factory->addComponentFactory<SimpleComponentFactory<MarkerComponent>>("Label");
+		factory->addComponentFactory<SimpleComponentFactory<MarkerComponent>>("Marker");
+		return factory;
+	}
+
+	NS_TEST_CASE("test_directory") {
+		TEST_MEMORY_LEAK_START
+		auto factory = createFactory();
+		BlueprintLoader loader(4);
+		REQUIRE(loader.addDirectory("tests_assets").empty());
+		REQUIRE(9 == loader.getFileCount());
+
+		auto error = loader.load(*factory);
+		REQUIRE(0 == loader.getFileCount());
+		REQUIRE(error ==
+			"tests_assets/bad_command.def: Line 1: unknown command 'whoops'\n"
+			"tests_assets/bad_insufficient_parameters.def: Line 1: expected exactly one argument to 'add'\n"
+			"tests_assets/bad_insufficient_parameters2.def: Line 2: expected exactly two arguments to 'set'\n"
+			"tests_assets/bad_open_quote.def: Line 2: quote has not been closed\n"
+			"tests_assets/bad_too_many_parameters.def: Line 1: expected exactly one argument to 'add'\n"
+			"tests_assets/bad_too_many_parameters2.def: Line 2: expected exactly two arguments to 'set'\n"
+			"tests_assets/bad_wrong_order.def: Line 1: 'add' must be called before 'set'\n");
+
+		// The valid files have been added nonetheless
+		Engine engine;
+		engine.setEntityFactory(factory);
+		auto entity = engine.assembleEntity("good");
+		REQUIRE(entity);
+		engine.addEntity(entity);
+		entity = engine.assembleEntity("good_defaults");
+		REQUIRE(entity);
+		engine.addEntity(entity);
+		REQUIRE(!engine.assembleEntity("bad_command"));
+
+		REQUIRE(loader.addDirectory("tests_assets/missing") == "Can't open directory tests_assets/missing");
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("test_manifest") {
+		TEST_MEMORY_LEAK_START
+		auto factory = createFactory();
+		BlueprintLoader loader;
+		REQUIRE(loader.addManifest("tests_assets/blueprints.manifest").empty());
+		REQUIRE(3 == loader.getFileCount());
+		REQUIRE(loader.load(*factory) == "tests_assets/bad_command.def: Line 1: unknown command 'whoops'\n");
+
+		Engine engine;
+		engine.setEntityFactory(factory);
+		auto entity = engine.assembleEntity("defaults");
+		REQUIRE(entity);
+		engine.addEntity(entity);
+		REQUIRE(!engine.assembleEntity("broken"));
+
+		REQUIRE(loader.addManifest("tests_assets/bad_manifest.manifest")
+			== "tests_assets/bad_manifest.manifest: Line 1: expected a blueprint name and a filename");
+		REQUIRE(loader.addManifest("tests_assets/missing.manifest") == "Can't open file tests_assets/missing.manifest");
+
+		// Nothing to load
+		REQUIRE(loader.load(*factory).empty());
+		TEST_MEMORY_LEAK_END
+	}
+}
@@ -0,0 +1,148 @@
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include "../TestBase.hpp"
+#include <ecstasy/utils/Blueprint.hpp>
+#include <ecstasy/utils/BlueprintPack.hpp>
+#include <ecstasy/utils/BlueprintParser.hpp>
+#include <ecstasy/utils/ComponentFactory.hpp>
+#include <ecstasy/utils/EntityFactory.hpp>
+#include <cstdio>
+#include <fstream>
+
+#define NS_TEST_CASE(name) TEST_CASE("BlueprintPack: " name)
+namespace BlueprintPackTests {
+	const char* const PACK_FILE = "blueprint_pack_test.bin";
+
+	struct PositionComponent : public Component<PositionComponent> {
+		float x = 0;
+		float y = 0;
+	};
+
+	struct MarkerComponent : public Component<MarkerComponent> {};
+
+	class PositionComponentFactory : public ComponentFactory {
+	public:
+		bool assemble(Entity* entity, ComponentBlueprint& blueprint) override {
+			auto comp = entity->emplace<PositionComponent>();
+			comp->x = blueprint.getFloat("x", 1);
+			comp->y = blueprint.getFloat("y", 2);
+			return true;
+		}
+	};
+
+	NS_TEST_CASE("convert_and_read") {
+		auto error = ecstasy::convertBlueprints({
+			{ "good", "tests_assets/good.def" },
+			{ "defaults", "tests_assets/good_defaults.def" }
+		}, PACK_FILE);
+		REQUIRE(error.empty());
+
+		BlueprintPack pack;
+		REQUIRE(pack.open(PACK_FILE).empty());
+		REQUIRE(2 == pack.getBlueprintCount());
+		REQUIRE(pack.getBlueprintName(0) == "defaults");
+		REQUIRE(pack.getBlueprintName(1) == "good");
+		REQUIRE(1 == pack.find("good"));
+		REQUIRE(0 == pack.find("defaults"));
+		REQUIRE(BlueprintPack::NOT_FOUND == pack.find("missing"));
+		REQUIRE(BlueprintPack::NOT_FOUND == pack.find(""));
+		REQUIRE(!pack.getBlueprint(2));
+
+		// A blueprint read from the pack is equal to the parsed text file
+		auto blueprint = pack.getBlueprint(pack.find("good"));
+		REQUIRE(blueprint);
+		Engine engine;
+		auto factory = std::make_shared<EntityFactory>();
+		factory->addComponentFactory<PositionComponentFactory>("Position");
+		factory->addComponentFactory<SimpleComponentFactory<MarkerComponent>>("Render");
+		factory->addComponentFactory<SimpleComponentFactory<MarkerComponent>>("Label");
+		factory->addComponentFactory<SimpleComponentFactory<MarkerComponent>>("Marker");
+		factory->addEntityBlueprint("fromPack", blueprint);
+		engine.setEntityFactory(factory);
+		auto entity = engine.assembleEntity("fromPack");
+		REQUIRE(entity);
+		REQUIRE(10.1f == entity->get<PositionComponent>()->x);
+		REQUIRE(11.2f == entity->get<PositionComponent>()->y);
+		engine.removeEntity(entity);
+
+		pack.close();
+		REQUIRE(0 == pack.getBlueprintCount());
+		std::remove(PACK_FILE);
+	}
+
+	NS_TEST_CASE("entity_factory") {
+		TEST_MEMORY_LEAK_START
+		REQUIRE(ecstasy::convertBlueprints({ { "good", "tests_assets/good.def" } }, PACK_FILE).empty());
+		auto pack = std::make_shared<BlueprintPack>();
+		REQUIRE(pack->open(PACK_FILE).empty());
+
+		Engine engine;
+		auto factory = std::make_shared<EntityFactory>();
+		factory->addComponentFactory<PositionComponentFactory>("Position");
+		factory->addComponentFactory<SimpleComponentFactory<MarkerComponent>>("Render");
+		factory->addComponentFactory<SimpleComponentFactory<MarkerComponent>>("Label");
+		factory->addComponentFactory<SimpleComponentFactory<MarkerComponent>>("Marker");
+		factory->addBlueprintPack(pack);
+		engine.setEntityFactory(factory);
+
+		REQUIRE(!engine.assembleEntity("missing"));
+		auto entity = engine.assembleEntity("good");
+		REQUIRE(entity);
+		engine.addEntity(entity);
+
+		auto id = factory->compile("good");
+		REQUIRE(EntityFactory::INVALID_ID != id);
+		entity = engine.assembleEntity(id);
+		REQUIRE(entity);
+		engine.addEntity(entity);
+
+		// Blueprints added to the factory take precedence
+		std::shared_ptr<EntityBlueprint> blueprint;
+		REQUIRE(parseBlueprint("tests_assets/good_defaults.def", blueprint).empty());
+		factory->addEntityBlueprint("good", blueprint);
+		entity = engine.assembleEntity("good");
+		REQUIRE(entity);
+		REQUIRE(1 == entity->get<PositionComponent>()->x);
+		engine.addEntity(entity);
+
+		pack->close();
+		std::remove(PACK_FILE);
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("invalid_files") {
+		BlueprintPack pack;
+		REQUIRE(pack.open("tests_assets/missing.bin") == "Can't open file tests_assets/missing.bin");
+		REQUIRE(pack.open("tests_assets/good.def") == "Not a blueprint pack: tests_assets/good.def");
+
+		REQUIRE(ecstasy::convertBlueprints({ { "good", "tests_assets/good.def" } }, PACK_FILE).empty());
+		std::string content;
+		{
+			std::ifstream file(PACK_FILE, std::ios::binary);
+			content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		}
+		{
+			std::ofstream file(PACK_FILE, std::ios::binary);
+			file.write(content.data(), content.size() - 4);
+		}
+		REQUIRE(pack.open(PACK_FILE) == std::string("Blueprint pack is truncated: ") + PACK_FILE);
+		REQUIRE(0 == pack.getBlueprintCount());
+		std::remove(PACK_FILE);
+
+		auto error = ecstasy::convertBlueprints({ { "bad", "tests_assets/bad_command.def" } }, PACK_FILE);
+		REQUIRE(error == "tests_assets/bad_command.def: Line 1: unknown command 'whoops'");
+	}
+}
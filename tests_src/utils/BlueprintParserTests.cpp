@@ -67,4 +67,23 @@ namespace BlueprintParserTests {
 		auto error = parseBlueprint("tests_assets/bad_wrong_order.def", blueprint);
 		REQUIRE(error == "Line 1: 'add' must be called before 'set'");
 	}
+
+	NS_TEST_CASE("test_bad_file") {
+		std::shared_ptr<EntityBlueprint> blueprint;
+		auto error = parseBlueprint("tests_assets/missing.def", blueprint);
+		REQUIRE(error == "Can't open file tests_assets/missing.def");
+
+		// A directory can be opened, but not read
+		error = parseBlueprint("tests_assets", blueprint);
+		REQUIRE(error == "Can't read file tests_assets");
+	}
+
+	NS_TEST_CASE("test_text") {
+		std::shared_ptr<EntityBlueprint> blueprint;
+		auto error = ecstasy::parseBlueprintText("add Position\r\n\tset x \"1 2\"\r\nadd Marker", blueprint);
+		REQUIRE(error.empty());
+
+		error = ecstasy::parseBlueprintText("add Position\n\nset x\n", blueprint);
+		REQUIRE(error == "Line 3: expected exactly two arguments to 'set'");
+	}
 }
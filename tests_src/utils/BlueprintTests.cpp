@@ -77,4 +77,36 @@ namespace BlueprintTests {
 		REQUIRE(blueprint.getString("string", "foo bar") == "hello world");
 	}
 
+	NS_TEST_CASE("test_component_blueprint_keys") {
+		auto key = ComponentBlueprint::getKey("test_component_blueprint_keys");
+		REQUIRE(key == ComponentBlueprint::getKey("test_component_blueprint_keys"));
+		REQUIRE(key == ComponentBlueprint::findKey("test_component_blueprint_keys"));
+		REQUIRE(key != ComponentBlueprint::getKey("test_component_blueprint_keys2"));
+		REQUIRE(ComponentBlueprint::getKeyName(key) == "test_component_blueprint_keys");
+		REQUIRE(ComponentBlueprint::findKey("never used as key") == ComponentBlueprint::INVALID_KEY);
+
+		ComponentBlueprint blueprint("test");
+		REQUIRE(!blueprint.find(key));
+		REQUIRE(blueprint.getInt(ComponentBlueprint::INVALID_KEY, 42) == 42);
+		blueprint.set(key, "12");
+		REQUIRE(blueprint.getInt("test_component_blueprint_keys", 42) == 12);
+		REQUIRE(blueprint.getInt(key, 42) == 12);
+		REQUIRE(blueprint.getFloat(key, 42) == 12);
+		REQUIRE(blueprint.getBool(key, false) == false);
+		REQUIRE(blueprint.getString(key, "") == "12");
+
+		auto value = blueprint.find(key);
+		REQUIRE(value);
+		REQUIRE(value->flags == (ComponentBlueprint::HAS_INT | ComponentBlueprint::HAS_FLOAT));
+		REQUIRE(value->intValue == 12);
+
+		blueprint.set("b", "true");
+		blueprint.set("a", "x");
+		blueprint.set(key, "false");
+		REQUIRE(blueprint.getValues().size() == 3);
+		REQUIRE(blueprint.getBool(key, true) == false);
+		REQUIRE(blueprint.getInt(key, 42) == 42);
+		for (size_t i = 1; i < blueprint.getValues().size(); i++)
+			REQUIRE(blueprint.getValues()[i - 1].key < blueprint.getValues()[i].key);
+	}
 }
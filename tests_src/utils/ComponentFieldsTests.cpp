@@ -0,0 +1,127 @@
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include "../TestBase.hpp"
+#include <ecstasy/utils/BlueprintParser.hpp>
+#include <ecstasy/utils/ComponentFields.hpp>
+#include <ecstasy/utils/EntityFactory.hpp>
+
+#define NS_TEST_CASE(name) TEST_CASE("ComponentFields: " name)
+namespace ComponentFieldsTests {
+	struct UnitComponent : public Component<UnitComponent> {
+		float x = 1;
+		float y = 2;
+		int health = 100;
+		bool flying = false;
+		std::string name = "unit";
+	};
+	ECS_COMPONENT_FIELDS(UnitComponent, x, y, health, flying, name)
+
+	std::shared_ptr<EntityBlueprint> parseText(const char* text) {
+		std::shared_ptr<EntityBlueprint> blueprint;
+		REQUIRE(ecstasy::parseBlueprintText(text, blueprint).empty());
+		return blueprint;
+	}
+
+	NS_TEST_CASE("test_fields") {
+		auto& fields = ecstasy::getComponentFields<UnitComponent>().getFields();
+		REQUIRE(5 == fields.size());
+		REQUIRE(fields[0].name == "x");
+		REQUIRE(fields[1].name == "y");
+		REQUIRE(fields[2].name == "health");
+		REQUIRE(fields[3].name == "flying");
+		REQUIRE(fields[4].name == "name");
+		REQUIRE((fields[0].type == FieldType::FLOAT));
+		REQUIRE((fields[2].type == FieldType::INT));
+		REQUIRE((fields[3].type == FieldType::BOOL));
+		REQUIRE((fields[4].type == FieldType::STRING));
+		REQUIRE(fields[2].key == ComponentBlueprint::getKey("health"));
+
+		UnitComponent unit;
+		auto base = reinterpret_cast<const char*>(&unit);
+		REQUIRE((fields[0].offset == size_t(reinterpret_cast<const char*>(&unit.x) - base)));
+		REQUIRE((fields[2].offset == size_t(reinterpret_cast<const char*>(&unit.health) - base)));
+		REQUIRE((fields[4].offset == size_t(reinterpret_cast<const char*>(&unit.name) - base)));
+	}
+
+	NS_TEST_CASE("test_factory") {
+		TEST_MEMORY_LEAK_START
+		Engine engine;
+		auto factory = std::make_shared<EntityFactory>();
+		factory->addComponentFactory<ReflectedComponentFactory<UnitComponent>>("Unit");
+		factory->addEntityBlueprint("unit", parseText(
+			"add Unit\n set x 3\n set health 50\n set flying true\n set name \"big one\"\n set unknown 1\n"));
+		factory->addEntityBlueprint("invalid", parseText("add Unit\n set health many\n set flying yes\n"));
+		engine.setEntityFactory(factory);
+
+		auto entity = engine.assembleEntity("unit");
+		REQUIRE(entity);
+		auto unit = entity->get<UnitComponent>();
+		REQUIRE(unit);
+		REQUIRE(3 == unit->x);
+		REQUIRE(2 == unit->y);
+		REQUIRE(50 == unit->health);
+		REQUIRE(unit->flying);
+		REQUIRE(unit->name == "big one");
+		engine.addEntity(entity);
+
+		auto id = factory->compile("unit");
+		auto entities = engine.createEntities(3, id);
+		REQUIRE(3 == entities.size());
+		for (auto e : entities) {
+			REQUIRE(50 == e->get<UnitComponent>()->health);
+			REQUIRE(e->get<UnitComponent>()->name == "big one");
+		}
+		engine.addEntities(entities);
+
+		// Values which can't be converted keep their defaults
+		entity = engine.assembleEntity("invalid");
+		REQUIRE(entity);
+		REQUIRE(100 == entity->get<UnitComponent>()->health);
+		REQUIRE(!entity->get<UnitComponent>()->flying);
+		engine.addEntity(entity);
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("test_serialization") {
+		auto& fields = ecstasy::getComponentFields<UnitComponent>();
+		UnitComponent unit;
+		unit.x = 5;
+		unit.health = -7;
+		unit.flying = true;
+		unit.name = "serialized";
+
+		std::vector<char> buffer;
+		fields.write(&unit, buffer);
+		fields.write(&unit, buffer);
+
+		UnitComponent copy;
+		const char* position = buffer.data();
+		const char* end = buffer.data() + buffer.size();
+		REQUIRE(fields.read(&copy, position, end));
+		REQUIRE(5 == copy.x);
+		REQUIRE(2 == copy.y);
+		REQUIRE(-7 == copy.health);
+		REQUIRE(copy.flying);
+		REQUIRE(copy.name == "serialized");
+		REQUIRE((position - buffer.data() == static_cast<ptrdiff_t>(buffer.size() / 2)));
+		REQUIRE(fields.read(&copy, position, end));
+		REQUIRE((position - buffer.data() == static_cast<ptrdiff_t>(buffer.size())));
+
+		// Truncated data
+		position = buffer.data();
+		REQUIRE(!fields.read(&copy, position, buffer.data() + buffer.size() / 2 - 1));
+	}
+}
@@ -0,0 +1,258 @@
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include "../TestBase.hpp"
+#include <ecstasy/utils/ComponentRegistry.hpp>
+#include <ecstasy/utils/DeltaRecorder.hpp>
+#include <ecstasy/systems/IteratingSystem.hpp>
+#include <sstream>
+
+#define NS_TEST_CASE(name) TEST_CASE("DeltaRecorder: " name)
+namespace DeltaRecorderTests {
+	const float deltaTime = 0.16f;
+
+	struct PositionComponent : public Component<PositionComponent> {
+		float x = 0;
+		float y = 0;
+	};
+	ECS_COMPONENT_FIELDS(PositionComponent, x, y)
+
+	struct UnitComponent : public Component<UnitComponent> {
+		int health = 100;
+		std::string name;
+	};
+	ECS_COMPONENT_FIELDS(UnitComponent, health, name)
+
+	struct TagComponent : public Component<TagComponent> {};
+	struct LocalComponent : public Component<LocalComponent> {};
+
+	struct Extra {
+		double padding[3] = { 0, 0, 0 };
+		virtual ~Extra() {}
+	};
+
+	// ComponentBase is not at the start of this component
+	struct VelocityComponent : public Extra, public Component<VelocityComponent> {
+		float x = 0;
+	};
+	ECS_COMPONENT_FIELDS(VelocityComponent, x)
+
+	class MoveSystem : public IteratingSystem<MoveSystem> {
+	public:
+		MoveSystem() : IteratingSystem(Family::all<PositionComponent>().get()) {}
+
+		void processEntity(Entity* entity, float deltaTime) override {
+			if (entity->get<PositionComponent>()->x >= 2)
+				entity->getMut<PositionComponent>()->y += 1;
+		}
+	};
+
+	void registerComponents(ComponentRegistry& registry) {
+		registry.add<PositionComponent>("Position");
+		registry.add<UnitComponent>("Unit");
+		registry.add<TagComponent>("Tag");
+	}
+
+	Entity* createUnit(Engine& engine, float x, int health) {
+		auto entity = engine.createEntity();
+		entity->emplace<PositionComponent>()->x = x;
+		entity->emplace<UnitComponent>()->health = health;
+		engine.addEntity(entity);
+		return entity;
+	}
+
+	std::string writeDelta(DeltaRecorder& recorder) {
+		std::ostringstream stream;
+		REQUIRE(recorder.writeDelta(stream).empty());
+		return stream.str();
+	}
+
+	void applyDelta(Engine& replica, const std::string& delta, const ComponentRegistry& registry) {
+		REQUIRE(DeltaRecorder::applyDelta(replica, delta.data(), delta.size(), registry).empty());
+	}
+
+	void requireEqual(Engine& engine, Engine& replica) {
+		REQUIRE(engine.getEntities()->size() == replica.getEntities()->size());
+		for (auto entity : *engine.getEntities()) {
+			auto copy = replica.getEntity(entity->getId());
+			REQUIRE(copy);
+			REQUIRE(entity->has<PositionComponent>() == copy->has<PositionComponent>());
+			REQUIRE(entity->has<UnitComponent>() == copy->has<UnitComponent>());
+			REQUIRE(entity->has<TagComponent>() == copy->has<TagComponent>());
+			if (entity->has<PositionComponent>()) {
+				REQUIRE(entity->get<PositionComponent>()->x == copy->get<PositionComponent>()->x);
+				REQUIRE(entity->get<PositionComponent>()->y == copy->get<PositionComponent>()->y);
+			}
+			if (entity->has<UnitComponent>()) {
+				REQUIRE(entity->get<UnitComponent>()->health == copy->get<UnitComponent>()->health);
+				REQUIRE(entity->get<UnitComponent>()->name == copy->get<UnitComponent>()->name);
+			}
+		}
+	}
+
+	NS_TEST_CASE("replicate") {
+		TEST_MEMORY_LEAK_START
+		ComponentRegistry registry;
+		registerComponents(registry);
+
+		Engine engine;
+		std::vector<Entity*> units;
+		for (int i = 0; i < 5; i++)
+			units.push_back(createUnit(engine, static_cast<float>(i), i * 10));
+
+		Engine replica;
+		auto tagged = replica.getEntitiesFor(Family::all<TagComponent>().get());
+		{
+			std::ostringstream stream;
+			REQUIRE(engine.saveSnapshot(stream, registry).empty());
+			auto snapshot = stream.str();
+			REQUIRE(replica.loadSnapshot(snapshot.data(), snapshot.size(), registry).empty());
+		}
+
+		DeltaRecorder recorder(engine, registry);
+		units[0]->getMut<PositionComponent>()->y = 5;
+		units[1]->emplace<TagComponent>();
+		units[1]->emplace<LocalComponent>();
+		units[2]->remove<UnitComponent>();
+		engine.removeEntity(units[3]);
+		auto created = createUnit(engine, 7, 70);
+		created->get<UnitComponent>()->name = "new";
+		engine.removeEntity(createUnit(engine, 8, 80));
+		// Not marked as changed, so it is not replicated
+		units[4]->get<UnitComponent>()->health = 1;
+		applyDelta(replica, writeDelta(recorder), registry);
+
+		units[4]->get<UnitComponent>()->health = 40;
+		requireEqual(engine, replica);
+		REQUIRE(1 == tagged->size());
+		REQUIRE(!replica.getEntity(units[1]->getId())->has<LocalComponent>());
+
+		// Nothing changed
+		auto delta = writeDelta(recorder);
+		applyDelta(replica, delta, registry);
+		requireEqual(engine, replica);
+		auto emptySize = delta.size();
+
+		// Changes made by systems and delayed operations
+		engine.emplaceSystem<MoveSystem>();
+		engine.update(deltaTime);
+		delta = writeDelta(recorder);
+		REQUIRE(delta.size() > emptySize);
+		applyDelta(replica, delta, registry);
+		requireEqual(engine, replica);
+		REQUIRE(1 == replica.getEntity(units[2]->getId())->get<PositionComponent>()->y);
+
+		// Changes made after the last delta are part of the next one
+		units[0]->getMut<PositionComponent>()->x = 3;
+		applyDelta(replica, writeDelta(recorder), registry);
+		requireEqual(engine, replica);
+
+		// New entities on the replica don't collide with replicated ones
+		auto entity = replica.createEntity();
+		replica.addEntity(entity);
+		REQUIRE(entity->getId() > created->getId());
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("multiple_inheritance") {
+		TEST_MEMORY_LEAK_START
+		ComponentRegistry registry;
+		registry.add<VelocityComponent>("Velocity");
+		Engine engine;
+		Engine replica;
+		DeltaRecorder recorder(engine, registry);
+
+		auto entity = engine.createEntity();
+		entity->emplace<VelocityComponent>()->x = 1.5f;
+		engine.addEntity(entity);
+		applyDelta(replica, writeDelta(recorder), registry);
+		REQUIRE(replica.getEntity(entity->getId())->get<VelocityComponent>()->x == 1.5f);
+
+		entity->getMut<VelocityComponent>()->x = 2.5f;
+		applyDelta(replica, writeDelta(recorder), registry);
+		auto velocity = replica.getEntity(entity->getId())->get<VelocityComponent>();
+		REQUIRE(velocity->x == 2.5f);
+		REQUIRE(velocity->padding[0] == 0);
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("errors") {
+		TEST_MEMORY_LEAK_START
+		ComponentRegistry registry;
+		registerComponents(registry);
+		Engine engine;
+		Engine replica;
+		DeltaRecorder recorder(engine, registry);
+		createUnit(engine, 1, 2)->get<UnitComponent>()->name = "name";
+		auto delta = writeDelta(recorder);
+
+		REQUIRE(DeltaRecorder::applyDelta(replica, "garbage", 7, registry) == "Not a delta");
+		REQUIRE(!DeltaRecorder::applyDelta(replica, delta.data(), delta.size() - 1, registry).empty());
+		REQUIRE(replica.getEntities()->empty());
+
+		ComponentRegistry partialRegistry;
+		partialRegistry.add<PositionComponent>("Position");
+		REQUIRE(DeltaRecorder::applyDelta(replica, delta.data(), delta.size(), partialRegistry)
+			== "Component type 'Unit' has not been registered");
+
+		// A string length pointing past the payload of a created entity
+		auto untagged = replica.getEntitiesFor(Family::all<PositionComponent>().exclude<TagComponent>().get());
+		int componentSignals = 0;
+		auto connection = replica.componentRemoved.connect([&](Entity*, ComponentBase*) { componentSignals++; });
+		auto corrupt = delta;
+		// The name is the last field of the delta
+		corrupt[delta.size() - 8] = 100;
+		REQUIRE(DeltaRecorder::applyDelta(replica, corrupt.data(), corrupt.size(), registry)
+			== "Component data of 'Unit' is truncated");
+		REQUIRE(replica.getEntities()->empty());
+		REQUIRE(untagged->empty());
+		REQUIRE(0 == componentSignals);
+		connection.disconnect();
+
+		applyDelta(replica, delta, registry);
+		REQUIRE(1 == replica.getEntities()->size());
+		REQUIRE(1 == untagged->size());
+		// The entity exists already
+		REQUIRE(!DeltaRecorder::applyDelta(replica, delta.data(), delta.size(), registry).empty());
+
+		// Removing a component the replica never had
+		auto unit = (*engine.getEntities())[0];
+		unit->remove<UnitComponent>();
+		applyDelta(replica, writeDelta(recorder), registry);
+		unit->emplace<TagComponent>();
+		unit->remove<TagComponent>();
+		applyDelta(replica, writeDelta(recorder), registry);
+		requireEqual(engine, replica);
+
+		// Modifications of entities the replica does not know about
+		unit->markChanged<PositionComponent>();
+		delta = writeDelta(recorder);
+		Engine empty;
+		REQUIRE(!DeltaRecorder::applyDelta(empty, delta.data(), delta.size(), registry).empty());
+
+		// A created entity listing the same component twice
+		auto tag = engine.createEntity();
+		tag->emplace<TagComponent>();
+		engine.addEntity(tag);
+		delta = writeDelta(recorder);
+		// The delta ends with the component count and the local index of the tag
+		delta[delta.size() - 8] = 2;
+		delta += delta.substr(delta.size() - 4);
+		REQUIRE(DeltaRecorder::applyDelta(replica, delta.data(), delta.size(), registry)
+			== "Component type 'Tag' is listed twice for entity " + std::to_string(tag->getId()));
+		REQUIRE(!replica.getEntity(tag->getId()));
+		TEST_MEMORY_LEAK_END
+	}
+}
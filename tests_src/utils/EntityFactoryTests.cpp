@@ -18,6 +18,7 @@
 #include <ecstasy/utils/BlueprintParser.hpp>
 #include <ecstasy/utils/ComponentFactory.hpp>
 #include <ecstasy/utils/EntityFactory.hpp>
+#include <sstream>
 
 #define NS_TEST_CASE(name) TEST_CASE("EntityFactory: " name)
 namespace EntityFactoryTests {
@@ -67,6 +68,42 @@ namespace EntityFactoryTests {
 		return true;
 	}
 
+	struct VelocityData {
+		float x = 0;
+		float y = 0;
+	};
+	struct VelocityComponent: public Component<VelocityComponent> {
+		float x = 0;
+		float y = 0;
+	};
+	class VelocityComponentFactory : public CompiledComponentFactory<VelocityData> {
+	public:
+		static int parseCount;
+
+	protected:
+		void parse(VelocityData& data, const ComponentBlueprint& blueprint) override {
+			parseCount++;
+			data.x = blueprint.getFloat("x", 0);
+			data.y = blueprint.getFloat("y", 0);
+		}
+
+		bool create(Entity* entity, const VelocityData& data) override {
+			auto comp = entity->emplace<VelocityComponent>();
+			comp->x = data.x;
+			comp->y = data.y;
+			return true;
+		}
+	};
+
+	int VelocityComponentFactory::parseCount = 0;
+
+	std::shared_ptr<EntityBlueprint> parseString(const std::string& definition) {
+		std::istringstream stream(definition);
+		std::shared_ptr<EntityBlueprint> blueprint;
+		REQUIRE(parseBlueprint(stream, blueprint).empty());
+		return blueprint;
+	}
+
 	Entity* testFactoryInit(const std::string &filename, Engine& engine) {
 		auto factory = std::make_shared<EntityFactory>();
 
@@ -124,4 +161,89 @@ namespace EntityFactoryTests {
 		engine.addEntity(entity);
 		TEST_MEMORY_LEAK_END
 	}
+
+	NS_TEST_CASE("compiled_blueprint") {
+		TEST_MEMORY_LEAK_START
+		Engine engine;
+		auto factory = std::make_shared<EntityFactory>();
+		factory->addComponentFactory<PositionComponentFactory>("Position");
+		factory->addComponentFactory<VelocityComponentFactory>("Velocity");
+		factory->addComponentFactory<SimpleComponentFactory<MarkerComponent>>("Marker");
+		factory->addEntityBlueprint("mover", parseString("add Position\n set x 3\nadd Velocity\n set x 5\n set y 6\n"));
+		factory->addEntityBlueprint("broken", parseString("add Position\nadd Unknown\n"));
+		engine.setEntityFactory(factory);
+
+		REQUIRE(EntityFactory::INVALID_ID == factory->compile("missing"));
+		REQUIRE(EntityFactory::INVALID_ID == factory->compile("broken"));
+		auto id = factory->compile("mover");
+		REQUIRE(EntityFactory::INVALID_ID != id);
+		REQUIRE(id == factory->compile("mover"));
+		REQUIRE(!factory->getComponentBits(id));
+
+		auto entity = engine.assembleEntity(id);
+		REQUIRE(entity);
+		REQUIRE(3 == entity->get<PositionComponent>()->x);
+		REQUIRE(2 == entity->get<PositionComponent>()->y);
+		REQUIRE(5 == entity->get<VelocityComponent>()->x);
+		REQUIRE(6 == entity->get<VelocityComponent>()->y);
+		auto bits = factory->getComponentBits(id);
+		REQUIRE(bits);
+		REQUIRE((*bits == entity->getComponentBits()));
+		engine.addEntity(entity);
+		REQUIRE(!engine.assembleEntity(id + 1));
+
+		auto entities = engine.createEntities(10, id);
+		REQUIRE(10 == entities.size());
+		for (auto e : entities)
+			REQUIRE(5 == e->get<VelocityComponent>()->x);
+		engine.addEntities(entities);
+
+		// Replacing the blueprint compiles it again using the same id
+		factory->addEntityBlueprint("mover", parseString("add Velocity\n set x 7\nadd Marker\n"));
+		entity = engine.assembleEntity(id);
+		REQUIRE(entity);
+		REQUIRE(!entity->has<PositionComponent>());
+		REQUIRE(entity->has<MarkerComponent>());
+		REQUIRE(7 == entity->get<VelocityComponent>()->x);
+		REQUIRE((*factory->getComponentBits(id) == entity->getComponentBits()));
+		engine.addEntity(entity);
+
+		// Assembling by name still parses the values
+		factory->addEntityBlueprint("velocity", parseString("add Velocity\n set y 1\n"));
+		entity = engine.assembleEntity("velocity");
+		REQUIRE(entity);
+		REQUIRE(1 == entity->get<VelocityComponent>()->y);
+		engine.addEntity(entity);
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("lazy_recompile") {
+		TEST_MEMORY_LEAK_START
+		Engine engine;
+		auto factory = std::make_shared<EntityFactory>();
+		factory->addComponentFactory<VelocityComponentFactory>("Velocity");
+		factory->addEntityBlueprint("a", parseString("add Velocity\n set x 1\n"));
+		factory->addEntityBlueprint("b", parseString("add Velocity\n set x 2\n"));
+		engine.setEntityFactory(factory);
+		auto idA = factory->compile("a");
+		auto idB = factory->compile("b");
+		VelocityComponentFactory::parseCount = 0;
+
+		// Changes are collected and compiled once when the blueprints are used again
+		factory->addEntityBlueprint("a", parseString("add Velocity\n set x 3\n"));
+		factory->addEntityBlueprint("b", parseString("add Velocity\n set x 4\n"));
+		factory->addComponentFactory<PositionComponentFactory>("Position");
+		REQUIRE(0 == VelocityComponentFactory::parseCount);
+		REQUIRE(!factory->getComponentBits(idA));
+
+		auto entity = engine.assembleEntity(idA);
+		REQUIRE(2 == VelocityComponentFactory::parseCount);
+		REQUIRE(3 == entity->get<VelocityComponent>()->x);
+		engine.addEntity(entity);
+		entity = engine.assembleEntity(idB);
+		REQUIRE(2 == VelocityComponentFactory::parseCount);
+		REQUIRE(4 == entity->get<VelocityComponent>()->x);
+		engine.addEntity(entity);
+		TEST_MEMORY_LEAK_END
+	}
 }
@@ -247,4 +247,198 @@ namespace MemoryManagerTests {
 			manager.free(size, align, memory);
 		TEST_MEMORY_LEAK_END
 	}
+
+	NS_TEST_CASE("page_manager_stats") {
+		TEST_MEMORY_LEAK_START
+		uint32_t unitSize = ecstasy::getMemoryUnitSize(sizeof(uint64_t), alignof(uint64_t));
+		uint64_t pageSize = unitSize * 64 + alignof(uint64_t);
+		MemoryPageManager manager(unitSize, alignof(uint64_t));
+		REQUIRE(manager.getStats().reservedBytes == 0);
+		REQUIRE(manager.getStats().getFragmentation() == 0);
+
+		std::vector<void*> memories;
+		for(int i=0; i<65; i++)
+			memories.push_back(manager.allocate());
+		auto stats = manager.getStats();
+		REQUIRE(stats.reservedBytes == 2 * pageSize);
+		REQUIRE(stats.usedBytes == 65 * unitSize);
+		REQUIRE(stats.reclaimableBytes == 0);
+		REQUIRE(stats.getFragmentation() > 0.45f);
+		REQUIRE(stats.getFragmentation() < 0.55f);
+
+		// Free the first page completely
+		for(int i=0; i<64; i++)
+			manager.free(memories[i]);
+		stats = manager.getStats();
+		REQUIRE(stats.allocationCount == 1);
+		REQUIRE(stats.usedBytes == unitSize);
+		REQUIRE(stats.peakUsedBytes == 65 * unitSize);
+		REQUIRE(stats.reclaimableBytes == pageSize);
+		REQUIRE(stats.totalAllocations == 65);
+		REQUIRE(stats.totalFrees == 64);
+
+		manager.reduceMemory();
+		stats = manager.getStats();
+		REQUIRE(stats.reservedBytes == pageSize);
+		REQUIRE(stats.reclaimableBytes == 0);
+
+		manager.free(memories[64]);
+		REQUIRE(manager.getStats().reclaimableBytes == pageSize);
+		manager.allocate();
+		REQUIRE(manager.getStats().reclaimableBytes == 0);
+		manager.free(memories[64]);
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("default_memory_manager_stats") {
+		TEST_MEMORY_LEAK_START
+		DefaultMemoryManager manager;
+		auto stats = manager.getStats();
+		REQUIRE(stats.reservedBytes == 0);
+		REQUIRE(stats.usedBytes == 0);
+
+		auto mem64 = manager.allocate(sizeof(uint64_t), alignof(uint64_t));
+		auto mem128 = manager.allocate(sizeof(__m128), alignof(__m128));
+		auto unit64 = ecstasy::getMemoryUnitSize(sizeof(uint64_t), alignof(uint64_t));
+		auto unit128 = ecstasy::getMemoryUnitSize(sizeof(__m128), alignof(__m128));
+		stats = manager.getStats();
+		REQUIRE(stats.allocationCount == 2);
+		REQUIRE(stats.usedBytes == unit64 + unit128);
+		REQUIRE(stats.reservedBytes > stats.usedBytes);
+		REQUIRE(manager.getStats(sizeof(uint64_t), alignof(uint64_t)).usedBytes == unit64);
+		REQUIRE(manager.getStats(64, 64).reservedBytes == 0);
+
+		auto pageManagers = manager.getPageManagers();
+		REQUIRE(pageManagers.size() == 2);
+		REQUIRE(pageManagers[0]->getUnitSize() == unit64);
+		REQUIRE(pageManagers[1]->getUnitSize() == unit128);
+
+		manager.free(sizeof(uint64_t), alignof(uint64_t), mem64);
+		manager.free(sizeof(__m128), alignof(__m128), mem128);
+		stats = manager.getStats();
+		REQUIRE(stats.usedBytes == 0);
+		REQUIRE(stats.peakUsedBytes == unit64 + unit128);
+		REQUIRE(stats.reclaimableBytes == stats.reservedBytes);
+		REQUIRE(stats.totalAllocations == 2);
+		REQUIRE(stats.totalFrees == 2);
+
+		manager.reduceMemory();
+		REQUIRE(manager.getStats().reservedBytes == 0);
+		REQUIRE(manager.getStats().peakUsedBytes == unit64 + unit128);
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("page_manager_compaction") {
+		TEST_MEMORY_LEAK_START
+		MemoryPageManager manager(sizeof(uint64_t), alignof(uint64_t));
+
+		// Three pages: full, sparse (4 of 64 used), sparse (8 of 64 used)
+		std::vector<void*> memories;
+		for(int i=0; i<192; i++)
+			memories.push_back(manager.allocate());
+		std::vector<void*> kept;
+		for(int i=0; i<192; i++) {
+			if (i < 64 || (i < 128 && i % 16 == 0) || (i >= 128 && i % 8 == 0))
+				kept.push_back(memories[i]);
+			else
+				manager.free(memories[i]);
+		}
+		REQUIRE(manager.getPageCount() == 3);
+		REQUIRE(manager.getAllocationCount() == 76);
+
+		// Only the sparsest page fits into the free units of the other pages
+		REQUIRE(manager.beginCompaction(0.25f) == 4);
+		REQUIRE(manager.isEvacuating(kept[64]));
+		REQUIRE(!manager.isEvacuating(kept[0]));
+		REQUIRE(!manager.isEvacuating(kept[70]));
+
+		// Move the evacuating allocations
+		for(auto& memory: kept) {
+			if (manager.isEvacuating(memory)) {
+				auto newMemory = manager.allocate();
+				REQUIRE(!manager.isEvacuating(newMemory));
+				manager.free(memory);
+				memory = newMemory;
+			}
+		}
+		manager.endCompaction();
+		manager.reduceMemory();
+		REQUIRE(manager.getPageCount() == 2);
+		REQUIRE(manager.getAllocationCount() == 76);
+
+		for(auto memory: kept)
+			manager.free(memory);
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("default_memory_manager_compaction_pinned") {
+		TEST_MEMORY_LEAK_START
+		DefaultMemoryManager manager;
+
+		// Three pages each for pinned and normal allocations of the same size: full, sparse (4 of 64 used), sparse (8 of 64 used)
+		std::vector<void*> memories;
+		std::vector<void*> pinnedMemories;
+		for(int i=0; i<192; i++) {
+			memories.push_back(manager.allocate(sizeof(uint64_t), alignof(uint64_t)));
+			pinnedMemories.push_back(manager.allocatePinned(sizeof(uint64_t), alignof(uint64_t)));
+		}
+		REQUIRE(manager.getPageCount(sizeof(uint64_t), alignof(uint64_t)) == 3);
+		REQUIRE(manager.getPageCount(sizeof(uint64_t), alignof(uint64_t), true) == 3);
+		std::vector<void*> kept;
+		std::vector<void*> pinned;
+		for(int i=0; i<192; i++) {
+			if (i < 64 || (i < 128 && i % 16 == 0) || (i >= 128 && i % 8 == 0)) {
+				kept.push_back(memories[i]);
+				pinned.push_back(pinnedMemories[i]);
+			} else {
+				manager.free(sizeof(uint64_t), alignof(uint64_t), memories[i]);
+				manager.freePinned(sizeof(uint64_t), alignof(uint64_t), pinnedMemories[i]);
+			}
+		}
+
+		// Only the normal allocations get evacuated, pinned ones keep using their sparse pages
+		REQUIRE(manager.getPageManagers().size() == 2);
+		REQUIRE(manager.beginCompaction() == 4);
+		REQUIRE(manager.isEvacuating(sizeof(uint64_t), alignof(uint64_t), kept[64]));
+		pinned.push_back(manager.allocatePinned(sizeof(uint64_t), alignof(uint64_t)));
+		REQUIRE(manager.getPageCount(sizeof(uint64_t), alignof(uint64_t), true) == 3);
+		manager.endCompaction();
+
+		for(auto memory: kept)
+			manager.free(sizeof(uint64_t), alignof(uint64_t), memory);
+		REQUIRE(manager.getAllocationCount(sizeof(uint64_t), alignof(uint64_t), true) == pinned.size());
+		for(auto memory: pinned)
+			manager.freePinned(sizeof(uint64_t), alignof(uint64_t), memory);
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("default_memory_manager_reserve") {
+		TEST_MEMORY_LEAK_START
+		DefaultMemoryManager manager;
+		manager.reserve(sizeof(uint64_t), alignof(uint64_t), 100);
+		REQUIRE(manager.getPageCount(sizeof(uint64_t), alignof(uint64_t)) == 2);
+		REQUIRE(manager.getAllocationCount() == 0);
+
+		// Partially used pages are filled before reserved ones
+		std::vector<void*> memories;
+		for(int i=0; i<10; i++)
+			memories.push_back(manager.allocate(sizeof(uint64_t), alignof(uint64_t)));
+		manager.reserve(sizeof(uint64_t), alignof(uint64_t), 100);
+		REQUIRE(manager.getPageCount(sizeof(uint64_t), alignof(uint64_t)) == 2);
+		manager.reserve(sizeof(uint64_t), alignof(uint64_t), 200);
+		REQUIRE(manager.getPageCount(sizeof(uint64_t), alignof(uint64_t)) == 4);
+		for(int i=0; i<118; i++)
+			memories.push_back(manager.allocate(sizeof(uint64_t), alignof(uint64_t)));
+		REQUIRE(manager.getPageCount(sizeof(uint64_t), alignof(uint64_t)) == 4);
+		auto stats = manager.getStats(sizeof(uint64_t), alignof(uint64_t));
+		REQUIRE((stats.reclaimableBytes * 2) == stats.reservedBytes);
+
+		// Unused reserved pages are released again
+		manager.reduceMemory();
+		REQUIRE(manager.getPageCount(sizeof(uint64_t), alignof(uint64_t)) == 2);
+
+		for(auto memory: memories)
+			manager.free(sizeof(uint64_t), alignof(uint64_t), memory);
+		TEST_MEMORY_LEAK_END
+	}
 }
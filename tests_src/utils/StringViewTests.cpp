@@ -0,0 +1,58 @@
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include "../TestBase.hpp"
+#include <ecstasy/utils/StringView.hpp>
+#include <sstream>
+
+#define NS_TEST_CASE(name) TEST_CASE("StringView: " name)
+namespace StringViewTests {
+	NS_TEST_CASE("test_construct") {
+		StringView empty;
+		REQUIRE(empty.empty());
+		REQUIRE(0 == empty.size());
+
+		std::string str = "hello world";
+		StringView view(str);
+		REQUIRE(11 == view.size());
+		REQUIRE(view.data() == str.data());
+		REQUIRE(view == "hello world");
+		REQUIRE(view.toString() == str);
+		REQUIRE(StringView(str.data(), 5) == "hello");
+	}
+
+	NS_TEST_CASE("test_substr") {
+		StringView view("hello world");
+		REQUIRE(view.substr(6) == "world");
+		REQUIRE(view.substr(0, 5) == "hello");
+		REQUIRE(view.substr(6, 100) == "world");
+		REQUIRE(view.substr(20).empty());
+	}
+
+	NS_TEST_CASE("test_compare") {
+		REQUIRE(StringView("abc") == "abc");
+		REQUIRE(StringView("abc") != "abd");
+		REQUIRE(StringView("abc") != "ab");
+		REQUIRE(StringView("ab") < "abc");
+		REQUIRE(StringView("abc") < "abd");
+		REQUIRE(!(StringView("abc") < "abc"));
+		REQUIRE(0 == StringView("abc").compare("abc"));
+		REQUIRE(0 < StringView("b").compare("abc"));
+
+		std::ostringstream stream;
+		stream << StringView("hello world").substr(0, 5);
+		REQUIRE(stream.str() == "hello");
+	}
+}
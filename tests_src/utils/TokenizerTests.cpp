@@ -175,4 +175,63 @@ namespace TokenizerTests {
 		REQUIRE(tokens[0] == "zero");
 		REQUIRE(tokens[1] == "one");
 	}
+
+	NS_TEST_CASE("test_views") {
+		std::string data = "first \"and second\" third#comment";
+		std::vector<StringView> tokens;
+		std::string buffer;
+		int numTokens = parseTokens(data, tokens, buffer);
+		REQUIRE(numTokens == 3);
+		REQUIRE(tokens.size() == 3);
+		REQUIRE(tokens[0] == "first");
+		REQUIRE(tokens[1] == "and second");
+		REQUIRE(tokens[2] == "third");
+		// Tokens without escape sequences point into the line
+		REQUIRE(tokens[0].data() == data.data());
+		REQUIRE(tokens[1].data() == data.data() + 7);
+		REQUIRE(buffer.empty());
+	}
+
+	NS_TEST_CASE("test_view_escapes") {
+		std::string data = "\"tab\\there\" plain \"quote\\\"d\" \"open\\";
+		std::vector<StringView> tokens;
+		std::string buffer;
+		int numTokens = parseTokens(data, tokens, buffer);
+		REQUIRE(numTokens == -4);
+		REQUIRE(tokens.size() == 4);
+		REQUIRE(tokens[0] == "tab\there");
+		REQUIRE(tokens[1] == "plain");
+		REQUIRE(tokens[2] == "quote\"d");
+		REQUIRE(tokens[3] == "open");
+
+		// Same results as the std::string version
+		std::vector<std::string> strings;
+		REQUIRE(-4 == parseTokens(data, strings));
+		REQUIRE(strings.size() == 4);
+		for (size_t i = 0; i < strings.size(); i++)
+			REQUIRE(tokens[i] == strings[i]);
+	}
+
+	NS_TEST_CASE("test_line_tokenizer") {
+		std::string data = "add one\r\n\n  # comment\nset \"two\" 2\nlast";
+		ecstasy::LineTokenizer tokenizer(data);
+		REQUIRE(tokenizer.nextLine());
+		REQUIRE(1 == tokenizer.getLineNumber());
+		REQUIRE(2 == tokenizer.getNumTokens());
+		REQUIRE(tokenizer.getTokens()[1] == "one");
+		REQUIRE(tokenizer.nextLine());
+		REQUIRE(0 == tokenizer.getNumTokens());
+		REQUIRE(tokenizer.nextLine());
+		REQUIRE(3 == tokenizer.getLineNumber());
+		REQUIRE(0 == tokenizer.getNumTokens());
+		REQUIRE(tokenizer.nextLine());
+		REQUIRE(3 == tokenizer.getNumTokens());
+		REQUIRE(tokenizer.getTokens()[1] == "two");
+		REQUIRE(tokenizer.getTokens()[2] == "2");
+		REQUIRE(tokenizer.nextLine());
+		REQUIRE(5 == tokenizer.getLineNumber());
+		REQUIRE(tokenizer.getTokens()[0] == "last");
+		REQUIRE(!tokenizer.nextLine());
+		REQUIRE(tokenizer.getTokens().empty());
+	}
 }
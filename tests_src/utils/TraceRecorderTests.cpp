@@ -0,0 +1,137 @@
+/*******************************************************************************
+ * Copyright 2015 See AUTHORS file.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+#include "../TestBase.hpp"
+#include <ecstasy/systems/IteratingSystem.hpp>
+#include <ecstasy/utils/TraceRecorder.hpp>
+#include <sstream>
+#include <thread>
+#include <cstdio>
+
+#define NS_TEST_CASE(name) TEST_CASE("TraceRecorder: " name)
+namespace TraceRecorderTests {
+	const float deltaTime = 0.16f;
+
+	struct ComponentA : public Component<ComponentA> {};
+	struct ComponentB : public Component<ComponentB> {};
+
+	class AddComponentSystem : public IteratingSystem<AddComponentSystem> {
+	public:
+		AddComponentSystem() : IteratingSystem(Family::all<ComponentA>().exclude<ComponentB>().get()) {}
+
+		void processEntity(Entity* entity, float deltaTime) override {
+			entity->emplace<ComponentB>();
+		}
+	};
+
+	static std::string toJson(const TraceRecorder& recorder) {
+		std::stringstream stream;
+		recorder.write(stream);
+		return stream.str();
+	}
+
+	NS_TEST_CASE("ringBuffer") {
+		TEST_MEMORY_LEAK_START
+		TraceRecorder recorder(3);
+		REQUIRE(0 == recorder.getEventCount());
+
+		for (uint32_t i = 0; i < 6; i++)
+			recorder.record("event", "test", i * 10, 5, i);
+		REQUIRE(4 == recorder.getEventCount());
+
+		auto json = toJson(recorder);
+		REQUIRE(json.find("\"traceEvents\"") != std::string::npos);
+		REQUIRE(json.find("\"event 1\"") == std::string::npos);
+		REQUIRE(json.find("\"event 2\"") != std::string::npos);
+		REQUIRE(json.find("\"event 5\"") != std::string::npos);
+		REQUIRE(json.find("\"event 2\"") < json.find("\"event 5\""));
+		REQUIRE(json.find("\"ts\":50,\"dur\":5") != std::string::npos);
+
+		recorder.clear();
+		REQUIRE(0 == recorder.getEventCount());
+		REQUIRE(toJson(recorder).find("\"event") == std::string::npos);
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("engineEvents") {
+		TEST_MEMORY_LEAK_START
+		auto recorder = std::make_shared<TraceRecorder>();
+		{
+			Engine engine;
+			engine.setTraceRecorder(recorder);
+			engine.emplaceSystem<AddComponentSystem>();
+			auto entity = engine.createEntity();
+			entity->emplace<ComponentA>();
+			engine.addEntity(entity);
+
+			engine.update(deltaTime);
+			engine.reduceMemory();
+			engine.setTraceRecorder(nullptr);
+			engine.update(deltaTime);
+		}
+
+		auto json = toJson(*recorder);
+		auto systemName = "\"system " + std::to_string(ecstasy::getSystemType<AddComponentSystem>()) + "\"";
+		REQUIRE(json.find(systemName) != std::string::npos);
+		REQUIRE(json.find("\"operations\"") != std::string::npos);
+		REQUIRE(json.find("\"args\":{\"value\":1}") != std::string::npos);
+		REQUIRE(json.find("\"update\"") != std::string::npos);
+		REQUIRE(json.find("\"reduceMemory\"") != std::string::npos);
+		REQUIRE(5 == recorder->getEventCount());
+		recorder.reset();
+		TEST_MEMORY_LEAK_END
+	}
+
+	NS_TEST_CASE("concurrentRecording") {
+		TEST_MEMORY_LEAK_START
+		TraceRecorder recorder(16);
+		std::vector<std::thread> threads;
+		for (uint32_t t = 0; t < 4; t++) {
+			threads.emplace_back([&recorder, t]() {
+				for (uint32_t i = 0; i < 20000; i++) {
+					uint32_t id = t * 100000 + i;
+					recorder.record("event", "test", id, id, id, id);
+				}
+			});
+		}
+
+		// Events are either skipped or complete, never mixed from two writers
+		bool consistent = true;
+		int parsed = 0;
+		auto check = [&]() {
+			std::istringstream json(toJson(recorder));
+			std::string line;
+			while (std::getline(json, line)) {
+				unsigned id, value;
+				unsigned long long start, duration;
+				if (std::sscanf(line.c_str(), "{\"name\":\"event %u\",\"cat\":\"test\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu,"
+						"\"pid\":1,\"tid\":%*u,\"args\":{\"value\":%u}", &id, &start, &duration, &value) == 4) {
+					if (start != id || duration != id || value != id)
+						consistent = false;
+					parsed++;
+				}
+			}
+		};
+		for (int i = 0; i < 200; i++)
+			check();
+		for (auto& thread : threads)
+			thread.join();
+		check();
+		REQUIRE(consistent);
+		REQUIRE(parsed > 0);
+		REQUIRE(16 == recorder.getEventCount());
+		TEST_MEMORY_LEAK_END
+	}
+}